@@ -32,7 +32,14 @@
 #include "em_chip.h"
 #include "dbg_log.h"
 #include "led_channel.h"
+#include "led_light.h"
 #include "led_effect.h"
+#if APP_METERING
+#include "led_meter.h"
+#endif
+#if APP_WAVE_MONITOR
+#include "led_wave.h"
+#endif
 #include "button.h"
 #include "on_off_extension.h"
 #include "level_extension.h"
@@ -213,7 +220,14 @@ void emberAfMainInitCallback(void)
 {
     sl_zigbee_event_init(&ctx.pairing_mode_exit_event, led_drv_pairing_exit_cb);
     led_channel_init();
+    led_light_init();
     led_effect_init();
+#if APP_METERING
+    led_meter_init();
+#endif
+#if APP_WAVE_MONITOR
+    led_wave_init();
+#endif
 
     button_init();
     initialized = true;
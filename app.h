@@ -21,7 +21,126 @@
 
 #include <stddef.h>
 
-#define APP_EP_COUNT                4
+/* PWM channels, X(name, TIMER number, CC channel, polarity, right aligned).
+ * Pins are LED_<name>_PORT/PIN from pin_config.h. Every channel is Zigbee
+ * endpoint (in table order, from endpoint 1), so table has to match ZAP
+ * endpoints. Right alignment is used with LED_CHANNEL_PHASE_STAGGER only. */
+#define APP_CHANNEL_TABLE(X)                \
+    X(CH1,  1,  0,  0,  0)                  \
+    X(CH2,  1,  1,  0,  1)                  \
+    X(CH3,  1,  2,  0,  0)                  \
+    X(CH4,  2,  0,  0,  0)
+
+/* channels driven by external PCA9685 I2C PWM controller, X(name, output,
+ * polarity), appended after APP_CHANNEL_TABLE channels as further endpoints
+ * (ZAP endpoints have to be added for them), in ex.
+ *  X(CH5,  0,  0)
+ *  X(CH6,  1,  0) */
+#ifndef APP_CHANNEL_EXT_TABLE
+#define APP_CHANNEL_EXT_TABLE(X)
+#endif
+
+/* 7-bit I2C address of PCA9685 (A5 - A0 pins) */
+#define APP_PCA9685_ADDRESS         0x40
+
+/* segments of addressable LED strip (WS2812/SK6812) driven over USART,
+ * X(name, first pixel, pixel count, color byte), color byte is position in
+ * strip pixel data (WS2812 is G, R, B, SK6812 RGBW adds W), every segment is
+ * further endpoint after APP_CHANNEL_EXT_TABLE channels, in ex. RGB segment
+ *  X(CH7,  0,  30, 1)
+ *  X(CH8,  0,  30, 0)
+ *  X(CH9,  0,  30, 2) */
+#ifndef APP_CHANNEL_PIXEL_TABLE
+#define APP_CHANNEL_PIXEL_TABLE(X)
+#endif
+
+#define APP_PIXEL_COUNT             60
+#define APP_PIXEL_BYTES             3       /* 3 - WS2812 GRB, 4 - SK6812 GRBW */
+
+/* status LED, driven after endpoint channels */
+#define APP_CHANNEL_AUX(X)                  \
+    X(AUX,  3,  0,  1,  0)
+
+/* status LED is driven by LETIMER0 instead of its TIMER, LETIMER runs from
+ * low frequency clock in EM2 and plays on/off blink effects by itself */
+#define APP_AUX_LETIMER             1
+
+#if APP_AUX_LETIMER
+#define APP_TIMER_AUX(X)
+#else
+#define APP_TIMER_AUX(X)                    \
+    X(3,    0)
+#endif
+
+/* TIMERs used by channels, X(TIMER number, counter phase in percent of PWM
+ * period), phase is used with LED_CHANNEL_PHASE_STAGGER only */
+#define APP_TIMER_TABLE(X)                  \
+    X(1,    0)                              \
+    X(2,    50)                             \
+    APP_TIMER_AUX(X)
+
+#define APP_CHANNEL_COUNT_ONE(name, ...)    + 1
+
+#define APP_TIMER_CHANNEL_COUNT     (0 APP_CHANNEL_TABLE(APP_CHANNEL_COUNT_ONE))
+#define APP_EXT_CHANNEL_COUNT       (0 APP_CHANNEL_EXT_TABLE(APP_CHANNEL_COUNT_ONE))
+#define APP_PIXEL_CHANNEL_COUNT     (0 APP_CHANNEL_PIXEL_TABLE(APP_CHANNEL_COUNT_ONE))
+
+#define APP_EP_COUNT                (APP_TIMER_CHANNEL_COUNT + APP_EXT_CHANNEL_COUNT + APP_PIXEL_CHANNEL_COUNT)
+
+/* channels (with AUX) are addressed by bits of 32-bit masks */
+#if APP_EP_COUNT + 1 > 32
+#error "Too many channels"
+#endif
+
+/* level transitions rendered once and streamed to PWM by LDMA */
+#ifndef APP_DMA_TRANSITIONS
+#define APP_DMA_TRANSITIONS         0
+#endif
+
+/* highest rate of event driven level transition updates in Hz, transition
+ * wakes up only when its PWM output changes */
+#define APP_LEVEL_MAX_TICK_RATE     200
+
+/* light modes: every channel is separate dimmable endpoint, CH1 (warm) and
+ * CH2 (cool) are tunable white light on endpoint 1, CH1 - CH4 (R, G, B, W)
+ * are color light on endpoint 1 */
+#define APP_LIGHT_MODE_CHANNELS         0
+#define APP_LIGHT_MODE_TUNABLE_WHITE    1
+#define APP_LIGHT_MODE_RGBW             2
+
+#ifndef APP_LIGHT_MODE
+#define APP_LIGHT_MODE              APP_LIGHT_MODE_CHANNELS
+#endif
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE && APP_EP_COUNT < 2
+#error "Tunable white light needs CH1 and CH2"
+#endif
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW && APP_EP_COUNT < 4
+#error "RGBW light needs CH1 - CH4"
+#endif
+
+/* color temperature of tunable white channels */
+#define APP_TW_WARM_MIREDS          370     /* CH1, 2700K */
+#define APP_TW_COOL_MIREDS          154     /* CH2, 6500K */
+
+/* RGBW calibration matrix, rows are CH1 - CH4 outputs, columns are R, G, B
+ * and W components of requested color (0x4000 is 1.0), in ex. to balance
+ * channels of different efficiency or to correct white LED tint */
+#define APP_RGBW_CALIBRATION        { { 0x4000, 0x0000, 0x0000, 0x0000 }, \
+                                      { 0x0000, 0x4000, 0x0000, 0x0000 }, \
+                                      { 0x0000, 0x0000, 0x4000, 0x0000 }, \
+                                      { 0x0000, 0x0000, 0x0000, 0x4000 } }
+
+/* energy metering of endpoints estimated from PWM duty, rated power of the
+ * strip connected to the channel at full duty in 0.1 W (configurable by
+ * manufacturer specific command) */
+#define APP_METERING                1
+#define APP_CHANNEL_RATED_POWER_DW  240
+
+/* output quality monitor: step discontinuities and flicker of dithered
+ * outputs are measured for every transition and effect */
+#define APP_WAVE_MONITOR            0
 
 #define EMBER_AF_IMAGE_TYPE_ID              0x1000
 #define EMBER_AF_CUSTOM_FIRMWARE_VERSION    0x01030000
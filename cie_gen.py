@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+#
+#  Zigbee 3.0 4-channel LED strip driver.
+#  Copyright (C) 2022 Andrzej Gendek
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+#  Generates cie_table.h - CIE 1931 lightness to luminance table indexed
+#  by ZCL level (0..254) with values scaled to the requested bit width.
+#
+#  usage: ./cie_gen.py [bits] > cie_table.h
+#
+
+import sys
+
+ZCL_LEVEL_MAX = 254
+
+
+def cie_luminance(lightness):
+    if lightness <= 8.0:
+        return lightness / 903.3
+    return ((lightness + 16.0) / 116.0) ** 3
+
+
+def main():
+    bits = int(sys.argv[1]) if len(sys.argv) > 1 else 16
+    full_scale = (1 << bits) - 1
+
+    values = [0]
+    for level in range(1, ZCL_LEVEL_MAX + 1):
+        y = cie_luminance(level * 100.0 / ZCL_LEVEL_MAX)
+        values.append(max(1, int(round(y * full_scale))))
+
+    # index 255 is not valid ZCL level, map it to full scale
+    values.append(full_scale)
+
+    print("/*")
+    print(" *  Zigbee 3.0 4-channel LED strip driver.")
+    print(" *  Copyright (C) 2022 Andrzej Gendek")
+    print(" *")
+    print(" *  This file was generated by cie_gen.py - DO NOT EDIT!")
+    print(" */")
+    print("")
+    print("#ifndef CIE_TABLE_H_")
+    print("#define CIE_TABLE_H_")
+    print("")
+    print("#include <stdint.h>")
+    print("")
+    print("#define CIE_TABLE_BITS      %d" % bits)
+    print("#define CIE_TABLE_MAX       %d" % full_scale)
+    print("")
+    print("static const uint%d_t cie_table[] = {" % (16 if bits <= 16 else 32))
+    for i in range(0, len(values), 10):
+        print("    " + ", ".join(str(v) for v in values[i:i + 10]) + ",")
+    print("};")
+    print("")
+    print("#endif /* CIE_TABLE_H_ */")
+
+
+if __name__ == "__main__":
+    main()
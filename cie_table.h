@@ -0,0 +1,45 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This file was generated by cie_gen.py - DO NOT EDIT!
+ */
+
+#ifndef CIE_TABLE_H_
+#define CIE_TABLE_H_
+
+#include <stdint.h>
+
+#define CIE_TABLE_BITS      16
+#define CIE_TABLE_MAX       65535
+
+static const uint16_t cie_table[] = {
+    0, 29, 57, 86, 114, 143, 171, 200, 229, 257,
+    286, 314, 343, 371, 400, 428, 457, 486, 514, 543,
+    571, 600, 630, 660, 692, 725, 758, 793, 829, 865,
+    903, 942, 982, 1023, 1065, 1109, 1153, 1199, 1246, 1294,
+    1344, 1394, 1446, 1499, 1554, 1609, 1666, 1725, 1784, 1845,
+    1908, 1972, 2037, 2104, 2172, 2241, 2312, 2385, 2459, 2535,
+    2612, 2690, 2770, 2852, 2936, 3021, 3107, 3195, 3285, 3377,
+    3470, 3565, 3662, 3760, 3860, 3962, 4066, 4171, 4279, 4388,
+    4499, 4611, 4726, 4843, 4961, 5081, 5204, 5328, 5454, 5582,
+    5713, 5845, 5979, 6115, 6253, 6394, 6536, 6681, 6828, 6976,
+    7127, 7280, 7436, 7593, 7753, 7915, 8079, 8245, 8414, 8585,
+    8758, 8934, 9112, 9292, 9475, 9660, 9847, 10037, 10229, 10424,
+    10621, 10820, 11023, 11227, 11434, 11644, 11856, 12071, 12288, 12508,
+    12730, 12955, 13183, 13414, 13647, 13883, 14121, 14362, 14606, 14853,
+    15102, 15354, 15609, 15867, 16128, 16391, 16658, 16927, 17199, 17474,
+    17752, 18033, 18316, 18603, 18893, 19185, 19481, 19780, 20082, 20386,
+    20694, 21005, 21319, 21637, 21957, 22280, 22607, 22937, 23270, 23606,
+    23945, 24288, 24634, 24983, 25336, 25691, 26050, 26413, 26779, 27148,
+    27520, 27896, 28275, 28658, 29044, 29434, 29827, 30223, 30623, 31027,
+    31434, 31845, 32259, 32677, 33098, 33523, 33952, 34384, 34820, 35259,
+    35703, 36150, 36600, 37055, 37513, 37975, 38440, 38910, 39383, 39860,
+    40341, 40826, 41315, 41807, 42304, 42804, 43308, 43817, 44329, 44845,
+    45365, 45889, 46417, 46950, 47486, 48026, 48571, 49119, 49672, 50229,
+    50790, 51355, 51924, 52497, 53075, 53657, 54243, 54833, 55428, 56027,
+    56630, 57238, 57849, 58466, 59086, 59711, 60340, 60974, 61612, 62255,
+    62902, 63553, 64209, 64870, 65535, 65535,
+};
+
+#endif /* CIE_TABLE_H_ */
@@ -0,0 +1,826 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "color_extension.h"
+#include "af.h"
+#include "app.h"
+#include "led_light.h"
+#include "led_sched.h"
+#include "sl_custom_token_header.h"
+#include "zigbee_app_framework_event.h"
+
+#include "dbg_log.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define COLOR_STEP_PER_SEC          (20)
+
+#define COLOR_MOVE_MODE_STOP        0x00
+#define COLOR_MOVE_MODE_UP          0x01
+#define COLOR_MOVE_MODE_DOWN        0x03
+
+#define COLOR_HUE_DIR_SHORTEST      0x00
+#define COLOR_HUE_DIR_LONGEST       0x01
+#define COLOR_HUE_DIR_UP            0x02
+#define COLOR_HUE_DIR_DOWN          0x03
+
+#define COLOR_CAPABILITIES_HS       0x0001
+#define COLOR_CAPABILITIES_XY       0x0008
+#define COLOR_CAPABILITIES_CT       0x0010
+
+/* hue is cyclic, 254 is followed by 0 */
+#define COLOR_HUE_RANGE             255
+#define COLOR_SATURATION_MAX        254
+#define COLOR_XY_MAX                0xFEFF
+
+/* fractional bits of component value, 0xFFFF << 15 still fits in int32 */
+#define COLOR_FRAC_BITS             15
+
+typedef enum
+{
+    ColorComponent_CT,
+    ColorComponent_HUE,
+    ColorComponent_SAT,
+    ColorComponent_X,
+    ColorComponent_Y,
+    ColorComponent_COUNT
+
+} ColorComponent;
+
+typedef struct
+{
+    int32_t             value;              /* current value, COLOR_FRAC_BITS fractional bits */
+    int32_t             step;               /* change per tick */
+    uint16_t            target;
+
+} ColorComponentCtx;
+
+typedef struct
+{
+    ColorComponentCtx   comp[ColorComponent_COUNT];
+    uint32_t            active_mask;        /* components changed by transition */
+    uint32_t            ticks;              /* ticks left till target */
+    uint8_t             mode;               /* ZCL color mode */
+
+} ColorCtx;
+
+typedef struct
+{
+    EmberAfAttributeId      attribute_id;
+    EmberAfAttributeType    type;
+    uint16_t                min;
+    uint16_t                max;
+
+} ColorComponentDesc;
+
+static const ColorComponentDesc color_desc[ColorComponent_COUNT] =
+{
+    [ColorComponent_CT]  = { ZCL_COLOR_CONTROL_COLOR_TEMPERATURE_ATTRIBUTE_ID, ZCL_INT16U_ATTRIBUTE_TYPE, APP_TW_COOL_MIREDS, APP_TW_WARM_MIREDS },
+    [ColorComponent_HUE] = { ZCL_COLOR_CONTROL_CURRENT_HUE_ATTRIBUTE_ID, ZCL_INT8U_ATTRIBUTE_TYPE, 0, COLOR_HUE_RANGE - 1 },
+    [ColorComponent_SAT] = { ZCL_COLOR_CONTROL_CURRENT_SATURATION_ATTRIBUTE_ID, ZCL_INT8U_ATTRIBUTE_TYPE, 0, COLOR_SATURATION_MAX },
+    [ColorComponent_X]   = { ZCL_COLOR_CONTROL_CURRENT_X_ATTRIBUTE_ID, ZCL_INT16U_ATTRIBUTE_TYPE, 0, COLOR_XY_MAX },
+    [ColorComponent_Y]   = { ZCL_COLOR_CONTROL_CURRENT_Y_ATTRIBUTE_ID, ZCL_INT16U_ATTRIBUTE_TYPE, 0, COLOR_XY_MAX },
+};
+
+static ColorCtx color_ctx;
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+static tokTypeCurrentColor color_saved;
+#else
+static uint16_t color_saved_mireds;
+#endif
+
+static void color_extension_attribute_write(EmberAfAttributeId attribute_id, uint16_t value,
+                                            EmberAfAttributeType type)
+{
+    EmberAfStatus status = emberAfWriteServerAttribute(LED_LIGHT_MIXED_EP,
+                                                       ZCL_COLOR_CONTROL_CLUSTER_ID,
+                                                       attribute_id,
+                                                       (uint8_t*)&value,
+                                                       type);
+    if (status != EMBER_ZCL_STATUS_SUCCESS)
+    {
+        DBG_LOG("ERR: unable to set COLOR attribute %04x: %x", attribute_id, status);
+    }
+}
+
+static uint16_t color_extension_value_get(ColorComponent c)
+{
+    return (uint16_t)(color_ctx.comp[c].value >> COLOR_FRAC_BITS);
+}
+
+static bool color_extension_mode_supported(uint8_t mode)
+{
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    return mode != EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE;
+#else
+    return mode == EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE;
+#endif
+}
+
+static void color_extension_color_save(void)
+{
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    tokTypeCurrentColor color =
+    {
+        .mode = color_ctx.mode,
+        .hue = (uint8_t)color_extension_value_get(ColorComponent_HUE),
+        .saturation = (uint8_t)color_extension_value_get(ColorComponent_SAT),
+        .x = color_extension_value_get(ColorComponent_X),
+        .y = color_extension_value_get(ColorComponent_Y),
+    };
+
+    if (color.mode != color_saved.mode ||
+        color.hue != color_saved.hue ||
+        color.saturation != color_saved.saturation ||
+        color.x != color_saved.x ||
+        color.y != color_saved.y)
+    {
+        DBG_LOG("Saving color mode %d", color.mode);
+        halCommonSetToken(TOKEN_CURRENT_COLOR, &color);
+        color_saved = color;
+    }
+#else
+    uint16_t mireds = color_extension_value_get(ColorComponent_CT);
+
+    if (mireds != color_saved_mireds)
+    {
+        DBG_LOG("Saving color temperature %d", mireds);
+        halCommonSetToken(TOKEN_CURRENT_COLOR_TEMP, &mireds);
+        color_saved_mireds = mireds;
+    }
+#endif
+}
+
+/**
+ * @brief
+ *  Applies current color to light and attributes. All channels of the light
+ *  are staged together, so color changes in one PWM period.
+ */
+static void color_extension_color_update(uint32_t mask, bool done)
+{
+    switch (color_ctx.mode)
+    {
+        case EMBER_ZCL_COLOR_MODE_CURRENT_HUE_AND_CURRENT_SATURATION:
+            led_light_color_hs_stage((uint8_t)color_extension_value_get(ColorComponent_HUE),
+                                     (uint8_t)color_extension_value_get(ColorComponent_SAT));
+            break;
+        case EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y:
+            led_light_color_xy_stage(color_extension_value_get(ColorComponent_X),
+                                     color_extension_value_get(ColorComponent_Y));
+            break;
+        default:
+            led_light_color_temp_stage(color_extension_value_get(ColorComponent_CT));
+            break;
+    }
+
+    for (ColorComponent c = 0; c < ColorComponent_COUNT; c++)
+    {
+        if ((mask & (1 << c)) != 0)
+        {
+            color_extension_attribute_write(color_desc[c].attribute_id, color_extension_value_get(c),
+                                            color_desc[c].type);
+        }
+    }
+
+    /* tick is 1/2 of remaining time unit (1/10 s) */
+    color_extension_attribute_write(ZCL_COLOR_CONTROL_REMAINING_TIME_ATTRIBUTE_ID,
+                                    done ? 0 : (color_ctx.ticks + 1) / 2,
+                                    ZCL_INT16U_ATTRIBUTE_TYPE);
+
+    if (done)
+    {
+        color_extension_color_save();
+    }
+}
+
+static void color_extension_transition_event_cb(uint8_t index)
+{
+    if (color_ctx.ticks > 0)
+    {
+        color_ctx.ticks--;
+    }
+
+    bool done = color_ctx.ticks == 0;
+
+    for (ColorComponent c = 0; c < ColorComponent_COUNT; c++)
+    {
+        ColorComponentCtx *comp = &color_ctx.comp[c];
+
+        if ((color_ctx.active_mask & (1 << c)) == 0)
+        {
+            continue;
+        }
+
+        if (done)
+        {
+            /* no rounding error is left at the end */
+            comp->value = (int32_t)comp->target << COLOR_FRAC_BITS;
+            continue;
+        }
+
+        comp->value += comp->step;
+
+        if (c == ColorComponent_HUE)
+        {
+            if (comp->value < 0)
+            {
+                comp->value += COLOR_HUE_RANGE << COLOR_FRAC_BITS;
+            }
+            else if (comp->value >= (COLOR_HUE_RANGE << COLOR_FRAC_BITS))
+            {
+                comp->value -= COLOR_HUE_RANGE << COLOR_FRAC_BITS;
+            }
+        }
+    }
+
+    color_extension_color_update(color_ctx.active_mask, done);
+
+    if (!done)
+    {
+        led_sched_set_delay_ms(LedSchedClient_COLOR, 0, 1000 / COLOR_STEP_PER_SEC);
+    }
+}
+
+static uint16_t color_extension_clamp(ColorComponent c, int32_t value)
+{
+    if (value < color_desc[c].min)
+    {
+        return color_desc[c].min;
+    }
+
+    if (value > color_desc[c].max)
+    {
+        return color_desc[c].max;
+    }
+
+    return (uint16_t)value;
+}
+
+/**
+ * @brief
+ *  Sets target of the component for the next transition.
+ *
+ * @param c
+ * @param target - clamped to component range
+ * @param hue_dir - COLOR_HUE_DIR_*, used by hue only
+ * @param ticks - transition length in ticks
+ */
+static uint32_t color_extension_ticks_get(uint16_t transition_time)
+{
+    return ((uint32_t)transition_time * COLOR_STEP_PER_SEC) / 10;
+}
+
+/* ticks needed to move the component to the target with given rate per second */
+static uint32_t color_extension_move_ticks_get(ColorComponent c, uint16_t target, uint16_t rate)
+{
+    uint16_t current = color_extension_value_get(c);
+    uint32_t distance = target > current ? target - current : current - target;
+    uint32_t ticks = (distance * COLOR_STEP_PER_SEC + rate - 1) / rate;
+
+    return ticks > UINT16_MAX ? UINT16_MAX : ticks;
+}
+
+static void color_extension_component_to(ColorComponent c, int32_t target, uint8_t hue_dir, uint32_t ticks)
+{
+    ColorComponentCtx *comp = &color_ctx.comp[c];
+
+    comp->target = color_extension_clamp(c, target);
+    comp->step = ((int32_t)comp->target << COLOR_FRAC_BITS) - comp->value;
+
+    if (c == ColorComponent_HUE)
+    {
+        const int32_t range = COLOR_HUE_RANGE << COLOR_FRAC_BITS;
+        bool is_short = comp->step > -range / 2 && comp->step <= range / 2;
+
+        if ((hue_dir == COLOR_HUE_DIR_SHORTEST && !is_short) ||
+            (hue_dir == COLOR_HUE_DIR_LONGEST && is_short) ||
+            (hue_dir == COLOR_HUE_DIR_UP && comp->step < 0) ||
+            (hue_dir == COLOR_HUE_DIR_DOWN && comp->step > 0))
+        {
+            comp->step += comp->step > 0 ? -range : range;
+        }
+    }
+
+    if (ticks > 0)
+    {
+        comp->step /= (int32_t)ticks;
+    }
+}
+
+/**
+ * @brief
+ *  Sets target of the component moved with given rate for given ticks.
+ */
+static void color_extension_component_move(ColorComponent c, int32_t rate, uint32_t ticks)
+{
+    ColorComponentCtx *comp = &color_ctx.comp[c];
+    int64_t target = (comp->value + (((int64_t)rate << COLOR_FRAC_BITS) * ticks) / COLOR_STEP_PER_SEC) >> COLOR_FRAC_BITS;
+
+    if (c == ColorComponent_HUE)
+    {
+        /* hue may go round many times, so only step is kept */
+        target %= COLOR_HUE_RANGE;
+        target += target < 0 ? COLOR_HUE_RANGE : 0;
+        comp->target = (uint16_t)target;
+        comp->step = (rate << COLOR_FRAC_BITS) / COLOR_STEP_PER_SEC;
+    }
+    else
+    {
+        color_extension_component_to(c, (int32_t)target, 0, ticks);
+    }
+}
+
+/**
+ * @brief
+ *  Starts color transition of components, all of them are updated in the
+ *  same tick. Step per tick is kept in fixed point, so slow transitions don't
+ *  stall on integer values.
+ *
+ * @param mask - components with target set
+ * @param mode - ZCL color mode
+ * @param ticks - transition length in ticks, 0 for immediate change
+ */
+static void color_extension_transition_start(uint32_t mask, uint8_t mode, uint32_t ticks)
+{
+    color_ctx.active_mask = mask;
+    color_ctx.ticks = ticks;
+
+    if (color_ctx.mode != mode)
+    {
+        color_ctx.mode = mode;
+        color_extension_attribute_write(ZCL_COLOR_CONTROL_COLOR_MODE_ATTRIBUTE_ID, mode,
+                                        ZCL_ENUM8_ATTRIBUTE_TYPE);
+        color_extension_attribute_write(ZCL_COLOR_CONTROL_ENHANCED_COLOR_MODE_ATTRIBUTE_ID, mode,
+                                        ZCL_ENUM8_ATTRIBUTE_TYPE);
+    }
+
+    led_sched_set_active(LedSchedClient_COLOR, 0);
+}
+
+
+static void color_extension_stop(void)
+{
+    led_sched_set_inactive(LedSchedClient_COLOR, 0);
+
+    for (ColorComponent c = 0; c < ColorComponent_COUNT; c++)
+    {
+        color_ctx.comp[c].target = color_extension_value_get(c);
+        color_ctx.comp[c].value = (int32_t)color_ctx.comp[c].target << COLOR_FRAC_BITS;
+    }
+
+    color_ctx.ticks = 0;
+    color_extension_color_update(color_ctx.active_mask, true);
+}
+
+static bool color_extension_handle_move_to_color_temp(uint16_t mireds, uint16_t transition_time)
+{
+    DBG_LOG("MOVE_TO_COLOR_TEMP(%d) in %d [ms]", mireds, transition_time * 100);
+
+    uint32_t ticks = color_extension_ticks_get(transition_time);
+
+    color_extension_component_to(ColorComponent_CT, mireds, 0, ticks);
+    color_extension_transition_start(1 << ColorComponent_CT, EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_move_color_temp(uint8_t mode, uint16_t rate,
+                                                   uint16_t min_mireds, uint16_t max_mireds)
+{
+    DBG_LOG("MOVE_COLOR_TEMP(%d, %d)", mode, rate);
+
+    if (mode == COLOR_MOVE_MODE_STOP || rate == 0)
+    {
+        color_extension_stop();
+        return true;
+    }
+
+    uint16_t target;
+
+    if (mode == COLOR_MOVE_MODE_UP)
+    {
+        target = (max_mireds != 0 && max_mireds < APP_TW_WARM_MIREDS) ? max_mireds : APP_TW_WARM_MIREDS;
+    }
+    else if (mode == COLOR_MOVE_MODE_DOWN)
+    {
+        target = (min_mireds > APP_TW_COOL_MIREDS) ? min_mireds : APP_TW_COOL_MIREDS;
+    }
+    else
+    {
+        return false;
+    }
+
+    /* rate is in mireds per second */
+    uint32_t ticks = color_extension_move_ticks_get(ColorComponent_CT, target, rate);
+
+    color_extension_component_to(ColorComponent_CT, target, 0, ticks);
+    color_extension_transition_start(1 << ColorComponent_CT, EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_step_color_temp(uint8_t mode, uint16_t size, uint16_t transition_time,
+                                                   uint16_t min_mireds, uint16_t max_mireds)
+{
+    int32_t target = color_ctx.comp[ColorComponent_CT].target;
+
+    DBG_LOG("STEP_COLOR_TEMP(%d, %d) in %d [ms]", mode, size, transition_time * 100);
+
+    if (mode == COLOR_MOVE_MODE_UP)
+    {
+        target += size;
+        if (max_mireds != 0 && target > max_mireds)
+        {
+            target = max_mireds;
+        }
+    }
+    else if (mode == COLOR_MOVE_MODE_DOWN)
+    {
+        target -= size;
+        if (target < min_mireds)
+        {
+            target = min_mireds;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    uint32_t ticks = color_extension_ticks_get(transition_time);
+
+    color_extension_component_to(ColorComponent_CT, target, 0, ticks);
+    color_extension_transition_start(1 << ColorComponent_CT, EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_move_to_hs(uint32_t mask, uint8_t hue, uint8_t hue_dir,
+                                              uint8_t saturation, uint16_t transition_time)
+{
+    uint32_t ticks = color_extension_ticks_get(transition_time);
+
+    DBG_LOG("MOVE_TO_HS(%d, %d) in %d [ms]", hue, saturation, transition_time * 100);
+
+    if ((mask & (1 << ColorComponent_HUE)) != 0)
+    {
+        color_extension_component_to(ColorComponent_HUE, hue, hue_dir, ticks);
+    }
+
+    if ((mask & (1 << ColorComponent_SAT)) != 0)
+    {
+        color_extension_component_to(ColorComponent_SAT, saturation, 0, ticks);
+    }
+
+    color_extension_transition_start(mask, EMBER_ZCL_COLOR_MODE_CURRENT_HUE_AND_CURRENT_SATURATION, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_move_hs(ColorComponent c, uint8_t mode, uint8_t rate)
+{
+    DBG_LOG("MOVE_%s(%d, %d)", c == ColorComponent_HUE ? "HUE" : "SAT", mode, rate);
+
+    if (mode == COLOR_MOVE_MODE_STOP || rate == 0)
+    {
+        color_extension_stop();
+        return true;
+    }
+
+    if (mode != COLOR_MOVE_MODE_UP && mode != COLOR_MOVE_MODE_DOWN)
+    {
+        return false;
+    }
+
+    int32_t signed_rate = mode == COLOR_MOVE_MODE_UP ? rate : -(int32_t)rate;
+    uint32_t ticks = UINT16_MAX;
+
+    if (c == ColorComponent_SAT)
+    {
+        /* saturation stops at the end of range, hue goes round till stopped */
+        ticks = color_extension_move_ticks_get(c, mode == COLOR_MOVE_MODE_UP ? COLOR_SATURATION_MAX : 0, rate);
+    }
+
+    color_extension_component_move(c, signed_rate, ticks);
+    color_extension_transition_start(1 << c, EMBER_ZCL_COLOR_MODE_CURRENT_HUE_AND_CURRENT_SATURATION, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_step_hs(ColorComponent c, uint8_t mode, uint8_t size, uint8_t transition_time)
+{
+    int32_t target = color_ctx.comp[c].target;
+
+    DBG_LOG("STEP_%s(%d, %d) in %d [ms]", c == ColorComponent_HUE ? "HUE" : "SAT", mode, size, transition_time * 100);
+
+    if (mode == COLOR_MOVE_MODE_UP)
+    {
+        target += size;
+    }
+    else if (mode == COLOR_MOVE_MODE_DOWN)
+    {
+        target -= size;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (c == ColorComponent_HUE)
+    {
+        target %= COLOR_HUE_RANGE;
+        target += target < 0 ? COLOR_HUE_RANGE : 0;
+    }
+
+    uint32_t ticks = color_extension_ticks_get(transition_time);
+
+    color_extension_component_to(c, target, mode == COLOR_MOVE_MODE_UP ? COLOR_HUE_DIR_UP : COLOR_HUE_DIR_DOWN, ticks);
+    color_extension_transition_start(1 << c, EMBER_ZCL_COLOR_MODE_CURRENT_HUE_AND_CURRENT_SATURATION, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_move_to_xy(uint16_t x, uint16_t y, uint16_t transition_time)
+{
+    uint32_t ticks = color_extension_ticks_get(transition_time);
+
+    DBG_LOG("MOVE_TO_COLOR(%d, %d) in %d [ms]", x, y, transition_time * 100);
+
+    color_extension_component_to(ColorComponent_X, x, 0, ticks);
+    color_extension_component_to(ColorComponent_Y, y, 0, ticks);
+    color_extension_transition_start((1 << ColorComponent_X) | (1 << ColorComponent_Y),
+                                     EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_move_xy(int16_t rate_x, int16_t rate_y)
+{
+    DBG_LOG("MOVE_COLOR(%d, %d)", rate_x, rate_y);
+
+    if (rate_x == 0 && rate_y == 0)
+    {
+        color_extension_stop();
+        return true;
+    }
+
+    /* both components move with own rate till the first one reaches end of range */
+    uint32_t ticks = UINT16_MAX;
+
+    if (rate_x != 0)
+    {
+        uint32_t t = color_extension_move_ticks_get(ColorComponent_X, rate_x > 0 ? COLOR_XY_MAX : 0,
+                                                    rate_x > 0 ? rate_x : -rate_x);
+        ticks = t < ticks ? t : ticks;
+    }
+
+    if (rate_y != 0)
+    {
+        uint32_t t = color_extension_move_ticks_get(ColorComponent_Y, rate_y > 0 ? COLOR_XY_MAX : 0,
+                                                    rate_y > 0 ? rate_y : -rate_y);
+        ticks = t < ticks ? t : ticks;
+    }
+
+    color_extension_component_move(ColorComponent_X, rate_x, ticks);
+    color_extension_component_move(ColorComponent_Y, rate_y, ticks);
+    color_extension_transition_start((1 << ColorComponent_X) | (1 << ColorComponent_Y),
+                                     EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y, ticks);
+
+    return true;
+}
+
+static bool color_extension_handle_step_xy(int16_t step_x, int16_t step_y, uint16_t transition_time)
+{
+    uint32_t ticks = color_extension_ticks_get(transition_time);
+
+    DBG_LOG("STEP_COLOR(%d, %d) in %d [ms]", step_x, step_y, transition_time * 100);
+
+    color_extension_component_to(ColorComponent_X, (int32_t)color_ctx.comp[ColorComponent_X].target + step_x, 0, ticks);
+    color_extension_component_to(ColorComponent_Y, (int32_t)color_ctx.comp[ColorComponent_Y].target + step_y, 0, ticks);
+    color_extension_transition_start((1 << ColorComponent_X) | (1 << ColorComponent_Y),
+                                     EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y, ticks);
+
+    return true;
+}
+
+static void color_extension_component_init(ColorComponent c, uint16_t value)
+{
+    color_ctx.comp[c].target = color_extension_clamp(c, value);
+    color_ctx.comp[c].value = (int32_t)color_ctx.comp[c].target << COLOR_FRAC_BITS;
+    color_ctx.comp[c].step = 0;
+}
+
+void color_extension_init(void)
+{
+    uint16_t capabilities;
+
+    led_sched_register(LedSchedClient_COLOR, color_extension_transition_event_cb);
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    tokTypeCurrentColor color = CURRENT_COLOR_DEFAULT;
+
+    halCommonGetToken(&color, TOKEN_CURRENT_COLOR);
+
+    if (color.mode == EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE)
+    {
+        color.mode = EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y;
+    }
+
+    color_saved = color;
+    color_ctx.mode = color.mode;
+    color_extension_component_init(ColorComponent_CT, CURRENT_COLOR_TEMP_DEFAULT);
+    color_extension_component_init(ColorComponent_HUE, color.hue);
+    color_extension_component_init(ColorComponent_SAT, color.saturation);
+    color_extension_component_init(ColorComponent_X, color.x);
+    color_extension_component_init(ColorComponent_Y, color.y);
+    capabilities = COLOR_CAPABILITIES_HS | COLOR_CAPABILITIES_XY;
+#else
+    uint16_t mireds = CURRENT_COLOR_TEMP_DEFAULT;
+
+    halCommonGetToken(&mireds, TOKEN_CURRENT_COLOR_TEMP);
+
+    if (mireds < APP_TW_COOL_MIREDS || mireds > APP_TW_WARM_MIREDS)
+    {
+        mireds = CURRENT_COLOR_TEMP_DEFAULT;
+    }
+
+    color_saved_mireds = mireds;
+    color_ctx.mode = EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE;
+    color_extension_component_init(ColorComponent_CT, mireds);
+    capabilities = COLOR_CAPABILITIES_CT;
+
+    color_extension_attribute_write(ZCL_COLOR_CONTROL_COLOR_TEMP_PHYSICAL_MIN_ATTRIBUTE_ID, APP_TW_COOL_MIREDS,
+                                    ZCL_INT16U_ATTRIBUTE_TYPE);
+    color_extension_attribute_write(ZCL_COLOR_CONTROL_COLOR_TEMP_PHYSICAL_MAX_ATTRIBUTE_ID, APP_TW_WARM_MIREDS,
+                                    ZCL_INT16U_ATTRIBUTE_TYPE);
+#endif
+
+    color_extension_attribute_write(ZCL_COLOR_CONTROL_COLOR_CAPABILITIES_ATTRIBUTE_ID, capabilities,
+                                    ZCL_BITMAP16_ATTRIBUTE_TYPE);
+    color_extension_attribute_write(ZCL_COLOR_CONTROL_COLOR_MODE_ATTRIBUTE_ID, color_ctx.mode,
+                                    ZCL_ENUM8_ATTRIBUTE_TYPE);
+    color_extension_attribute_write(ZCL_COLOR_CONTROL_ENHANCED_COLOR_MODE_ATTRIBUTE_ID, color_ctx.mode,
+                                    ZCL_ENUM8_ATTRIBUTE_TYPE);
+
+    color_extension_color_update((1 << ColorComponent_COUNT) - 1, false);
+}
+
+uint32_t color_extension_handle_cmd(sl_service_opcode_t opcode,
+                                    sl_service_function_context_t *context)
+{
+    bool wasHandled = false;
+    EmberAfClusterCommand* cmd = (EmberAfClusterCommand *)context->data;
+    uint8_t ep_id = emberAfCurrentEndpoint();
+
+    if (led_light_is_mixed(ep_id) == false || cmd->payloadStartIndex >= cmd->bufLen)
+    {
+        return EMBER_ZCL_STATUS_UNSUP_COMMAND;
+    }
+
+    uint8_t* payload = &cmd->buffer[cmd->payloadStartIndex];
+
+    switch(cmd->commandId)
+    {
+        default:
+        {
+            DBG_LOG("Unknown COLOR command %02x received for ep %02x", cmd->commandId, ep_id);
+            break;
+        }
+        case ZCL_MOVE_TO_COLOR_TEMPERATURE_COMMAND_ID:
+        case ZCL_MOVE_COLOR_TEMPERATURE_COMMAND_ID:
+        case ZCL_STEP_COLOR_TEMPERATURE_COMMAND_ID:
+        {
+            if (color_extension_mode_supported(EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE) == false)
+            {
+                break;
+            }
+
+            if (cmd->commandId == ZCL_MOVE_TO_COLOR_TEMPERATURE_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_to_color_temp(*(uint16_t*)&payload[0],
+                                                                       *(uint16_t*)&payload[2]);
+            }
+            else if (cmd->commandId == ZCL_MOVE_COLOR_TEMPERATURE_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_color_temp(payload[0],
+                                                                    *(uint16_t*)&payload[1],
+                                                                    *(uint16_t*)&payload[3],
+                                                                    *(uint16_t*)&payload[5]);
+            }
+            else
+            {
+                wasHandled = color_extension_handle_step_color_temp(payload[0],
+                                                                    *(uint16_t*)&payload[1],
+                                                                    *(uint16_t*)&payload[3],
+                                                                    *(uint16_t*)&payload[5],
+                                                                    *(uint16_t*)&payload[7]);
+            }
+            break;
+        }
+        case ZCL_MOVE_TO_HUE_COMMAND_ID:
+        case ZCL_MOVE_HUE_COMMAND_ID:
+        case ZCL_STEP_HUE_COMMAND_ID:
+        case ZCL_MOVE_TO_SATURATION_COMMAND_ID:
+        case ZCL_MOVE_SATURATION_COMMAND_ID:
+        case ZCL_STEP_SATURATION_COMMAND_ID:
+        case ZCL_MOVE_TO_HUE_AND_SATURATION_COMMAND_ID:
+        {
+            if (color_extension_mode_supported(EMBER_ZCL_COLOR_MODE_CURRENT_HUE_AND_CURRENT_SATURATION) == false)
+            {
+                break;
+            }
+
+            if (cmd->commandId == ZCL_MOVE_TO_HUE_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_to_hs(1 << ColorComponent_HUE,
+                                                               payload[0], payload[1], 0,
+                                                               *(uint16_t*)&payload[2]);
+            }
+            else if (cmd->commandId == ZCL_MOVE_TO_SATURATION_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_to_hs(1 << ColorComponent_SAT,
+                                                               0, 0, payload[0],
+                                                               *(uint16_t*)&payload[1]);
+            }
+            else if (cmd->commandId == ZCL_MOVE_TO_HUE_AND_SATURATION_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_to_hs((1 << ColorComponent_HUE) | (1 << ColorComponent_SAT),
+                                                               payload[0], COLOR_HUE_DIR_SHORTEST, payload[1],
+                                                               *(uint16_t*)&payload[2]);
+            }
+            else if (cmd->commandId == ZCL_MOVE_HUE_COMMAND_ID || cmd->commandId == ZCL_MOVE_SATURATION_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_hs(cmd->commandId == ZCL_MOVE_HUE_COMMAND_ID ?
+                                                            ColorComponent_HUE : ColorComponent_SAT,
+                                                            payload[0], payload[1]);
+            }
+            else
+            {
+                wasHandled = color_extension_handle_step_hs(cmd->commandId == ZCL_STEP_HUE_COMMAND_ID ?
+                                                            ColorComponent_HUE : ColorComponent_SAT,
+                                                            payload[0], payload[1], payload[2]);
+            }
+            break;
+        }
+        case ZCL_MOVE_TO_COLOR_COMMAND_ID:
+        case ZCL_MOVE_COLOR_COMMAND_ID:
+        case ZCL_STEP_COLOR_COMMAND_ID:
+        {
+            if (color_extension_mode_supported(EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y) == false)
+            {
+                break;
+            }
+
+            if (cmd->commandId == ZCL_MOVE_TO_COLOR_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_to_xy(*(uint16_t*)&payload[0],
+                                                               *(uint16_t*)&payload[2],
+                                                               *(uint16_t*)&payload[4]);
+            }
+            else if (cmd->commandId == ZCL_MOVE_COLOR_COMMAND_ID)
+            {
+                wasHandled = color_extension_handle_move_xy(*(int16_t*)&payload[0],
+                                                            *(int16_t*)&payload[2]);
+            }
+            else
+            {
+                wasHandled = color_extension_handle_step_xy(*(int16_t*)&payload[0],
+                                                            *(int16_t*)&payload[2],
+                                                            *(uint16_t*)&payload[4]);
+            }
+            break;
+        }
+        case ZCL_STOP_MOVE_STEP_COMMAND_ID:
+        {
+            DBG_LOG("STOP_MOVE_STEP");
+            color_extension_stop();
+            wasHandled = true;
+            break;
+        }
+    }
+
+    if (wasHandled == true)
+    {
+        emberAfSendImmediateDefaultResponse(EMBER_ZCL_STATUS_SUCCESS);
+    }
+
+    return wasHandled == true ? EMBER_ZCL_STATUS_SUCCESS :
+        EMBER_ZCL_STATUS_UNSUP_COMMAND;
+}
@@ -0,0 +1,30 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLOR_EXTENSION_H_
+#define COLOR_EXTENSION_H_
+
+#include "app/framework/include/af.h"
+#include "sl_service_function.h"
+
+void color_extension_init(void);
+
+uint32_t color_extension_handle_cmd(sl_service_opcode_t opcode,
+                                    sl_service_function_context_t *context);
+
+#endif /* COLOR_EXTENSION_H_ */
@@ -97,4 +97,136 @@
                          uint8_t,
                          APP_EP_COUNT,
                          CURRENT_LEVEL_DEFAULT)
-#endif
\ No newline at end of file
+#endif
+
+/* output trim of the channel, duty of the lowest and highest level (0 - 65535) */
+#define LED_TRIM_DEFAULT         { 0, 0xFFFF }
+
+#define CREATOR_LED_TRIM 0xB022
+#define NVM3KEY_LED_TRIM (NVM3KEY_DOMAIN_ZIGBEE | 0xB022)
+
+#ifdef DEFINETYPES
+typedef struct
+{
+    uint16_t    min;
+    uint16_t    max;
+} tokTypeLedTrim;
+#endif
+
+#ifdef DEFINETOKENS
+    DEFINE_INDEXED_TOKEN(LED_TRIM,
+                         tokTypeLedTrim,
+                         APP_EP_COUNT,
+                         LED_TRIM_DEFAULT)
+#endif
+
+/* color temperature of tunable white light in mireds */
+#define CURRENT_COLOR_TEMP_DEFAULT  250
+
+#define CREATOR_CURRENT_COLOR_TEMP 0xB023
+#define NVM3KEY_CURRENT_COLOR_TEMP (NVM3KEY_DOMAIN_ZIGBEE | 0xB023)
+
+#ifdef DEFINETOKENS
+    DEFINE_BASIC_TOKEN(CURRENT_COLOR_TEMP,
+                       uint16_t,
+                       CURRENT_COLOR_TEMP_DEFAULT)
+#endif
+
+/* color of RGBW light, ZCL color mode selects if hue/saturation or x/y is used */
+#define CURRENT_COLOR_DEFAULT       { 1, 0, 0, 0x5000, 0x5555 }
+
+#define CREATOR_CURRENT_COLOR 0xB024
+#define NVM3KEY_CURRENT_COLOR (NVM3KEY_DOMAIN_ZIGBEE | 0xB024)
+
+#ifdef DEFINETYPES
+typedef struct
+{
+    uint8_t     mode;       /* ZCL color mode */
+    uint8_t     hue;
+    uint8_t     saturation;
+    uint16_t    x;
+    uint16_t    y;
+} tokTypeCurrentColor;
+#endif
+
+#ifdef DEFINETOKENS
+    DEFINE_BASIC_TOKEN(CURRENT_COLOR,
+                       tokTypeCurrentColor,
+                       CURRENT_COLOR_DEFAULT)
+#endif
+
+/* dimming curve of the channel, LED_CURVE_POINTS_MAX sparse points are used by custom curve */
+#define LED_CURVE_POINTS_MAX     16
+#define LED_CURVE_DEFAULT        { 0, 0, 0, { { 0, 0 } } }
+
+#define CREATOR_LED_CURVE 0xB021
+#define NVM3KEY_LED_CURVE (NVM3KEY_DOMAIN_ZIGBEE | 0xB021)
+
+#ifdef DEFINETYPES
+typedef struct
+{
+    uint8_t     level;
+    uint16_t    value;
+} tokTypeLedCurvePoint;
+
+typedef struct
+{
+    uint8_t                 curve;      /* LedCurve */
+    uint8_t                 param;      /* gamma * 10 for gamma curve */
+    uint8_t                 count;      /* number of custom curve points */
+    tokTypeLedCurvePoint    points[LED_CURVE_POINTS_MAX];
+} tokTypeLedCurve;
+#endif
+
+#ifdef DEFINETOKENS
+    DEFINE_INDEXED_TOKEN(LED_CURVE,
+                         tokTypeLedCurve,
+                         APP_EP_COUNT,
+                         LED_CURVE_DEFAULT)
+#endif
+
+/* rated power of the channel at full duty and energy delivered by it */
+#define LED_METER_DEFAULT       { APP_CHANNEL_RATED_POWER_DW, 0 }
+
+#define CREATOR_LED_METER 0xB025
+#define NVM3KEY_LED_METER (NVM3KEY_DOMAIN_ZIGBEE | 0xB025)
+
+#ifdef DEFINETYPES
+typedef struct
+{
+    uint16_t    rated_power;    /* 0.1 W */
+    uint32_t    energy;         /* Wh */
+} tokTypeLedMeter;
+#endif
+
+#ifdef DEFINETOKENS
+    DEFINE_INDEXED_TOKEN(LED_METER,
+                         tokTypeLedMeter,
+                         APP_EP_COUNT,
+                         LED_METER_DEFAULT)
+#endif
+
+/* enabled channels detected by the last probe, default means not probed yet */
+#define LED_CHANNEL_MASK_DEFAULT    0xFFFFFFFF
+
+#define CREATOR_LED_CHANNEL_MASK 0xB026
+#define NVM3KEY_LED_CHANNEL_MASK (NVM3KEY_DOMAIN_ZIGBEE | 0xB026)
+
+#ifdef DEFINETOKENS
+    DEFINE_BASIC_TOKEN(LED_CHANNEL_MASK,
+                       uint32_t,
+                       LED_CHANNEL_MASK_DEFAULT)
+#endif
+
+/* easing of level transitions of the endpoint (LedEase), linear by default */
+#define LED_EASE_DEFAULT            0
+
+#define CREATOR_LED_EASE 0xB027
+#define NVM3KEY_LED_EASE (NVM3KEY_DOMAIN_ZIGBEE | 0xB027)
+
+#ifdef DEFINETOKENS
+    DEFINE_INDEXED_TOKEN(LED_EASE,
+                         uint8_t,
+                         APP_EP_COUNT,
+                         LED_EASE_DEFAULT)
+#endif
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+#
+#  Zigbee 3.0 4-channel LED strip driver.
+#  Copyright (C) 2022 Andrzej Gendek
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+#  Generates ease_table.h - easing curves of level transitions, sampled
+#  at evenly spaced points of transition progress, values in Q16.
+#
+#  usage: ./ease_gen.py [segments bits] > ease_table.h
+#
+
+import sys
+
+EASE_ONE = 1 << 16
+
+
+def ease_quadratic(p):
+    if p < 0.5:
+        return 2.0 * p * p
+    return 1.0 - 2.0 * (1.0 - p) ** 2
+
+
+def ease_cubic(p):
+    if p < 0.5:
+        return 4.0 * p ** 3
+    return 1.0 - 4.0 * (1.0 - p) ** 3
+
+
+def ease_exponential(p):
+    if p <= 0.0:
+        return 0.0
+    if p >= 1.0:
+        return 1.0
+    if p < 0.5:
+        return 2.0 ** (20.0 * p - 10.0) / 2.0
+    return 1.0 - 2.0 ** (10.0 - 20.0 * p) / 2.0
+
+
+def ease_quadratic_out(p):
+    return 1.0 - (1.0 - p) ** 2
+
+
+CURVES = [
+    ("quadratic", ease_quadratic),
+    ("cubic", ease_cubic),
+    ("exponential", ease_exponential),
+    ("quadratic ease-out", ease_quadratic_out),
+]
+
+
+def main():
+    bits = int(sys.argv[1]) if len(sys.argv) > 1 else 6
+    segments = 1 << bits
+
+    print("/*")
+    print(" *  Zigbee 3.0 4-channel LED strip driver.")
+    print(" *  Copyright (C) 2022 Andrzej Gendek")
+    print(" *")
+    print(" *  This file was generated by ease_gen.py - DO NOT EDIT!")
+    print(" */")
+    print("")
+    print("#ifndef EASE_TABLE_H_")
+    print("#define EASE_TABLE_H_")
+    print("")
+    print("#include <stdint.h>")
+    print("")
+    print("#define EASE_TABLE_BITS     %d" % bits)
+    print("#define EASE_TABLE_POINTS   %d" % (segments + 1))
+    print("")
+    print("/* easing curves, the last point is full scale (1 << 16) */")
+    print("static const uint32_t ease_table[][EASE_TABLE_POINTS] = {")
+    for name, curve in CURVES:
+        values = [int(round(curve(i / segments) * EASE_ONE)) for i in range(segments + 1)]
+        values[0] = 0
+        values[-1] = EASE_ONE
+        print("    /* %s */" % name)
+        print("    {")
+        for i in range(0, len(values), 8):
+            print("        " + ", ".join(str(v) for v in values[i:i + 8]) + ",")
+        print("    },")
+    print("};")
+    print("")
+    print("#endif /* EASE_TABLE_H_ */")
+
+
+if __name__ == "__main__":
+    main()
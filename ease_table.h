@@ -0,0 +1,68 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This file was generated by ease_gen.py - DO NOT EDIT!
+ */
+
+#ifndef EASE_TABLE_H_
+#define EASE_TABLE_H_
+
+#include <stdint.h>
+
+#define EASE_TABLE_BITS     6
+#define EASE_TABLE_POINTS   65
+
+/* easing curves, the last point is full scale (1 << 16) */
+static const uint32_t ease_table[][EASE_TABLE_POINTS] = {
+    /* quadratic */
+    {
+        0, 32, 128, 288, 512, 800, 1152, 1568,
+        2048, 2592, 3200, 3872, 4608, 5408, 6272, 7200,
+        8192, 9248, 10368, 11552, 12800, 14112, 15488, 16928,
+        18432, 20000, 21632, 23328, 25088, 26912, 28800, 30752,
+        32768, 34784, 36736, 38624, 40448, 42208, 43904, 45536,
+        47104, 48608, 50048, 51424, 52736, 53984, 55168, 56288,
+        57344, 58336, 59264, 60128, 60928, 61664, 62336, 62944,
+        63488, 63968, 64384, 64736, 65024, 65248, 65408, 65504,
+        65536,
+    },
+    /* cubic */
+    {
+        0, 1, 8, 27, 64, 125, 216, 343,
+        512, 729, 1000, 1331, 1728, 2197, 2744, 3375,
+        4096, 4913, 5832, 6859, 8000, 9261, 10648, 12167,
+        13824, 15625, 17576, 19683, 21952, 24389, 27000, 29791,
+        32768, 35745, 38536, 41147, 43584, 45853, 47960, 49911,
+        51712, 53369, 54888, 56275, 57536, 58677, 59704, 60623,
+        61440, 62161, 62792, 63339, 63808, 64205, 64536, 64807,
+        65024, 65193, 65320, 65411, 65472, 65509, 65528, 65535,
+        65536,
+    },
+    /* exponential */
+    {
+        0, 40, 49, 61, 76, 95, 117, 146,
+        181, 225, 279, 347, 431, 535, 664, 825,
+        1024, 1272, 1579, 1961, 2435, 3025, 3756, 4664,
+        5793, 7194, 8933, 11094, 13777, 17109, 21247, 26386,
+        32768, 39150, 44289, 48427, 51759, 54442, 56603, 58342,
+        59743, 60872, 61780, 62511, 63101, 63575, 63957, 64264,
+        64512, 64711, 64872, 65001, 65105, 65189, 65257, 65311,
+        65355, 65390, 65419, 65441, 65460, 65475, 65487, 65496,
+        65536,
+    },
+    /* quadratic ease-out */
+    {
+        0, 2032, 4032, 6000, 7936, 9840, 11712, 13552,
+        15360, 17136, 18880, 20592, 22272, 23920, 25536, 27120,
+        28672, 30192, 31680, 33136, 34560, 35952, 37312, 38640,
+        39936, 41200, 42432, 43632, 44800, 45936, 47040, 48112,
+        49152, 50160, 51136, 52080, 52992, 53872, 54720, 55536,
+        56320, 57072, 57792, 58480, 59136, 59760, 60352, 60912,
+        61440, 61936, 62400, 62832, 63232, 63600, 63936, 64240,
+        64512, 64752, 64960, 65136, 65280, 65392, 65472, 65520,
+        65536,
+    },
+};
+
+#endif /* EASE_TABLE_H_ */
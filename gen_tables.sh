@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+#  Zigbee 3.0 4-channel LED strip driver.
+#  Copyright (C) 2022 Andrzej Gendek
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+#  Regenerates precomputed tables from their generators (pre-build step of
+#  the project). Tables are rewritten only when changed, so they don't force
+#  a rebuild. With --check nothing is written and the script fails when
+#  a committed table differs from its generator output.
+#
+#  usage: ./gen_tables.sh [--check]
+#
+
+cd "$(dirname "$0")" || exit 1
+
+CHECK=0
+STATUS=0
+
+if [ "$1" = "--check" ]; then
+    CHECK=1
+fi
+
+gen_table()
+{
+    TABLE=$1
+    shift
+    TMP=$(mktemp) || exit 1
+
+    if ! python3 "$@" > "$TMP"; then
+        echo "$1 failed"
+        rm -f "$TMP"
+        exit 1
+    fi
+
+    if cmp -s "$TMP" "$TABLE"; then
+        rm -f "$TMP"
+    elif [ $CHECK -eq 1 ]; then
+        echo "$TABLE differs from $* output"
+        diff -u "$TABLE" "$TMP"
+        rm -f "$TMP"
+        STATUS=1
+    else
+        cat "$TMP" > "$TABLE"
+        rm -f "$TMP"
+        echo "$TABLE regenerated by $*"
+    fi
+}
+
+gen_table cie_table.h cie_gen.py
+gen_table ease_table.h ease_gen.py
+
+exit $STATUS
@@ -0,0 +1,171 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app.h"
+
+#if APP_AUX_LETIMER
+
+#include "led_aux.h"
+#include "dbg_log.h"
+
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_letimer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LED_AUX_LETIMER             LETIMER0
+#define LED_AUX_LETIMER_CLOCK       cmuClock_LETIMER0
+
+/* 64 steps at 32768 Hz LETIMER clock is 512 Hz PWM, enough for status LED */
+#define LED_AUX_TOP                 63
+
+#define LED_AUX_COUNTER_MAX         0xFFFFFF
+
+typedef struct
+{
+    sl_led_pwm_t    *led;
+    uint32_t        clock;
+    bool            routed;     /* pin is driven by LETIMER */
+    bool            blinking;
+
+} LedAuxModule;
+
+static LedAuxModule led_aux;
+
+/**
+ * @brief
+ *  Stops LETIMER and drives the pin directly, used for fully on and off
+ *  output, so LETIMER doesn't run while AUX is static.
+ */
+static void led_aux_static_set(bool active)
+{
+    sl_led_pwm_t *led = led_aux.led;
+
+    LETIMER_Enable(LED_AUX_LETIMER, false);
+    GPIO->LETIMERROUTE[0].ROUTEEN = 0;
+    GPIO_PinModeSet(led->port, led->pin, gpioModePushPull, active != (led->polarity != 0));
+
+    led_aux.routed = false;
+    led_aux.blinking = false;
+}
+
+/**
+ * @brief
+ *  Runs LETIMER PWM, output is active from COMP1 match to counter underflow.
+ */
+static void led_aux_pwm_run(uint32_t top, uint32_t comp1)
+{
+    LETIMER_Enable(LED_AUX_LETIMER, false);
+    LETIMER_TopSet(LED_AUX_LETIMER, top);
+    LETIMER_CompareSet(LED_AUX_LETIMER, 1, comp1);
+    LETIMER_CounterSet(LED_AUX_LETIMER, top);
+
+    if (led_aux.routed == false)
+    {
+        GPIO->LETIMERROUTE[0].ROUTEEN = GPIO_LETIMER_ROUTEEN_OUT0PEN;
+        led_aux.routed = true;
+    }
+
+    LETIMER_Enable(LED_AUX_LETIMER, true);
+}
+
+static void led_aux_init(sl_led_pwm_t *led)
+{
+    led_aux.led = led;
+
+    CMU_ClockEnable(cmuClock_GPIO, true);
+    CMU_ClockEnable(LED_AUX_LETIMER_CLOCK, true);
+
+    LETIMER_Init_TypeDef init = LETIMER_INIT_DEFAULT;
+
+    init.enable = false;
+    init.comp0Top = true;
+    init.topValue = LED_AUX_TOP;
+    init.out0Pol = led->polarity;       /* idle output level */
+    init.ufoa0 = letimerUFOAPwm;
+    init.repMode = letimerRepeatFree;
+    LETIMER_Init(LED_AUX_LETIMER, &init);
+
+    GPIO->LETIMERROUTE[0].OUT0ROUTE = (led->port << _GPIO_LETIMER_OUT0ROUTE_PORT_SHIFT) |
+                                      (led->pin << _GPIO_LETIMER_OUT0ROUTE_PIN_SHIFT);
+
+    led_aux.clock = CMU_ClockFreqGet(LED_AUX_LETIMER_CLOCK);
+    led->frequency = led_aux.clock / (LED_AUX_TOP + 1);
+    led->resolution = LED_AUX_TOP + 1;
+
+    led_aux_static_set(false);
+
+    DBG_LOG("AUX on LETIMER, PWM %d Hz", led->frequency);
+}
+
+static uint32_t led_aux_top_get(sl_led_pwm_t *led)
+{
+    (void)led;
+
+    return LED_AUX_TOP;
+}
+
+static void led_aux_compare_set(sl_led_pwm_t *led, uint32_t compare)
+{
+    (void)led;
+
+    if (compare == 0 || compare > LED_AUX_TOP)
+    {
+        led_aux_static_set(compare != 0);
+        return;
+    }
+
+    if (led_aux.routed && led_aux.blinking == false)
+    {
+        /* PWM is running, next period is generated with new duty */
+        LETIMER_CompareSet(LED_AUX_LETIMER, 1, compare - 1);
+        return;
+    }
+
+    led_aux.blinking = false;
+    led_aux_pwm_run(LED_AUX_TOP, compare - 1);
+}
+
+bool led_aux_blink_start(uint32_t on_ms, uint32_t off_ms)
+{
+    uint32_t on = (on_ms * led_aux.clock) / 1000;
+    uint32_t period = ((on_ms + off_ms) * led_aux.clock) / 1000;
+
+    if (led_aux.led == NULL || on == 0 || period <= on || period > LED_AUX_COUNTER_MAX)
+    {
+        return false;
+    }
+
+    /* blink period is one PWM period, active part is on time */
+    led_aux_pwm_run(period - 1, on - 1);
+    led_aux.blinking = true;
+
+    return true;
+}
+
+const LedPwmBackend led_aux_backend =
+{
+    .init = led_aux_init,
+    .top_get = led_aux_top_get,
+    .compare_set = led_aux_compare_set,
+    .flush = NULL,
+};
+
+#endif /* APP_AUX_LETIMER */
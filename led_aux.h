@@ -0,0 +1,41 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_AUX_H_
+#define LED_AUX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_pwm_backend.h"
+
+/* PWM backend of AUX channel on LETIMER0 (APP_AUX_LETIMER) */
+extern const LedPwmBackend led_aux_backend;
+
+/**
+ * @brief
+ *  Starts blinking of AUX output played by LETIMER without CPU, also in EM2.
+ *  Output is fully on during on time. Blinking is stopped by the next level
+ *  set on AUX channel.
+ *
+ * @param on_ms - on time of blink period
+ * @param off_ms - off time of blink period
+ * @return true when blinking was started
+ */
+bool led_aux_blink_start(uint32_t on_ms, uint32_t off_ms);
+
+#endif /* LED_AUX_H_ */
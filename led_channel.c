@@ -17,167 +17,1493 @@
  */
 
 #include "led_channel.h"
+#include "led_curve.h"
+#include "led_pwm_backend.h"
 #include "sl_pwm_led.h"
+#include "sl_pwm_led_ext.h"
 #include "pin_config.h"
 #include "dbg_log.h"
 #include "app.h"
+#include "em_core.h"
+#include "zigbee_app_framework_event.h"
+#include "sl_component_catalog.h"
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+#include "sl_power_manager.h"
+#endif
+#if APP_DMA_TRANSITIONS
+#include "led_fade.h"
+#endif
+#if APP_EXT_CHANNEL_COUNT > 0
+#include "led_pca9685.h"
+#endif
+#if APP_PIXEL_CHANNEL_COUNT > 0
+#include "led_pixel.h"
+#endif
+#if APP_AUX_LETIMER
+#include "led_aux.h"
+#endif
+#if APP_METERING
+#include "led_meter.h"
+#endif
+#if APP_WAVE_MONITOR
+#include "led_wave.h"
+#endif
 
 #include <stddef.h>
 
 #define LED_CHANNEL_PWM_FREQ        1000
+
+/* runtime PWM frequency limits, upper one is lowered when TIMER clock
+ * can't provide LED_CHANNEL_MIN_COUNTS in PWM period */
+#define LED_CHANNEL_PWM_FREQ_MAX    20000
+#define LED_CHANNEL_MIN_COUNTS      256
+
+/* when enabled TIMER TOP is sized to PWM frequency (12-16 bits) and ZCL levels
+ * are mapped with full curve resolution, else legacy 254 steps are used */
+#define LED_CHANNEL_HIGH_RES        1
+
+#if LED_CHANNEL_HIGH_RES
+#define LED_CHANNEL_RES             0       /* derived from PWM frequency */
+#else
 #define LED_CHANNEL_RES             254
+#endif
 
-const uint8_t cie_100_254[] = {
-    0, 1, 1, 1, 1, 2, 2, 2, 2,
-    3, 3, 3, 4, 4, 4, 5, 5, 6, 6,
-    7, 8, 8, 9, 10, 10, 11, 12, 13, 14,
-    15, 16, 17, 18, 19, 20, 21, 22, 24, 25,
-    26, 28, 29, 31, 33, 34, 36, 38, 40, 41,
-    43, 45, 47, 50, 52, 54, 56, 59, 61, 64,
-    66, 69, 72, 74, 77, 80, 83, 86, 89, 93,
-    96, 99, 103, 106, 110, 114, 117, 121, 125, 129,
-    133, 138, 142, 146, 151, 155, 160, 165, 170, 174,
-    180, 185, 190, 195, 201, 206, 212, 217, 223, 229,
-    235, 254
-};
+#define LED_CHANNEL_LUT_SIZE        256
 
-const uint8_t cie_254_254[] = {
-    0, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 3, 3, 3, 3, 3,
-    3, 3, 4, 4, 4, 4, 4, 4, 4, 5,
-    5, 5, 5, 5, 6, 6, 6, 6, 6, 7,
-    7, 7, 7, 8, 8, 8, 8, 9, 9, 9,
-    9, 10, 10, 10, 11, 11, 11, 11, 12, 12,
-    12, 13, 13, 13, 14, 14, 15, 15, 15, 16,
-    16, 17, 17, 17, 18, 18, 19, 19, 20, 20,
-    21, 21, 21, 22, 22, 23, 23, 24, 25, 25,
-    26, 26, 27, 27, 28, 28, 29, 30, 30, 31,
-    31, 32, 33, 33, 34, 35, 35, 36, 37, 37,
-    38, 39, 40, 40, 41, 42, 43, 43, 44, 45,
-    46, 47, 47, 48, 49, 50, 51, 52, 52, 53,
-    54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
-    64, 65, 66, 67, 68, 69, 70, 71, 72, 73,
-    74, 75, 77, 78, 79, 80, 81, 82, 84, 85,
-    86, 87, 88, 90, 91, 92, 94, 95, 96, 97,
-    99, 100, 102, 103, 104, 106, 107, 109, 110, 111,
-    113, 114, 116, 117, 119, 120, 122, 123, 125, 127,
-    128, 130, 131, 133, 135, 136, 138, 140, 141, 143,
-    145, 147, 148, 150, 152, 154, 155, 157, 159, 161,
-    163, 165, 167, 169, 170, 172, 174, 176, 178, 180,
-    182, 184, 186, 188, 191, 193, 195, 197, 199, 201,
-    203, 205, 208, 210, 212, 214, 217, 219, 221, 223,
-    226, 228, 231, 233, 235, 254,
-};
+/* when enabled channels switching at the same time are spread over PWM period
+ * (in ex. CH2 is aligned to period end, TIMER2 is shifted by half of period,
+ * see APP_CHANNEL_TABLE and APP_TIMER_TABLE), so
+ * MOSFETs are not turned on all together */
+#ifndef LED_CHANNEL_PHASE_STAGGER
+#define LED_CHANNEL_PHASE_STAGGER   1
+#endif
 
-static sl_led_pwm_t channels[] =
+/* when enabled fractional levels are synthesized by alternating adjacent compare
+ * values in TIMER overflow interrupt (sigma-delta, 8 fractional bits) */
+#ifndef LED_CHANNEL_DITHER
+#define LED_CHANNEL_DITHER          0
+#endif
+
+#define LED_CHANNEL_DITHER_BITS     8
+
+/* when enabled TIMER is stopped, its clock gated and EM1 requirement released
+ * while all of its channels are dark */
+#define LED_CHANNEL_CLOCK_GATING    1
+
+/* TIMER is released when its channels are dark for this time, so zero compare
+ * values are latched and short effect pauses don't toggle the clock */
+#define LED_CHANNEL_GATE_DELAY_MS   100
+
+/* channel mask restored from NVM is verified when light is already restored,
+ * probe of lit channel is retried later */
+#define LED_CHANNEL_VERIFY_DELAY_MS         3000
+#define LED_CHANNEL_VERIFY_RETRY_MS         60000
+
+/* idle current estimate (EFR32MG21 datasheet, approximate): running TIMER and
+ * EM1 above EM2 floor at 80 MHz */
+#define LED_CHANNEL_TIMER_UA_PER_MHZ    3
+#define LED_CHANNEL_EM1_UA              1600
+
+typedef struct
 {
-    {
-        .port = LED_CH1_PORT,
-        .pin = LED_CH1_PIN,
-        .level = LED_CHANNEL_RES - 1,
-        .polarity = 0,
-        .channel = 0,
-        .timer = TIMER1,
-        .frequency = LED_CHANNEL_PWM_FREQ,
-        .resolution = LED_CHANNEL_RES,
+    uint16_t    lut[LED_CHANNEL_LUT_SIZE];  /* level -> TIMER compare value */
+    uint16_t    compare;                    /* currently applied compare value */
+    uint16_t    level_q8;                   /* applied level, 8 fractional bits */
+    uint16_t    mix_q15;                    /* share of level output (LED_CHANNEL_MIX_ONE - whole) */
+    uint32_t    period;                     /* TIMER counts in PWM period the table is built for */
+    bool        right_aligned;              /* pulse at the end of PWM period */
+    bool        dma_driven;                 /* compare is written by LDMA fade, applied one isn't known */
+#if LED_CHANNEL_CLOCK_GATING
+    bool        lit;                        /* output holds reference of its TIMER */
+#endif
+#if LED_CHANNEL_DITHER
+    uint8_t     dither_frac;                /* fractional part of compare value */
+    uint8_t     dither_acc;                 /* error accumulator */
+#endif
+} LedChannelOutput;
+
+#define LED_CHANNEL_PWM(name, timer_num, cc, pol, right)   \
+    {                                                       \
+        .port = LED_##name##_PORT,                          \
+        .pin = LED_##name##_PIN,                            \
+        .level = 0,                                         \
+        .polarity = pol,                                    \
+        .channel = cc,                                      \
+        .timer = TIMER##timer_num,                          \
+        .frequency = LED_CHANNEL_PWM_FREQ,                  \
+        .resolution = LED_CHANNEL_RES,                      \
     },
-    {
-        .port = LED_CH2_PORT,
-        .pin = LED_CH2_PIN,
-        .level = LED_CHANNEL_RES - 1,
-        .polarity = 0,
-        .channel = 1,
-        .timer = TIMER1,
-        .frequency = LED_CHANNEL_PWM_FREQ,
-        .resolution = LED_CHANNEL_RES,
+
+/* output of external controller, frequency and resolution are set by backend init */
+#define LED_CHANNEL_EXT_PWM(name, output, pol)              \
+    {                                                       \
+        .polarity = pol,                                    \
+        .channel = output,                                  \
+        .timer = NULL,                                      \
     },
-    {
-        .port = LED_CH3_PORT,
-        .pin = LED_CH3_PIN,
-        .level = LED_CHANNEL_RES - 1,
-        .polarity = 0,
-        .channel = 2,
-        .timer = TIMER1,
-        .frequency = LED_CHANNEL_PWM_FREQ,
-        .resolution = LED_CHANNEL_RES,
+
+/* color byte of pixel strip segment */
+#define LED_CHANNEL_PIXEL_PWM(name, first, count, color)   \
+    {                                                       \
+        .channel = LedPixelSegment_##name,                  \
+        .timer = NULL,                                      \
     },
-    {
-        .port = LED_CH4_PORT,
-        .pin = LED_CH4_PIN,
-        .level = LED_CHANNEL_RES - 1,
-        .polarity = 0,
-        .channel = 0,
-        .timer = TIMER2,
-        .frequency = LED_CHANNEL_PWM_FREQ,
-        .resolution = LED_CHANNEL_RES,
+
+#if APP_AUX_LETIMER
+/* status LED pin driven by LETIMER, TIMER of APP_CHANNEL_AUX is not used */
+#define LED_CHANNEL_AUX_PWM(name, timer_num, cc, pol, right)   \
+    {                                                       \
+        .port = LED_##name##_PORT,                          \
+        .pin = LED_##name##_PIN,                            \
+        .polarity = pol,                                    \
+        .timer = NULL,                                      \
     },
-    {
-        .port = LED_AUX_PORT,
-        .pin = LED_AUX_PIN,
-        .level = LED_CHANNEL_RES - 1,
-        .polarity = 1,
-        .channel = 0,
-        .timer = TIMER3,
-        .frequency = LED_CHANNEL_PWM_FREQ,
-        .resolution = LED_CHANNEL_RES,
-    }
+#else
+#define LED_CHANNEL_AUX_PWM         LED_CHANNEL_PWM
+#endif
+
+static sl_led_pwm_t channels[] =
+{
+    APP_CHANNEL_TABLE(LED_CHANNEL_PWM)
+    APP_CHANNEL_EXT_TABLE(LED_CHANNEL_EXT_PWM)
+    APP_CHANNEL_PIXEL_TABLE(LED_CHANNEL_PIXEL_PWM)
+    APP_CHANNEL_AUX(LED_CHANNEL_AUX_PWM)
+};
+
+static void led_channel_timer_init(sl_led_pwm_t *led)
+{
+    sl_pwm_led_init(led);
+}
+
+static uint32_t led_channel_timer_top_get(sl_led_pwm_t *led)
+{
+    return TIMER_TopGet(led->timer);
+}
+
+static void led_channel_timer_compare_set(sl_led_pwm_t *led, uint32_t compare)
+{
+    sl_pwm_led_set_compare(led, compare);
+}
+
+/* CC buffers are latched on TIMER overflow, nothing to flush */
+static const LedPwmBackend led_channel_timer_backend =
+{
+    .init = led_channel_timer_init,
+    .top_get = led_channel_timer_top_get,
+    .compare_set = led_channel_timer_compare_set,
+    .flush = NULL,
+};
+
+#define LED_CHANNEL_TIMER_BACKEND(...)      &led_channel_timer_backend,
+#define LED_CHANNEL_EXT_BACKEND(...)        &led_pca9685_backend,
+#define LED_CHANNEL_PIXEL_BACKEND(...)      &led_pixel_backend,
+#if APP_AUX_LETIMER
+#define LED_CHANNEL_AUX_BACKEND(...)        &led_aux_backend,
+#else
+#define LED_CHANNEL_AUX_BACKEND             LED_CHANNEL_TIMER_BACKEND
+#endif
+
+static const LedPwmBackend* const channels_backend[ARRAY_SIZE(channels)] =
+{
+    APP_CHANNEL_TABLE(LED_CHANNEL_TIMER_BACKEND)
+    APP_CHANNEL_EXT_TABLE(LED_CHANNEL_EXT_BACKEND)
+    APP_CHANNEL_PIXEL_TABLE(LED_CHANNEL_PIXEL_BACKEND)
+    APP_CHANNEL_AUX(LED_CHANNEL_AUX_BACKEND)
+};
+
+/* TIMER channels support phase stagger, dithering, clock gating, frequency
+ * change and LDMA transitions, external outputs only levels */
+static bool led_channel_is_timer(LedChannel ch)
+{
+    return channels_backend[ch] == &led_channel_timer_backend;
+}
+
+static LedChannelOutput outputs[ARRAY_SIZE(channels)];
+
+#if LED_CHANNEL_PHASE_STAGGER
+#define LED_CHANNEL_RIGHT_ALIGNED(name, timer_num, cc, pol, right)     right,
+#define LED_CHANNEL_EXT_RIGHT_ALIGNED(...)                              false,
+
+/* in ex. CH1, CH3 pulses start on TIMER1 overflow, CH2 pulse ends on it */
+static const bool channels_right_aligned[ARRAY_SIZE(channels)] =
+{
+    APP_CHANNEL_TABLE(LED_CHANNEL_RIGHT_ALIGNED)
+    APP_CHANNEL_EXT_TABLE(LED_CHANNEL_EXT_RIGHT_ALIGNED)
+    APP_CHANNEL_PIXEL_TABLE(LED_CHANNEL_EXT_RIGHT_ALIGNED)
+    APP_CHANNEL_AUX(LED_CHANNEL_RIGHT_ALIGNED)
+};
+#endif
+
+typedef struct
+{
+    TIMER_TypeDef   *timer;
+    IRQn_Type       irq;
+    uint8_t         phase;          /* counter offset in percent of PWM period */
+#if LED_CHANNEL_CLOCK_GATING
+    uint8_t         refs;           /* channels with non zero output */
+    bool            running;        /* clock enabled, counter started, EM1 required */
+#endif
+
+} LedChannelTimer;
+
+#if LED_CHANNEL_CLOCK_GATING
+#define LED_CHANNEL_TIMER(num, phase)   { TIMER##num, TIMER##num##_IRQn, phase, 0, true },
+#else
+#define LED_CHANNEL_TIMER(num, phase)   { TIMER##num, TIMER##num##_IRQn, phase },
+#endif
+
+static LedChannelTimer timers[] =
+{
+    APP_TIMER_TABLE(LED_CHANNEL_TIMER)
 };
 
 static uint32_t channels_mask = 0;
+static uint32_t channels_unverified = 0;    /* channels enabled from NVM, not probed yet */
+static uint32_t channels_probed = 0;
+static sl_zigbee_event_t channels_verify_event;
+static uint32_t boot_to_light_ms = 0;
 
-void led_channel_init(void)
+/* levels staged in the current tick, committed together from event */
+typedef struct
 {
-    for(size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    uint32_t            mask;
+    uint16_t            levels_q8[ARRAY_SIZE(channels)];
+    uint16_t            mixes[ARRAY_SIZE(channels)];
+    sl_zigbee_event_t   event;
+
+} LedChannelCommit;
+
+static LedChannelCommit commit;
+
+#if LED_CHANNEL_CLOCK_GATING
+static sl_zigbee_event_t timers_gate_event;
+#endif
+
+#if LED_CHANNEL_DITHER
+static volatile uint32_t dither_mask = 0;   /* channels with fractional compare value */
+static uint32_t dither_isr_cycles_max = 0;
+#endif
+
+static LedChannelTimer* led_channel_timer_get(TIMER_TypeDef *timer)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(timers) - 1; i++)
+    {
+        if (timers[i].timer == timer)
+        {
+            return &timers[i];
+        }
+    }
+
+    return &timers[ARRAY_SIZE(timers) - 1];
+}
+
+/**
+ * @brief
+ *  Builds level -> compare value table for the channel. Called when TIMER TOP
+ *  is changed, so the level update itself is only a table lookup.
+ *
+ * @param ch - channel to build table for
+ * @param top - TIMER (or external controller) TOP value the table is built for
+ */
+static void led_channel_lut_build(LedChannel ch, uint32_t top)
+{
+    uint32_t max_count = led_channel_is_timer(ch) ? TIMER_MaxCount(channels[ch].timer) : top + 1;
+    uint16_t *lut = outputs[ch].lut;
+
+    for (size_t i = 0; i < LED_CHANNEL_LUT_SIZE; i++)
+    {
+        uint32_t value = led_curve_value_get(ch, i);
+#if LED_CHANNEL_HIGH_RES
+        /* full scale is TOP + 1, so max level keeps the output constantly on */
+        uint32_t compare = (value * (top + 1) + LED_CURVE_MAX / 2) / LED_CURVE_MAX;
+#else
+        uint32_t compare = ((value * (LED_CHANNEL_RES - 1) + LED_CURVE_MAX / 2) / LED_CURVE_MAX) *
+                           (top / (LED_CHANNEL_RES - 1));
+#endif
+        if (compare > max_count)
+        {
+            compare = max_count;
+        }
+
+        if (outputs[ch].right_aligned)
+        {
+            compare = top + 1 - compare;
+        }
+
+        lut[i] = (uint16_t)compare;
+    }
+
+    outputs[ch].period = top + 1;
+
+    DBG_LOG("Channel %d TOP %d, level 1 -> %d", ch, top, lut[1]);
+}
+
+#if LED_CHANNEL_PHASE_STAGGER
+/**
+ * @brief
+ *  Restarts TIMERs with counter offsets from APP_TIMER_TABLE. Timers run from
+ *  the same clock with the same TOP, so the offsets are kept afterwards.
+ */
+static void led_channel_timers_phase_set(void)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_CRITICAL();
+    for (size_t i = 0; i < ARRAY_SIZE(timers); i++)
+    {
+        uint32_t top = TIMER_TopGet(timers[i].timer);
+
+        TIMER_Enable(timers[i].timer, false);
+        TIMER_CounterSet(timers[i].timer, ((top + 1) * timers[i].phase) / 100);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(timers); i++)
+    {
+        TIMER_Enable(timers[i].timer, true);
+    }
+    CORE_EXIT_CRITICAL();
+}
+#endif
+
+uint8_t led_channel_peak_on_count_get(void)
+{
+    TIMER_TypeDef *ref_timer = channels[LedChannel_CH1].timer;
+    uint32_t period = TIMER_TopGet(ref_timer) + 1;
+    uint32_t start[APP_EP_COUNT];
+    uint32_t len[APP_EP_COUNT];
+    uint8_t peak = 0;
+
+    for (size_t i = 0; i < APP_EP_COUNT; i++)
+    {
+        uint32_t compare = outputs[i].dma_driven ? 0 : outputs[i].compare;
+        uint32_t offset = 0;
+
+        /* external outputs run from own oscillator, they are not modeled */
+        if (led_channel_is_timer(i) == false)
+        {
+            len[i] = 0;
+            start[i] = 0;
+            continue;
+        }
+
+        len[i] = outputs[i].right_aligned ? period - compare : compare;
+        start[i] = outputs[i].right_aligned ? compare : 0;
+
+#if LED_CHANNEL_PHASE_STAGGER
+        if (channels[i].timer != ref_timer)
+        {
+            /* counter ahead of reference TIMER overflows earlier */
+            int32_t phase = led_channel_timer_get(ref_timer)->phase - led_channel_timer_get(channels[i].timer)->phase;
+
+            offset = (period + (period * (100 + phase)) / 100) % period;
+        }
+#endif
+
+        start[i] = (start[i] + offset) % period;
+    }
+
+    /* peak is always at start of one of the pulses */
+    for (size_t i = 0; i < APP_EP_COUNT; i++)
     {
-        if (i < ARRAY_SIZE(channels) - 1)
+        uint8_t count = 0;
+
+        if (len[i] == 0)
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j < APP_EP_COUNT; j++)
         {
-            GPIO_PinModeSet(channels[i].port,
-                            channels[i].pin,
-                            gpioModeInputPull,
-                            1);
-            bool disabled = GPIO_PinInGet(channels[i].port, channels[i].pin) != 0;
+            uint32_t pos = (start[i] + period - start[j]) % period;
 
-            DBG_LOG("Channel %d is %s", i, disabled ? "disabled" : "enabled");
-            if (!disabled)
+            if (pos < len[j])
             {
-                channels_mask |= (1 << i);
+                count++;
             }
         }
 
-        sl_pwm_led_init(&channels[i]);
+        if (count > peak)
+        {
+            peak = count;
+        }
     }
+
+    return peak;
 }
 
-void led_channel_endpoints_enable(void)
+#if LED_CHANNEL_CLOCK_GATING
+
+/* any channel of the TIMER can be used to control it */
+static sl_led_pwm_t* led_channel_timer_pwm_get(TIMER_TypeDef *timer)
 {
-    for(size_t i = 0; i < APP_EP_COUNT; i++)
+    for (size_t i = 0; i < ARRAY_SIZE(channels) - 1; i++)
     {
-        size_t mask = 1 << i;
+        if (channels[i].timer == timer)
+        {
+            return &channels[i];
+        }
+    }
+
+    return &channels[ARRAY_SIZE(channels) - 1];
+}
+
+/**
+ * @brief
+ *  Starts gated TIMER. Lit outputs are routed with their compare values while
+ *  the counter is stopped (released outputs are inactive), then the counter
+ *  is set just before overflow (or to phase offset of the other running
+ *  TIMER), so output is restored within one PWM period.
+ */
+static void led_channel_timer_acquire(LedChannelTimer *t)
+{
+    uint32_t top = TIMER_TopGet(t->timer);
+    uint32_t counter = top;
+    CORE_DECLARE_IRQ_STATE;
+
+    sl_pwm_led_timer_enable(led_channel_timer_pwm_get(t->timer), true);
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+    sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+    CORE_ENTER_CRITICAL();
+#if LED_CHANNEL_PHASE_STAGGER
+    /* phase is restored against any running TIMER */
+    for (size_t i = 0; i < ARRAY_SIZE(timers); i++)
+    {
+        if (timers[i].running && &timers[i] != t && t->phase != timers[i].phase)
+        {
+            uint32_t offset = ((top + 1) * (100 + t->phase - timers[i].phase)) / 100;
+
+            counter = (TIMER_CounterGet(timers[i].timer) + offset) % (top + 1);
+            break;
+        }
+    }
+#endif
 
-        emberAfEndpointEnableDisable(i + 1, (channels_mask & mask) != 0);
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer == t->timer && outputs[i].lit)
+        {
+            sl_pwm_led_set_compare(&channels[i], outputs[i].compare);
+        }
     }
+
+    TIMER_CounterSet(t->timer, counter);
+    TIMER_Enable(t->timer, true);
+    t->running = true;
+    CORE_EXIT_CRITICAL();
 }
 
-void led_channel_level_set(LedChannel ch, uint8_t level)
+static void led_channel_timer_release(LedChannelTimer *t)
 {
-    uint8_t pwm_level = cie_254_254[level];
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer == t->timer)
+        {
+            /* pin is driven to idle level, next compare is written directly */
+            sl_pwm_led_stop(&channels[i]);
+        }
+    }
 
-    sl_pwm_led_set_color(&channels[ch], pwm_level);
+    sl_pwm_led_timer_enable(led_channel_timer_pwm_get(t->timer), false);
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+    t->running = false;
 }
 
-void led_channel_zcl_level_set(LedChannel ch, uint8_t zcl_level)
+static void led_channel_timers_gate_event_cb(sl_zigbee_event_t *event)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(timers); i++)
+    {
+        if (timers[i].running && timers[i].refs == 0)
+        {
+            led_channel_timer_release(&timers[i]);
+            DBG_LOG("TIMER %d released, idle current %d [uA]", i + 1, led_channel_idle_current_get());
+        }
+    }
+}
+#endif
+
+/**
+ * @brief
+ *  Updates reference of channel TIMER after its output was changed. TIMER is
+ *  started by the first lit channel, before new compare value is written, and
+ *  released from event when all of its channels are dark.
+ *
+ * @param ch - PWM channel
+ */
+static void led_channel_timer_ref_update(LedChannel ch)
 {
-    uint8_t pwm_level = cie_254_254[zcl_level];
+#if LED_CHANNEL_CLOCK_GATING
+    if (led_channel_is_timer(ch) == false)
+    {
+        return;
+    }
+
+    LedChannelOutput *o = &outputs[ch];
+    bool lit = o->dma_driven ||
+               (o->right_aligned ? o->compare < o->period : o->compare != 0);
+
+#if LED_CHANNEL_DITHER
+    lit = lit || o->dither_frac != 0;
+#endif
 
-    if (pwm_level == channels[ch].level)
+    if (lit == o->lit)
     {
         return;
     }
 
+    LedChannelTimer *t = led_channel_timer_get(channels[ch].timer);
+
+    o->lit = lit;
+
+    if (lit)
+    {
+        t->refs++;
+        if (t->running == false)
+        {
+            led_channel_timer_acquire(t);
+        }
+    }
+    else if (--t->refs == 0)
+    {
+        sl_zigbee_event_set_delay_ms(&timers_gate_event, LED_CHANNEL_GATE_DELAY_MS);
+    }
+#else
+    (void)ch;
+#endif
+}
+
+/**
+ * @brief
+ *  Called after output of the channel was changed, updates TIMER reference,
+ *  energy accounting and output quality monitor of the channel.
+ *
+ * @param ch - PWM channel
+ */
+static void led_channel_output_updated(LedChannel ch)
+{
+    led_channel_timer_ref_update(ch);
+
+    if (boot_to_light_ms == 0 && ch != LedChannel_AUX && led_channel_duty_get(ch) != 0)
+    {
+        boot_to_light_ms = halCommonGetInt32uMillisecondTick();
+        DBG_LOG("Boot to light %d ms", boot_to_light_ms);
+    }
+
+#if APP_METERING || APP_WAVE_MONITOR
+    uint32_t duty = led_channel_duty_get(ch);
+#endif
+#if APP_METERING
+    led_meter_duty_update(ch, duty);
+#endif
+#if APP_WAVE_MONITOR
+    led_wave_duty_update(ch, duty);
+#endif
+}
+
+uint32_t led_channel_idle_current_get(void)
+{
+    uint32_t current = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        TIMER_TypeDef *timer = channels[i].timer;
+        bool counted = led_channel_is_timer(i) == false;
+
+        /* each TIMER is counted once, by its first channel */
+        for (size_t j = 0; j < i; j++)
+        {
+            counted = counted || channels[j].timer == timer;
+        }
+
+#if LED_CHANNEL_CLOCK_GATING
+        if (counted || led_channel_timer_get(timer)->running == false)
+#else
+        if (counted)
+#endif
+        {
+            continue;
+        }
+
+        current += (sl_pwm_led_clock_get(&channels[i]) / 1000000) * LED_CHANNEL_TIMER_UA_PER_MHZ;
+    }
+
+    return current > 0 ? current + LED_CHANNEL_EM1_UA : 0;
+}
+
+#if LED_CHANNEL_DITHER
+static void led_channel_dither_isr(TIMER_TypeDef *timer)
+{
+#if defined(DEBUG)
+    uint32_t start = DWT->CYCCNT;
+#endif
+
+    TIMER_IntClear(timer, TIMER_IF_OF);
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if ((dither_mask & (1 << i)) == 0 || channels[i].timer != timer)
+        {
+            continue;
+        }
+
+        LedChannelOutput *o = &outputs[i];
+        uint16_t acc = o->dither_acc + o->dither_frac;
+
+        /* carry selects the upper compare value for the next period */
+        o->dither_acc = (uint8_t)acc;
+        TIMER_CompareBufSet(timer, channels[i].channel, o->compare + (acc >> LED_CHANNEL_DITHER_BITS));
+    }
+
 #if defined(DEBUG)
-    DBG_LOG("ZCL %d PWM %d level set", zcl_level, pwm_level);
+    uint32_t cycles = DWT->CYCCNT - start;
+    if (cycles > dither_isr_cycles_max)
+    {
+        dither_isr_cycles_max = cycles;
+    }
 #endif
+}
+
+#define LED_CHANNEL_TIMER_IRQ_HANDLER(num, phase)   \
+    void TIMER##num##_IRQHandler(void)              \
+    {                                               \
+        led_channel_dither_isr(TIMER##num);         \
+    }
+
+APP_TIMER_TABLE(LED_CHANNEL_TIMER_IRQ_HANDLER)
+
+/**
+ * @brief
+ *  Sets fractional part of channel compare value. Overflow interrupt of the
+ *  TIMER is enabled only when any of its channels has non zero fraction.
+ */
+static void led_channel_dither_set(LedChannel ch, uint8_t frac)
+{
+    TIMER_TypeDef *timer = channels[ch].timer;
+    uint32_t timer_mask = 0;
+    CORE_DECLARE_IRQ_STATE;
 
-    sl_pwm_led_set_color(&channels[ch], pwm_level);
+    /* external outputs have no overflow interrupt, fraction is dropped */
+    if (led_channel_is_timer(ch) == false)
+    {
+        return;
+    }
+
+    CORE_ENTER_CRITICAL();
+    outputs[ch].dither_frac = frac;
+
+    if (frac != 0)
+    {
+        dither_mask |= (1 << ch);
+    }
+    else
+    {
+        dither_mask &= ~(1 << ch);
+    }
+    CORE_EXIT_CRITICAL();
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer == timer)
+        {
+            timer_mask |= (1 << i);
+        }
+    }
+
+    if ((dither_mask & timer_mask) != 0)
+    {
+        TIMER_IntEnable(timer, TIMER_IEN_OF);
+        NVIC_EnableIRQ(led_channel_timer_get(timer)->irq);
+    }
+    else
+    {
+        TIMER_IntDisable(timer, TIMER_IEN_OF);
+        NVIC_DisableIRQ(led_channel_timer_get(timer)->irq);
+        NVIC_ClearPendingIRQ(led_channel_timer_get(timer)->irq);
+    }
+
+    /* fraction keeps output lit even with zero compare value */
+    led_channel_output_updated(ch);
+}
+
+#endif
+
+uint32_t led_channel_dither_isr_cycles_get(void)
+{
+#if LED_CHANNEL_DITHER
+    return dither_isr_cycles_max;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief
+ *  Enters critical section at the moment when none of the TIMERs used by the
+ *  channels is close to overflow. Compare (and TOP) buffers written before
+ *  exit are latched on the same overflow of each TIMER.
+ *
+ * @param mask - channels to be updated
+ * @return IRQ state to be restored by CORE_ExitCritical()
+ */
+static CORE_irqState_t led_channel_update_window_enter(uint32_t mask)
+{
+    for (;;)
+    {
+        CORE_irqState_t irq_state = CORE_EnterCritical();
+        bool in_window = true;
+
+        for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+        {
+            if ((mask & (1 << i)) == 0 || led_channel_is_timer(i) == false)
+            {
+                continue;
+            }
+
+#if LED_CHANNEL_CLOCK_GATING
+            /* stopped counter latches buffers on the first overflow after start */
+            if (led_channel_timer_get(channels[i].timer)->running == false)
+            {
+                continue;
+            }
+#endif
+
+            /* at least quarter of period is left till overflow */
+            uint32_t top = TIMER_TopGet(channels[i].timer);
+            if (TIMER_CounterGet(channels[i].timer) > top - top / 4)
+            {
+                in_window = false;
+                break;
+            }
+        }
+
+        if (in_window)
+        {
+            return irq_state;
+        }
+
+        CORE_ExitCritical(irq_state);
+    }
+}
+
+/**
+ * @brief
+ *  Returns compare value for level with 8 fractional bits. Fraction is
+ *  interpolated between adjacent table entries.
+ *
+ * @param ch - PWM channel
+ * @param level_q8 - level in Q8.8 format
+ * @return compare value in Q8.8 format
+ */
+static int32_t led_channel_compare_q8_get(LedChannel ch, uint16_t level_q8)
+{
+    uint8_t level = level_q8 >> 8;
+    int32_t lo = outputs[ch].lut[level];
+    /* no level above maximum to interpolate with */
+    int32_t hi = level >= LED_CHANNEL_LUT_SIZE - 2 ? lo : outputs[ch].lut[level + 1];
+    int32_t compare_q8 = (lo << 8) + (hi - lo) * (level_q8 & 0xFF);
+
+    if (outputs[ch].mix_q15 < LED_CHANNEL_MIX_ONE)
+    {
+        /* mix scales duty, which is inverted for right aligned output */
+        int32_t period_q8 = (int32_t)outputs[ch].period << 8;
+        int32_t duty_q8 = outputs[ch].right_aligned ? period_q8 - compare_q8 : compare_q8;
+
+        duty_q8 = (int32_t)(((int64_t)duty_q8 * outputs[ch].mix_q15) >> 15);
+        compare_q8 = outputs[ch].right_aligned ? period_q8 - duty_q8 : duty_q8;
+    }
+
+    return compare_q8;
+}
+
+static void led_channel_output_set(LedChannel ch, uint16_t compare)
+{
+    sl_led_pwm_t *led = &channels[ch];
+
+    outputs[ch].compare = compare;
+    outputs[ch].dma_driven = false;
+    led->level = compare;
+
+#if LED_CHANNEL_DITHER
+    if (outputs[ch].dither_frac != 0)
+    {
+        led_channel_dither_set(ch, 0);
+    }
+#endif
+
+    led_channel_output_updated(ch);
+    channels_backend[ch]->compare_set(led, compare);
+
+    if (channels_backend[ch]->flush != NULL)
+    {
+        channels_backend[ch]->flush();
+    }
+}
+
+/**
+ * @brief
+ *  Applies levels of multiple channels on the same PWM period boundary.
+ *
+ * @param mask - channels to update
+ * @param levels_q8 - levels with 8 fractional bits indexed by channel
+ * @param mixes - shares of level output indexed by channel, NULL for whole output
+ */
+static void led_channel_outputs_commit(uint32_t mask, const uint16_t *levels_q8, const uint16_t *mixes)
+{
+    mask &= (1 << ARRAY_SIZE(channels)) - 1;
+    commit.mask &= ~mask;
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if ((mask & (1 << i)) == 0)
+        {
+            continue;
+        }
+
+#if APP_DMA_TRANSITIONS
+        led_fade_stop(i);
+#endif
+
+        outputs[i].level_q8 = levels_q8[i];
+        outputs[i].mix_q15 = mixes != NULL ? mixes[i] : LED_CHANNEL_MIX_ONE;
+
+        int32_t compare_q8 = led_channel_compare_q8_get(i, outputs[i].level_q8);
+        uint8_t frac = 0;
+
+#if LED_CHANNEL_DITHER
+        /* fraction is dithered, outputs without overflow interrupt round it */
+        if (led_channel_is_timer(i))
+        {
+            frac = (uint8_t)compare_q8;
+            compare_q8 -= frac;
+        }
+#endif
+
+        outputs[i].compare = (uint16_t)((compare_q8 + 0x80) >> 8);
+        outputs[i].dma_driven = false;
+        channels[i].level = outputs[i].compare;
+
+#if LED_CHANNEL_DITHER
+        if (outputs[i].dither_frac != frac)
+        {
+            led_channel_dither_set(i, frac);
+        }
+#else
+        (void)frac;
+#endif
+
+        led_channel_output_updated(i);
+    }
+
+    CORE_irqState_t irq_state = led_channel_update_window_enter(mask);
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if ((mask & (1 << i)) != 0)
+        {
+            channels_backend[i]->compare_set(&channels[i], outputs[i].compare);
+        }
+    }
+
+    CORE_ExitCritical(irq_state);
+
+    /* staged values of external controller are sent by the first flush in
+     * one transfer, the others find nothing to send */
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if ((mask & (1 << i)) != 0 && channels_backend[i]->flush != NULL)
+        {
+            channels_backend[i]->flush();
+        }
+    }
+
+#if defined(DEBUG)
+    DBG_LOG("Channels 0x%02X levels committed, peak on count %d", mask,
+            led_channel_peak_on_count_get());
+#endif
+}
+
+void led_channel_levels_set(uint32_t mask, const uint8_t *levels)
+{
+    uint16_t levels_q8[ARRAY_SIZE(channels)];
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        levels_q8[i] = (mask & (1 << i)) != 0 ? levels[i] << 8 : 0;
+    }
+
+    led_channel_outputs_commit(mask, levels_q8, NULL);
+}
+
+static void led_channel_commit_event_cb(sl_zigbee_event_t *event)
+{
+    uint32_t mask = commit.mask;
+
+    commit.mask = 0;
+
+    if (mask != 0)
+    {
+        led_channel_outputs_commit(mask, commit.levels_q8, commit.mixes);
+    }
+}
+
+void led_channel_commit_flush(void)
+{
+    sl_zigbee_event_set_inactive(&commit.event);
+    led_channel_commit_event_cb(&commit.event);
+}
+
+uint32_t led_channel_boot_to_light_get(void)
+{
+    return boot_to_light_ms;
+}
+
+void led_channel_level_stage(LedChannel ch, uint8_t level)
+{
+    led_channel_level_mix_stage(ch, level << 8, LED_CHANNEL_MIX_ONE);
+}
+
+void led_channel_level_fine_stage(LedChannel ch, uint16_t level_q8)
+{
+    led_channel_level_mix_stage(ch, level_q8, LED_CHANNEL_MIX_ONE);
+}
+
+void led_channel_level_mix_stage(LedChannel ch, uint16_t level_q8, uint16_t mix_q15)
+{
+    commit.levels_q8[ch] = level_q8;
+    commit.mixes[ch] = mix_q15 < LED_CHANNEL_MIX_ONE ? mix_q15 : LED_CHANNEL_MIX_ONE;
+    commit.mask |= (1 << ch);
+
+    sl_zigbee_event_set_active(&commit.event);
+}
+
+/**
+ * @brief
+ *  Checks disable jumper of the channel, its pin is pulled up when gate of
+ *  output transistor is not connected. Pin is left as input.
+ *
+ * @param ch - PWM channel driven by TIMER
+ * @return true when channel is enabled
+ */
+static bool led_channel_probe(LedChannel ch)
+{
+    GPIO_PinModeSet(channels[ch].port,
+                    channels[ch].pin,
+                    gpioModeInputPull,
+                    1);
+    bool disabled = GPIO_PinInGet(channels[ch].port, channels[ch].pin) != 0;
+
+    DBG_LOG("Channel %d is %s", ch, disabled ? "disabled" : "enabled");
+
+    return !disabled;
+}
+
+/**
+ * @brief
+ *  Probes channels taken from NVM at boot. Only dark channels are probed, so
+ *  restored light isn't disturbed. When probed mask differs, endpoints are
+ *  updated and new mask is stored for the next boot.
+ */
+static void led_channel_verify_event_cb(sl_zigbee_event_t *event)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(channels) - 1; i++)
+    {
+        if ((channels_unverified & (1 << i)) == 0 || led_channel_duty_get(i) != 0)
+        {
+            continue;
+        }
+
+        if (led_channel_probe(i))
+        {
+            channels_probed |= (1 << i);
+        }
+
+        GPIO_PinModeSet(channels[i].port, channels[i].pin, gpioModePushPull, channels[i].polarity);
+        channels_unverified &= ~(1 << i);
+    }
+
+    if (channels_unverified != 0)
+    {
+        sl_zigbee_event_set_delay_ms(&channels_verify_event, LED_CHANNEL_VERIFY_RETRY_MS);
+        return;
+    }
+
+    if (channels_probed != channels_mask)
+    {
+        DBG_LOG("Channel mask 0x%02X changed to 0x%02X", channels_mask, channels_probed);
+
+        channels_mask = channels_probed;
+        halCommonSetToken(TOKEN_LED_CHANNEL_MASK, &channels_mask);
+        led_channel_endpoints_enable();
+    }
+}
+
+void led_channel_init(void)
+{
+    uint32_t stored_mask;
+
+    led_curve_init();
+
+    /* probe is skipped when mask is known from the previous boot */
+    halCommonGetToken(&stored_mask, TOKEN_LED_CHANNEL_MASK);
+
+    for(size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (i < ARRAY_SIZE(channels) - 1 && led_channel_is_timer(i) == false)
+        {
+            /* external outputs have no disable jumper */
+            channels_mask |= (1 << i);
+            channels_probed |= (1 << i);
+        }
+        else if (i < ARRAY_SIZE(channels) - 1 && stored_mask != LED_CHANNEL_MASK_DEFAULT)
+        {
+            channels_mask |= stored_mask & (1 << i);
+            channels_unverified |= (1 << i);
+        }
+        else if (i < ARRAY_SIZE(channels) - 1 && led_channel_probe(i))
+        {
+            channels_mask |= (1 << i);
+        }
+
+        channels_backend[i]->init(&channels[i]);
+
+#if LED_CHANNEL_PHASE_STAGGER
+        if (channels_right_aligned[i])
+        {
+            outputs[i].right_aligned = true;
+            sl_pwm_led_right_align(&channels[i]);
+        }
+#endif
+
+        outputs[i].mix_q15 = LED_CHANNEL_MIX_ONE;
+        led_channel_lut_build(i, channels_backend[i]->top_get(&channels[i]));
+        outputs[i].compare = outputs[i].lut[0];
+
+#if LED_CHANNEL_PHASE_STAGGER
+        /* right aligned output is dark with TOP + 1 compare value, not zero one, and the
+         * TIMER may be started by another channel before this output is routed */
+        if (outputs[i].right_aligned)
+        {
+            TIMER_CompareSet(channels[i].timer, channels[i].channel, outputs[i].compare);
+            TIMER_CompareBufSet(channels[i].timer, channels[i].channel, outputs[i].compare);
+        }
+#endif
+    }
+
+#if LED_CHANNEL_PHASE_STAGGER
+    led_channel_timers_phase_set();
+#endif
+
+#if LED_CHANNEL_DITHER
+#if defined(DEBUG)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    DBG_LOG("PWM resolution %d counts, %d bits more with dithering",
+            TIMER_TopGet(channels[LedChannel_CH1].timer) + 1, LED_CHANNEL_DITHER_BITS);
+#endif
+
+    sl_zigbee_event_init(&commit.event, led_channel_commit_event_cb);
+    sl_zigbee_event_init(&channels_verify_event, led_channel_verify_event_cb);
+
+    if (stored_mask == LED_CHANNEL_MASK_DEFAULT)
+    {
+        halCommonSetToken(TOKEN_LED_CHANNEL_MASK, &channels_mask);
+    }
+    else
+    {
+        DBG_LOG("Channel mask 0x%02X restored", channels_mask);
+        sl_zigbee_event_set_delay_ms(&channels_verify_event, LED_CHANNEL_VERIFY_DELAY_MS);
+    }
+
+#if LED_CHANNEL_CLOCK_GATING
+    /* TIMERs are started by sl_pwm_led_init(), they are gated till any channel is lit */
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+    for (size_t i = 0; i < ARRAY_SIZE(timers); i++)
+    {
+        sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+    }
+#endif
+
+    sl_zigbee_event_init(&timers_gate_event, led_channel_timers_gate_event_cb);
+    sl_zigbee_event_set_delay_ms(&timers_gate_event, LED_CHANNEL_GATE_DELAY_MS);
+#endif
+
+#if APP_DMA_TRANSITIONS
+    led_fade_init();
+#endif
+}
+
+void led_channel_endpoints_enable(void)
+{
+    for(size_t i = 0; i < APP_EP_COUNT; i++)
+    {
+        size_t mask = 1 << i;
+        bool enabled = (channels_mask & mask) != 0;
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE
+        /* CH2 is driven by tunable white light of endpoint 1 */
+        if (i == LedChannel_CH2)
+        {
+            enabled = false;
+        }
+#endif
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+        /* CH2 - CH4 are driven by color light of endpoint 1 */
+        if (i != LedChannel_CH1)
+        {
+            enabled = false;
+        }
+#endif
+
+        emberAfEndpointEnableDisable(i + 1, enabled);
+    }
+
+    /* ZAP endpoints above APP_CHANNEL_TABLE (in ex. single channel build) */
+    for (uint8_t ep = APP_EP_COUNT + 1; emberAfIndexFromEndpoint(ep) != 0xFF; ep++)
+    {
+        emberAfEndpointEnableDisable(ep, false);
+    }
+}
+
+sl_led_pwm_t* led_channel_pwm_get(LedChannel ch)
+{
+    return &channels[ch];
+}
+
+const uint16_t* led_channel_lut_get(LedChannel ch)
+{
+    return outputs[ch].lut;
+}
+
+bool led_channel_is_dithered(LedChannel ch)
+{
+#if LED_CHANNEL_DITHER
+    return led_channel_is_timer(ch);
+#else
+    (void)ch;
+    return false;
+#endif
+}
+
+void led_channel_output_invalidate(LedChannel ch)
+{
+    outputs[ch].dma_driven = true;
+    /* output is driven externally, so TIMER is kept running */
+    led_channel_output_updated(ch);
+}
+
+void led_channel_level_set(LedChannel ch, uint8_t level)
+{
+    commit.mask &= ~(1 << ch);
+
+#if APP_DMA_TRANSITIONS
+    led_fade_stop(ch);
+#endif
+
+    outputs[ch].level_q8 = level << 8;
+    outputs[ch].mix_q15 = LED_CHANNEL_MIX_ONE;
+    led_channel_output_set(ch, outputs[ch].lut[level]);
+}
+
+void led_channel_zcl_level_set(LedChannel ch, uint8_t zcl_level)
+{
+    uint16_t compare = outputs[ch].lut[zcl_level];
+
+    commit.mask &= ~(1 << ch);
+
+#if APP_DMA_TRANSITIONS
+    led_fade_stop(ch);
+#endif
+
+    outputs[ch].level_q8 = zcl_level << 8;
+    outputs[ch].mix_q15 = LED_CHANNEL_MIX_ONE;
+
+    bool unchanged = compare == outputs[ch].compare;
+
+#if LED_CHANNEL_DITHER
+    /* fraction left by fine level is cleared */
+    unchanged = unchanged && outputs[ch].dither_frac == 0;
+#endif
+
+    if (unchanged)
+    {
+        return;
+    }
+
+    led_channel_output_set(ch, compare);
+
+#if defined(DEBUG)
+    DBG_LOG("ZCL %d PWM %d level set, peak on count %d", zcl_level, compare,
+            led_channel_peak_on_count_get());
+#endif
+}
+
+void led_channel_frequency_range_get(LedChannel ch, uint32_t *min_freq, uint32_t *max_freq)
+{
+    if (led_channel_is_timer(ch) == false)
+    {
+        /* frequency of external controller is fixed by its backend */
+        *min_freq = channels[ch].frequency;
+        *max_freq = channels[ch].frequency;
+        return;
+    }
+
+    uint32_t clock = sl_pwm_led_clock_get(&channels[ch]);
+    /* TOP + 1 compare value has to fit the CC register */
+    uint32_t max_top = TIMER_MaxCount(channels[ch].timer) - 1;
+
+    *min_freq = (clock + max_top) / (max_top + 1);
+    *max_freq = clock / LED_CHANNEL_MIN_COUNTS;
+
+    if (*max_freq > LED_CHANNEL_PWM_FREQ_MAX)
+    {
+        *max_freq = LED_CHANNEL_PWM_FREQ_MAX;
+    }
+
+#if !LED_CHANNEL_HIGH_RES
+    /* legacy mode TOP is fixed multiple of 253 steps */
+    *min_freq = channels[ch].frequency;
+    *max_freq = channels[ch].frequency;
+#endif
+}
+
+#if LED_CHANNEL_HIGH_RES
+/**
+ * @brief
+ *  Writes new TOP and compare values of all channels of the TIMER to buffer
+ *  registers. They are latched together on the next overflow, so none of the
+ *  PWM periods is generated with mixed old and new values.
+ *
+ * @param timer - TIMER to update
+ * @param top - new TOP value
+ */
+static void led_channel_timer_top_set(TIMER_TypeDef *timer, uint32_t top)
+{
+    uint32_t mask = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer == timer)
+        {
+            mask |= (1 << i);
+        }
+    }
+
+    CORE_irqState_t irq_state = led_channel_update_window_enter(mask);
+
+    TIMER_TopBufSet(timer, top);
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer != timer)
+        {
+            continue;
+        }
+
+        int32_t compare_q8 = led_channel_compare_q8_get(i, outputs[i].level_q8);
+
+        outputs[i].compare = (uint16_t)(compare_q8 >> 8);
+        outputs[i].dma_driven = false;
+        channels[i].level = outputs[i].compare;
+#if LED_CHANNEL_DITHER
+        outputs[i].dither_frac = (uint8_t)compare_q8;
+#endif
+
+        if (sl_pwm_led_is_started(&channels[i]))
+        {
+            TIMER_CompareBufSet(timer, channels[i].channel, outputs[i].compare);
+        }
+        else
+        {
+            TIMER_CompareSet(timer, channels[i].channel, outputs[i].compare);
+            TIMER_CompareBufSet(timer, channels[i].channel, outputs[i].compare);
+        }
+    }
+
+    CORE_ExitCritical(irq_state);
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer == timer)
+        {
+            led_channel_output_updated(i);
+        }
+    }
+}
+#endif
+
+/**
+ * @brief
+ *  Changes PWM frequency of channel TIMER, see led_channel_frequency_set().
+ */
+static void led_channel_timer_frequency_set(LedChannel ch, uint32_t frequency)
+{
+#if LED_CHANNEL_HIGH_RES
+    if (led_channel_is_timer(ch) == false)
+    {
+        return;
+    }
+
+    TIMER_TypeDef *timer = channels[ch].timer;
+    uint32_t clock = sl_pwm_led_clock_get(&channels[ch]);
+    uint32_t min_freq;
+    uint32_t max_freq;
+
+    led_channel_frequency_range_get(ch, &min_freq, &max_freq);
+
+    if (frequency < min_freq)
+    {
+        frequency = min_freq;
+    }
+    else if (frequency > max_freq)
+    {
+        frequency = max_freq;
+    }
+
+    uint32_t top = clock / frequency - 1;
+
+    if (top > TIMER_MaxCount(timer) - 1)
+    {
+        top = TIMER_MaxCount(timer) - 1;
+    }
+
+    if (top == TIMER_TopGet(timer))
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer != timer)
+        {
+            continue;
+        }
+
+#if APP_DMA_TRANSITIONS
+        /* LDMA writes values of old table, fade is stopped at reached level */
+        if (led_fade_is_active(i))
+        {
+            outputs[i].level_q8 = led_fade_stop(i) << 8;
+        }
+#endif
+
+        led_channel_lut_build(i, top);
+        channels[i].frequency = clock / (top + 1);
+        channels[i].resolution = top + 1;
+    }
+
+    led_channel_timer_top_set(timer, top);
+
+#if LED_CHANNEL_DITHER
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].timer == timer)
+        {
+            led_channel_dither_set(i, outputs[i].dither_frac);
+        }
+    }
+#endif
+
+#else
+    (void)ch;
+    (void)frequency;
+#endif
+}
+
+uint32_t led_channel_frequency_set(LedChannel ch, uint32_t frequency, uint32_t *resolution)
+{
+    led_channel_timer_frequency_set(ch, frequency);
+
+    *resolution = led_channel_resolution_get(ch);
+
+    DBG_LOG("Channel %d PWM %d Hz, %d counts per period", ch, channels[ch].frequency, *resolution);
+
+    return channels[ch].frequency;
+}
+
+uint32_t led_channel_frequency_get(LedChannel ch)
+{
+    return channels[ch].frequency;
+}
+
+uint32_t led_channel_resolution_get(LedChannel ch)
+{
+#if LED_CHANNEL_HIGH_RES
+    /* TOP of frequency change is latched on the next overflow, TIMER still
+     * returns the old one until then */
+    if (led_channel_is_timer(ch))
+    {
+        return channels[ch].resolution;
+    }
+#endif
+
+    return channels_backend[ch]->top_get(&channels[ch]) + 1;
+}
+
+uint32_t led_channel_duty_get(LedChannel ch)
+{
+    const LedChannelOutput *o = &outputs[ch];
+    int32_t compare_q8;
+
+    if (o->period == 0)
+    {
+        return 0;
+    }
+
+    if (o->dma_driven)
+    {
+        /* output is driven externally, level it was started from is used */
+        compare_q8 = led_channel_compare_q8_get(ch, o->level_q8);
+    }
+    else
+    {
+        compare_q8 = (int32_t)o->compare << 8;
+#if LED_CHANNEL_DITHER
+        compare_q8 += o->dither_frac;
+#endif
+    }
+
+    int32_t period_q8 = (int32_t)o->period << 8;
+    int32_t on_q8 = o->right_aligned ? period_q8 - compare_q8 : compare_q8;
+
+    if (on_q8 <= 0)
+    {
+        return 0;
+    }
+
+    if (on_q8 >= period_q8)
+    {
+        return LED_CHANNEL_DUTY_ONE;
+    }
+
+    return (uint32_t)(((uint64_t)on_q8 * LED_CHANNEL_DUTY_ONE) / (uint32_t)period_q8);
+}
+
+void led_channel_curve_update(LedChannel ch)
+{
+#if APP_DMA_TRANSITIONS
+    if (led_fade_is_active(ch))
+    {
+        outputs[ch].level_q8 = led_fade_stop(ch) << 8;
+    }
+#endif
+
+    led_channel_lut_build(ch, channels_backend[ch]->top_get(&channels[ch]));
+
+    if (led_channel_is_timer(ch) == false || sl_pwm_led_is_started(&channels[ch]))
+    {
+        int32_t compare_q8 = led_channel_compare_q8_get(ch, outputs[ch].level_q8);
+
+        led_channel_output_set(ch, (uint16_t)(compare_q8 >> 8));
+#if LED_CHANNEL_DITHER
+        led_channel_dither_set(ch, (uint8_t)compare_q8);
+#endif
+    }
+    else
+    {
+        outputs[ch].compare = (uint16_t)(led_channel_compare_q8_get(ch, outputs[ch].level_q8) >> 8);
+    }
 }
@@ -20,14 +20,25 @@
 #define LED_CHANNEL_H_
 
 #include <stdint.h>
+#include "sl_pwm_led.h"
+#include "app.h"
 
+/* share of level output given to led_channel_level_mix_stage() as whole */
+#define LED_CHANNEL_MIX_ONE     0x8000
+
+/* duty cycle returned by led_channel_duty_get() for constantly driven output */
+#define LED_CHANNEL_DUTY_ONE    0x10000
+
+#define LED_CHANNEL_ENUM(name, ...)     LedChannel_##name,
+
+/* endpoint channels from APP_CHANNEL_TABLE, APP_CHANNEL_EXT_TABLE and
+ * APP_CHANNEL_PIXEL_TABLE, then AUX */
 typedef enum
 {
-    LedChannel_CH1,
-    LedChannel_CH2,
-    LedChannel_CH3,
-    LedChannel_CH4,
-    LedChannel_AUX,
+    APP_CHANNEL_TABLE(LED_CHANNEL_ENUM)
+    APP_CHANNEL_EXT_TABLE(LED_CHANNEL_ENUM)
+    APP_CHANNEL_PIXEL_TABLE(LED_CHANNEL_ENUM)
+    APP_CHANNEL_AUX(LED_CHANNEL_ENUM)
 
     LedChannel_MAX
 } LedChannel;
@@ -39,6 +50,158 @@ void led_channel_level_set(LedChannel ch, uint8_t level);
 
 void led_channel_zcl_level_set(LedChannel ch, uint8_t zcl_level);
 
+/**
+ * @brief
+ *  Sets levels of multiple channels at once. Compare values are written to
+ *  TIMER buffers in one critical section, so all channels change on the same
+ *  PWM period boundary (TIMERs are shifted by phase stagger offset). Outputs
+ *  of external controller are sent in one transfer.
+ *
+ * @param mask - channels to update, bit per LedChannel
+ * @param levels - levels indexed by LedChannel
+ */
+void led_channel_levels_set(uint32_t mask, const uint8_t *levels);
+
+/**
+ * @brief
+ *  Stages level of the channel. Levels staged by all callers in the same tick
+ *  are committed together with led_channel_levels_set() from event. Level set
+ *  directly on the channel drops its staged level.
+ *
+ * @param ch - PWM channel
+ * @param level - level to be committed
+ */
+void led_channel_level_stage(LedChannel ch, uint8_t level);
+
+/**
+ * @brief
+ *  Stages level with 8 fractional bits (in ex. interpolated by transition).
+ *  When dithering is enabled fraction is synthesized by alternating adjacent
+ *  compare values over PWM periods, else level is rounded. Committed as
+ *  led_channel_level_stage().
+ *
+ * @param ch - PWM channel
+ * @param level_q8 - level in Q8.8 format
+ */
+void led_channel_level_fine_stage(LedChannel ch, uint16_t level_q8);
+
+/**
+ * @brief
+ *  Stages level of the channel, which output is scaled by mix (in ex. share
+ *  of warm channel in tunable white light). Committed as led_channel_level_fine_stage().
+ *
+ * @param ch - PWM channel
+ * @param level_q8 - level in Q8.8 format
+ * @param mix_q15 - share of level output, LED_CHANNEL_MIX_ONE is whole output
+ */
+void led_channel_level_mix_stage(LedChannel ch, uint16_t level_q8, uint16_t mix_q15);
+
+/**
+ * @brief
+ *  Commits staged levels immediately instead of from event (in ex. light
+ *  restored at power-on before the first pass of the main loop).
+ */
+void led_channel_commit_flush(void);
+
+/**
+ * @brief
+ *  Returns time from boot till the first endpoint channel was lit in ms, 0
+ *  when none was lit yet.
+ */
+uint32_t led_channel_boot_to_light_get(void);
+
+/**
+ * @brief
+ *  Returns the longest dithering interrupt execution time in CPU cycles
+ *  (measured in DEBUG builds only).
+ */
+uint32_t led_channel_dither_isr_cycles_get(void);
+
+/**
+ * @brief
+ *  Returns estimated supply current in uA caused by running PWM TIMERs (TIMER
+ *  clocks and EM1 requirement). TIMER is gated while all its channels are
+ *  dark, so 0 is expected when all channels are off.
+ */
+uint32_t led_channel_idle_current_get(void);
+
 void led_channel_endpoints_enable(void);
 
+sl_led_pwm_t* led_channel_pwm_get(LedChannel ch);
+
+/**
+ * @brief
+ *  Returns level -> TIMER compare value table of the channel.
+ */
+const uint16_t* led_channel_lut_get(LedChannel ch);
+
+/**
+ * @brief
+ *  Marks channel output as modified outside of led_channel (in ex. by LDMA),
+ *  so next level set always updates TIMER compare value.
+ */
+void led_channel_output_invalidate(LedChannel ch);
+
+/**
+ * @brief
+ *  Returns true when fraction of level staged by led_channel_level_fine_stage()
+ *  is dithered on channel output, so finer steps of transition are visible.
+ */
+bool led_channel_is_dithered(LedChannel ch);
+
+/**
+ * @brief
+ *  Models PWM outputs over one CH1 TIMER period and returns highest number of
+ *  channels that are active at the same time. Used to verify phase stagger.
+ */
+uint8_t led_channel_peak_on_count_get(void);
+
+/**
+ * @brief
+ *  Rebuilds level -> compare value table of the channel after its dimming
+ *  curve was changed. Current level is kept.
+ *
+ * @param ch - PWM channel
+ */
+void led_channel_curve_update(LedChannel ch);
+
+/**
+ * @brief
+ *  Returns PWM frequency range supported by the channel TIMER.
+ *
+ * @param ch - PWM channel
+ * @param min_freq - lowest frequency in Hz (whole counter range is used)
+ * @param max_freq - highest frequency in Hz (lowest accepted resolution)
+ */
+void led_channel_frequency_range_get(LedChannel ch, uint32_t *min_freq, uint32_t *max_freq);
+
+/**
+ * @brief
+ *  Changes PWM frequency of the channel. TIMER is shared, so all channels of
+ *  the same TIMER are changed. Levels are kept, new TOP and compare values are
+ *  applied together on TIMER overflow. Higher frequency means less TIMER counts
+ *  per period, so lower dimming resolution.
+ *
+ * @param ch - PWM channel
+ * @param frequency - requested frequency in Hz, clamped to supported range
+ * @param resolution - set to counts in PWM period at the frequency set (dimming steps)
+ * @return frequency set in Hz
+ */
+uint32_t led_channel_frequency_set(LedChannel ch, uint32_t frequency, uint32_t *resolution);
+
+uint32_t led_channel_frequency_get(LedChannel ch);
+
+/**
+ * @brief
+ *  Returns number of TIMER counts in PWM period (dimming steps at current frequency).
+ */
+uint32_t led_channel_resolution_get(LedChannel ch);
+
+/**
+ * @brief
+ *  Returns duty cycle of the channel output (LED_CHANNEL_DUTY_ONE - always on),
+ *  including mix, dithered fraction and compare inversion.
+ */
+uint32_t led_channel_duty_get(LedChannel ch);
+
 #endif /* LED_CHANNEL_H_ */
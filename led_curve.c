@@ -0,0 +1,249 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "led_curve.h"
+#include "cie_table.h"
+#include "af.h"
+#include "app.h"
+#include "dbg_log.h"
+
+#include <math.h>
+#include <string.h>
+
+#define LED_CURVE_LEVEL_MAX         254
+#define LED_CURVE_GAMMA_DEFAULT     22
+
+typedef struct
+{
+    tokTypeLedCurve     cfg[APP_EP_COUNT];
+    tokTypeLedTrim      trim[APP_EP_COUNT];
+
+} LedCurveModule;
+
+static LedCurveModule led_curve;
+
+static uint16_t led_curve_custom_value_get(const tokTypeLedCurve *cfg, uint8_t level)
+{
+    int32_t x0 = 0;
+    int32_t y0 = 0;
+    int32_t x1 = LED_CURVE_LEVEL_MAX;
+    int32_t y1 = LED_CURVE_MAX;
+
+    for (size_t i = 0; i < cfg->count; i++)
+    {
+        if (cfg->points[i].level <= level)
+        {
+            x0 = cfg->points[i].level;
+            y0 = cfg->points[i].value;
+        }
+        else
+        {
+            x1 = cfg->points[i].level;
+            y1 = cfg->points[i].value;
+            break;
+        }
+    }
+
+    if (level <= x0 || x1 <= x0)
+    {
+        return (uint16_t)y0;
+    }
+
+    return (uint16_t)(y0 + ((y1 - y0) * (level - x0)) / (x1 - x0));
+}
+
+void led_curve_init(void)
+{
+    for (size_t i = 0; i < APP_EP_COUNT; i++)
+    {
+        tokTypeLedCurve *cfg = &led_curve.cfg[i];
+
+        halCommonGetIndexedToken(cfg, TOKEN_LED_CURVE, i);
+
+        if (cfg->curve >= LedCurve_MAX ||
+            cfg->count > LED_CURVE_POINTS_MAX)
+        {
+            DBG_LOG("Invalid curve %d for channel %d, CIE used", cfg->curve, i);
+            memset(cfg, 0, sizeof(*cfg));
+            cfg->curve = LedCurve_CIE;
+        }
+
+        tokTypeLedTrim *trim = &led_curve.trim[i];
+
+        halCommonGetIndexedToken(trim, TOKEN_LED_TRIM, i);
+
+        if (trim->min >= trim->max)
+        {
+            DBG_LOG("Invalid trim %d - %d for channel %d, ignored", trim->min, trim->max, i);
+            trim->min = 0;
+            trim->max = LED_CURVE_MAX;
+        }
+    }
+}
+
+static uint16_t led_curve_raw_value_get(LedChannel ch, uint8_t level)
+{
+    if (level > LED_CURVE_LEVEL_MAX)
+    {
+        return LED_CURVE_MAX;
+    }
+
+    if (ch >= APP_EP_COUNT)
+    {
+        return cie_table[level];
+    }
+
+    const tokTypeLedCurve *cfg = &led_curve.cfg[ch];
+    uint32_t value = 0;
+
+    switch (cfg->curve)
+    {
+        default:
+        case LedCurve_CIE:
+        {
+            return cie_table[level];
+        }
+        case LedCurve_LINEAR:
+        {
+            value = (level * LED_CURVE_MAX + LED_CURVE_LEVEL_MAX / 2) / LED_CURVE_LEVEL_MAX;
+            break;
+        }
+        case LedCurve_GAMMA:
+        {
+            float gamma = (cfg->param != 0 ? cfg->param : LED_CURVE_GAMMA_DEFAULT) / 10.0f;
+
+            value = (uint32_t)(powf((float)level / LED_CURVE_LEVEL_MAX, gamma) * LED_CURVE_MAX + 0.5f);
+            break;
+        }
+        case LedCurve_LOG:
+        {
+            /* 3 decades over levels 1 - 254, as DALI */
+            float exp = ((level - 1) * 3.0f) / (LED_CURVE_LEVEL_MAX - 1) - 3.0f;
+
+            value = (uint32_t)(powf(10.0f, exp) * LED_CURVE_MAX + 0.5f);
+            break;
+        }
+        case LedCurve_CUSTOM:
+        {
+            return led_curve_custom_value_get(cfg, level);
+        }
+    }
+
+    /* level above 0 is never completely off */
+    return value == 0 ? 1 : (uint16_t)value;
+}
+
+uint16_t led_curve_value_get(LedChannel ch, uint8_t level)
+{
+    if (level == 0)
+    {
+        return 0;
+    }
+
+    uint32_t value = led_curve_raw_value_get(ch, level);
+
+    if (ch < APP_EP_COUNT)
+    {
+        /* whole curve is squeezed into visible output range of the strip */
+        const tokTypeLedTrim *trim = &led_curve.trim[ch];
+
+        value = trim->min + (value * (trim->max - trim->min) + LED_CURVE_MAX / 2) / LED_CURVE_MAX;
+    }
+
+    return (uint16_t)value;
+}
+
+bool led_curve_set(LedChannel ch, LedCurve curve, uint8_t param)
+{
+    if (ch >= APP_EP_COUNT || curve >= LedCurve_MAX)
+    {
+        return false;
+    }
+
+    tokTypeLedCurve *cfg = &led_curve.cfg[ch];
+
+    if (curve == LedCurve_CUSTOM && cfg->count == 0)
+    {
+        /* no points were uploaded yet */
+        return false;
+    }
+
+    cfg->curve = curve;
+    cfg->param = param;
+
+    halCommonSetIndexedToken(TOKEN_LED_CURVE, ch, cfg);
+
+    DBG_LOG("Channel %d curve %d, param %d", ch, curve, param);
+
+    return true;
+}
+
+bool led_curve_custom_set(LedChannel ch, const uint8_t *levels, const uint16_t *values, uint8_t count)
+{
+    if (ch >= APP_EP_COUNT || count == 0 || count > LED_CURVE_POINTS_MAX)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (levels[i] == 0 || levels[i] > LED_CURVE_LEVEL_MAX ||
+            (i > 0 && levels[i] <= levels[i - 1]))
+        {
+            return false;
+        }
+    }
+
+    tokTypeLedCurve *cfg = &led_curve.cfg[ch];
+
+    memset(cfg->points, 0, sizeof(cfg->points));
+    for (size_t i = 0; i < count; i++)
+    {
+        cfg->points[i].level = levels[i];
+        cfg->points[i].value = values[i];
+    }
+
+    cfg->curve = LedCurve_CUSTOM;
+    cfg->param = 0;
+    cfg->count = count;
+
+    halCommonSetIndexedToken(TOKEN_LED_CURVE, ch, cfg);
+
+    DBG_LOG("Channel %d custom curve, %d points", ch, count);
+
+    return true;
+}
+
+bool led_curve_trim_set(LedChannel ch, uint16_t min, uint16_t max)
+{
+    if (ch >= APP_EP_COUNT || min >= max)
+    {
+        return false;
+    }
+
+    tokTypeLedTrim *trim = &led_curve.trim[ch];
+
+    trim->min = min;
+    trim->max = max;
+
+    halCommonSetIndexedToken(TOKEN_LED_TRIM, ch, trim);
+
+    DBG_LOG("Channel %d trim %d - %d", ch, min, max);
+
+    return true;
+}
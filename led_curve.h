@@ -0,0 +1,94 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_CURVE_H_
+#define LED_CURVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_channel.h"
+
+/* full scale of curve output */
+#define LED_CURVE_MAX       65535
+
+typedef enum
+{
+    LedCurve_CIE,           /* CIE 1931 lightness */
+    LedCurve_LINEAR,
+    LedCurve_GAMMA,         /* parameter is gamma * 10 */
+    LedCurve_LOG,           /* DALI logarithmic, 0.1% - 100% */
+    LedCurve_CUSTOM,        /* sparse points uploaded by user */
+
+    LedCurve_MAX
+} LedCurve;
+
+/**
+ * @brief
+ *  Loads curve configuration of all channels from NVM3.
+ */
+void led_curve_init(void);
+
+/**
+ * @brief
+ *  Returns relative output of the channel for the level, with output trim
+ *  applied. Used only when level -> compare value table of the channel is built.
+ *
+ * @param ch - PWM channel
+ * @param level - level 0 - 255 (255 is always full scale)
+ * @return output 0 - LED_CURVE_MAX
+ */
+uint16_t led_curve_value_get(LedChannel ch, uint8_t level);
+
+/**
+ * @brief
+ *  Selects and stores dimming curve of the channel.
+ *
+ * @param ch - PWM channel (AUX not supported)
+ * @param curve - curve type
+ * @param param - curve parameter (gamma * 10 for LedCurve_GAMMA, 0 selects 2.2)
+ * @return true when curve is valid
+ */
+bool led_curve_set(LedChannel ch, LedCurve curve, uint8_t param);
+
+/**
+ * @brief
+ *  Stores custom curve of the channel and selects it. Output between points is
+ *  linearly interpolated, level 0 is always off and level 254 defaults to full
+ *  scale when not given.
+ *
+ * @param ch - PWM channel (AUX not supported)
+ * @param levels - point levels, strictly increasing, 1 - 254
+ * @param values - point outputs 0 - LED_CURVE_MAX
+ * @param count - number of points, up to LED_CURVE_POINTS_MAX
+ * @return true when points are valid
+ */
+bool led_curve_custom_set(LedChannel ch, const uint8_t *levels, const uint16_t *values, uint8_t count);
+
+/**
+ * @brief
+ *  Stores output trim of the channel. Levels 1 - 254 are mapped between
+ *  minimum and maximum duty, level 0 stays off.
+ *
+ * @param ch - PWM channel (AUX not supported)
+ * @param min - duty of the lowest level, where the strip starts to light (0 - LED_CURVE_MAX)
+ * @param max - duty of the highest level, where the strip clips (0 - LED_CURVE_MAX)
+ * @return true when trim is valid
+ */
+bool led_curve_trim_set(LedChannel ch, uint16_t min, uint16_t max);
+
+#endif /* LED_CURVE_H_ */
@@ -0,0 +1,149 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "led_ease.h"
+#include "ease_table.h"
+#include "af.h"
+#include "app.h"
+#include "dbg_log.h"
+
+#define LED_EASE_SEGMENT_BITS   (16 - EASE_TABLE_BITS)
+#define LED_EASE_SEGMENT_MASK   ((1UL << LED_EASE_SEGMENT_BITS) - 1)
+
+typedef struct
+{
+    uint8_t     ease[APP_EP_COUNT];
+
+} LedEaseModule;
+
+static LedEaseModule led_ease;
+
+void led_ease_init(void)
+{
+    for (size_t i = 0; i < APP_EP_COUNT; i++)
+    {
+        halCommonGetIndexedToken(&led_ease.ease[i], TOKEN_LED_EASE, i);
+
+        if (led_ease.ease[i] >= LedEase_MAX)
+        {
+            DBG_LOG("Invalid easing %d for ep %d, linear used", led_ease.ease[i], i + 1);
+            led_ease.ease[i] = LedEase_LINEAR;
+        }
+    }
+}
+
+LedEase led_ease_get(uint8_t ep_id)
+{
+    if (ep_id < 1 || ep_id > APP_EP_COUNT)
+    {
+        return LedEase_LINEAR;
+    }
+
+    return (LedEase)led_ease.ease[ep_id - 1];
+}
+
+bool led_ease_set(uint8_t ep_id, LedEase ease)
+{
+    if (ep_id < 1 || ep_id > APP_EP_COUNT || ease >= LedEase_MAX)
+    {
+        return false;
+    }
+
+    if (led_ease.ease[ep_id - 1] != ease)
+    {
+        led_ease.ease[ep_id - 1] = (uint8_t)ease;
+        halCommonSetIndexedToken(TOKEN_LED_EASE, ep_id - 1, &led_ease.ease[ep_id - 1]);
+    }
+
+    return true;
+}
+
+uint32_t led_ease_apply(LedEase ease, uint32_t progress)
+{
+    if (ease == LedEase_LINEAR || ease >= LedEase_COUNT)
+    {
+        return progress;
+    }
+
+    if (progress >= LED_EASE_ONE)
+    {
+        return LED_EASE_ONE;
+    }
+
+    const uint32_t *table = ease_table[ease - 1];
+    uint32_t idx = progress >> LED_EASE_SEGMENT_BITS;
+    uint32_t frac = progress & LED_EASE_SEGMENT_MASK;
+
+    return table[idx] + (((table[idx + 1] - table[idx]) * frac) >> LED_EASE_SEGMENT_BITS);
+}
+
+uint32_t led_ease_slope_get(LedEase ease, uint32_t progress)
+{
+    if (ease == LedEase_LINEAR || ease >= LedEase_COUNT)
+    {
+        return LED_EASE_ONE;
+    }
+
+    const uint32_t *table = ease_table[ease - 1];
+    uint32_t idx = progress >> LED_EASE_SEGMENT_BITS;
+
+    if (idx >= EASE_TABLE_POINTS - 1)
+    {
+        idx = EASE_TABLE_POINTS - 2;
+    }
+
+    return (table[idx + 1] - table[idx]) << EASE_TABLE_BITS;
+}
+
+uint32_t led_ease_progress_get(LedEase ease, uint32_t value)
+{
+    if (ease == LedEase_LINEAR || ease >= LedEase_COUNT)
+    {
+        return value;
+    }
+
+    if (value >= LED_EASE_ONE)
+    {
+        return LED_EASE_ONE;
+    }
+
+    const uint32_t *table = ease_table[ease - 1];
+    uint32_t lo = 0;
+    uint32_t hi = EASE_TABLE_POINTS - 1;
+
+    /* the last point with value not above the given one, table is increasing */
+    while (hi - lo > 1)
+    {
+        uint32_t mid = (lo + hi) / 2;
+
+        if (table[mid] <= value)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    uint32_t span = table[hi] - table[lo];
+    uint32_t frac = span == 0 ? 0 :
+                    (((value - table[lo]) << LED_EASE_SEGMENT_BITS) + span - 1) / span;
+
+    return (lo << LED_EASE_SEGMENT_BITS) + frac;
+}
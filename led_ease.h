@@ -0,0 +1,103 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_EASE_H_
+#define LED_EASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* full scale of transition progress and eased value */
+#define LED_EASE_ONE        (1UL << 16)
+
+typedef enum
+{
+    LedEase_LINEAR,
+    LedEase_QUADRATIC,      /* ease-in-out, quadratic */
+    LedEase_CUBIC,          /* ease-in-out, cubic S-curve */
+    LedEase_EXPONENTIAL,    /* ease-in-out, exponential */
+
+    LedEase_MAX,
+
+    /* not selectable, used by retargeted transition to continue velocity of
+     * the previous one, starts at double of the average velocity */
+    LedEase_QUADRATIC_OUT = LedEase_MAX,
+
+    LedEase_COUNT
+} LedEase;
+
+/**
+ * @brief
+ *  Loads easing of level transitions of all endpoints from NVM3.
+ */
+void led_ease_init(void);
+
+/**
+ * @brief
+ *  Returns easing selected for level transitions of the endpoint.
+ *
+ * @param ep_id - endpoint 1 - APP_EP_COUNT
+ * @return easing, LedEase_LINEAR for invalid endpoint
+ */
+LedEase led_ease_get(uint8_t ep_id);
+
+/**
+ * @brief
+ *  Selects and stores easing of level transitions of the endpoint. Applied
+ *  from the next transition.
+ *
+ * @param ep_id - endpoint 1 - APP_EP_COUNT
+ * @param ease - easing
+ * @return true when easing is valid
+ */
+bool led_ease_set(uint8_t ep_id, LedEase ease);
+
+/**
+ * @brief
+ *  Returns eased value of transition progress, linearly interpolated
+ *  between points of precomputed table.
+ *
+ * @param ease - easing
+ * @param progress - transition progress 0 - LED_EASE_ONE
+ * @return eased value 0 - LED_EASE_ONE
+ */
+uint32_t led_ease_apply(LedEase ease, uint32_t progress);
+
+/**
+ * @brief
+ *  Returns slope of easing curve at the transition progress, eased value
+ *  change per progress change.
+ *
+ * @param ease - easing
+ * @param progress - transition progress 0 - LED_EASE_ONE
+ * @return slope, LED_EASE_ONE is slope of linear transition
+ */
+uint32_t led_ease_slope_get(LedEase ease, uint32_t progress);
+
+/**
+ * @brief
+ *  Returns transition progress for eased value (inverse of led_ease_apply()),
+ *  rounded up, used to find when the transition reaches the given level.
+ *
+ * @param ease - easing
+ * @param value - eased value 0 - LED_EASE_ONE
+ * @return transition progress 0 - LED_EASE_ONE
+ */
+uint32_t led_ease_progress_get(LedEase ease, uint32_t value);
+
+#endif /* LED_EASE_H_ */
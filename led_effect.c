@@ -19,6 +19,11 @@
 #include "led_effect.h"
 #include "dbg_log.h"
 #include "app.h"
+#include "led_light.h"
+#include "led_sched.h"
+#if APP_AUX_LETIMER
+#include "led_aux.h"
+#endif
 
 #include "zigbee_app_framework_event.h"
 
@@ -94,7 +99,9 @@ typedef struct
     LedEffect           infinite_effect;
     LedEffect           iterative_effect;
     size_t              iterate_count;
-    sl_zigbee_event_t   led_effect_tick_event;
+#if APP_AUX_LETIMER
+    bool                blinking;       /* effect is played by LETIMER */
+#endif
 
 } LedEffectExecCtx;
 
@@ -286,12 +293,69 @@ static const LedEffectInstruction* led_effects[] =
 
 static LedEffectCtx led_effect_ctx;
 
+#if APP_AUX_LETIMER
+/**
+ * @brief
+ *  Plays effect on AUX by LETIMER when it is a plain blink (level, delay,
+ *  level 0, delay) at full duty. LETIMER can't dim while it blinks, so dimmed
+ *  blinks and pulses (ramps) are played by the tick event. Tick event is then
+ *  used only to end the iterations, so CPU is not woken up during the effect.
+ *
+ * @return true when effect is played by LETIMER
+ */
+static bool led_effect_aux_blink_start(LedEffectExecCtx *ctx)
+{
+    const LedEffectInstruction *i = ctx->code;
+    const uint16_t *lut = led_channel_lut_get(LedChannel_AUX);
+
+    if (i[0].code != LED_EFFECT_INST_LEVEL || i[0].params.level.level == 0 ||
+        i[1].code != LED_EFFECT_INST_DELAY ||
+        i[2].code != LED_EFFECT_INST_LEVEL || i[2].params.level.level != 0 ||
+        i[3].code != LED_EFFECT_INST_DELAY ||
+        i[4].code != LED_EFFECT_INST_END)
+    {
+        return false;
+    }
+
+    /* level below full duty would be played brighter */
+    if (lut[i[0].params.level.level] < led_channel_resolution_get(LedChannel_AUX))
+    {
+        return false;
+    }
+
+    uint32_t on_ms = LED_EFFECT_TICKS_TO_MSEC(i[1].params.delay.ticks);
+    uint32_t off_ms = LED_EFFECT_TICKS_TO_MSEC(i[3].params.delay.ticks);
+
+    if (led_aux_blink_start(on_ms, off_ms) == false)
+    {
+        return false;
+    }
+
+    ctx->blinking = true;
+
+    if (ctx->iterate_count > 0)
+    {
+        led_sched_set_delay_ms(LedSchedClient_EFFECT, LedChannel_AUX, ctx->iterate_count * (on_ms + off_ms));
+    }
+
+    return true;
+}
+#endif
+
 static void led_effect_start(LedChannel ch, LedEffect effect)
 {
     LedEffectExecCtx *ctx = &led_effect_ctx.execution_ctx[ch];
 
     ctx->code = led_effects[effect];
-    sl_zigbee_event_set_active(&ctx->led_effect_tick_event);
+
+#if APP_AUX_LETIMER
+    if (ch == LedChannel_AUX && led_effect_aux_blink_start(ctx))
+    {
+        return;
+    }
+#endif
+
+    led_sched_set_active(LedSchedClient_EFFECT, ch);
 }
 
 static void led_effect_next_instr(LedEffectExecCtx *ctx)
@@ -307,26 +371,35 @@ static inline int32_t line_approx(int32_t start, int32_t stop, int32_t time, int
     return (((stop - start) * t + (start * time)) / time + 50) / 100;
 }
 
-static void led_effect_tick_event_cb(sl_zigbee_event_t *event)
+static void led_effect_tick_event_cb(uint8_t index)
 {
     uint32_t delay = 0;
+    LedChannel ch = (LedChannel)index;
 
-    LedEffectExecCtx *ctx = NULL;
-    LedChannel ch = 0;
-    for (; ch < ARRAY_SIZE(led_effect_ctx.execution_ctx); ch++)
+    if (ch >= ARRAY_SIZE(led_effect_ctx.execution_ctx))
     {
-        if (&led_effect_ctx.execution_ctx[ch].led_effect_tick_event == event)
-        {
-            ctx = &led_effect_ctx.execution_ctx[ch];
-            break;
-        }
+        DBG_LOG("Unexpected LED effect event call!");
+        return;
     }
 
-    if (ctx == NULL)
+    LedEffectExecCtx *ctx = &led_effect_ctx.execution_ctx[ch];
+
+#if APP_AUX_LETIMER
+    if (ctx->blinking)
     {
-        DBG_LOG("Unexpected LED effect event call!");
+        /* all iterations were played by LETIMER */
+        ctx->blinking = false;
+        ctx->code = NULL;
+        ctx->iterate_count = 0;
+        led_channel_level_set(ch, 0);
+
+        if (ctx->infinite_effect != LedEffect_None)
+        {
+            led_effect_start(ch, ctx->infinite_effect);
+        }
         return;
     }
+#endif
 
     while (ctx->code != NULL)
     {
@@ -345,7 +418,7 @@ static void led_effect_tick_event_cb(sl_zigbee_event_t *event)
         }
         else if (i->code == LED_EFFECT_INST_LEVEL)
         {
-            led_channel_level_set(ch, i->params.level.level);
+            led_channel_level_stage(ch, i->params.level.level);
             led_effect_next_instr(ctx);
         }
         else if (i->code == LED_EFFECT_INST_RAMP)
@@ -372,7 +445,7 @@ static void led_effect_tick_event_cb(sl_zigbee_event_t *event)
                 }
             }
 
-            led_channel_level_set(ch, level);
+            led_channel_level_stage(ch, level);
         }
         else
         {
@@ -388,7 +461,7 @@ static void led_effect_tick_event_cb(sl_zigbee_event_t *event)
 
     if (delay != 0)
     {
-        sl_zigbee_event_set_delay_ms(&ctx->led_effect_tick_event, delay);
+        led_sched_set_delay_ms(LedSchedClient_EFFECT, ch, delay);
     }
     else
     {
@@ -410,11 +483,7 @@ static void led_effect_tick_event_cb(sl_zigbee_event_t *event)
 
 void led_effect_init(void)
 {
-    for (size_t i = 0; i < ARRAY_SIZE(led_effect_ctx.execution_ctx); i++)
-    {
-        sl_zigbee_event_init(&led_effect_ctx.execution_ctx[i].led_effect_tick_event,
-                               led_effect_tick_event_cb);
-    }
+    led_sched_register(LedSchedClient_EFFECT, led_effect_tick_event_cb);
 
     led_effect_ctx.initialized = true;
 }
@@ -435,7 +504,11 @@ void led_effect_run(LedChannel ch, LedEffect effect, size_t count)
       return;
     }
 
-    sl_zigbee_event_set_inactive(&ctx->led_effect_tick_event);
+    led_sched_set_inactive(LedSchedClient_EFFECT, ch);
+#if APP_AUX_LETIMER
+    /* LETIMER blink is stopped by the next AUX level set */
+    ctx->blinking = false;
+#endif
 
     if (effect == LedEffect_None)
     {
@@ -459,7 +532,15 @@ void led_effect_run(LedChannel ch, LedEffect effect, size_t count)
                                            ZCL_CURRENT_LEVEL_ATTRIBUTE_ID,
                                            &current_level, sizeof(current_level));
 
-                led_channel_zcl_level_set(ch, current_level);
+                if (led_light_is_mixed(ch + 1))
+                {
+                    /* restores all channels of the light, not only effect one */
+                    led_light_level_stage(ch + 1, current_level);
+                }
+                else
+                {
+                    led_channel_zcl_level_set(ch, current_level);
+                }
             }
             else
             {
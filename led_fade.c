@@ -0,0 +1,295 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app.h"
+
+#if APP_DMA_TRANSITIONS
+
+#include "led_fade.h"
+#include "led_channel.h"
+#include "dbg_log.h"
+
+#include "dmadrv.h"
+#include "em_core.h"
+#include "zigbee_app_framework_event.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* compare values per ping-pong buffer, one value is consumed every PWM period */
+#define LED_FADE_BUF_LEN        256
+
+#define LED_FADE_Q16_ONE        (1UL << 16)
+
+typedef struct
+{
+    unsigned int    dma_ch;
+    bool            active;
+    uint32_t        periods;        /* fade length in PWM periods */
+    uint32_t        rendered;       /* periods rendered into buffers */
+    uint32_t        sequence;       /* buffers consumed by LDMA */
+    int32_t         level_q16;      /* last rendered level */
+    int32_t         step_q16;       /* level change per PWM period */
+    uint32_t        rem_q16;        /* remainder of step, spread over the fade */
+    uint32_t        err;
+    int32_t         start_q16;
+    int32_t         end_q16;
+    LedFadeDoneCb   done_cb;
+    uint16_t        buf[2][LED_FADE_BUF_LEN];
+
+} LedFadeCtx;
+
+typedef struct
+{
+    LedFadeCtx          fade[APP_TIMER_CHANNEL_COUNT];     /* external outputs are not streamed */
+    volatile uint32_t   done_mask;
+    sl_zigbee_event_t   done_event;
+    bool                initialized;
+
+} LedFadeModule;
+
+static LedFadeModule led_fade;
+
+#define LED_FADE_TIMER_SIGNAL(num, phase)                   \
+    if (timer == TIMER##num)                                \
+    {                                                       \
+        return dmadrvPeripheralSignal_TIMER##num##_UFOF;    \
+    }
+
+static DMADRV_PeripheralSignal_t led_fade_signal_get(TIMER_TypeDef *timer)
+{
+    APP_TIMER_TABLE(LED_FADE_TIMER_SIGNAL)
+
+    return dmadrvPeripheralSignal_TIMER1_UFOF;
+}
+
+/**
+ * @brief
+ *  Renders next part of the fade. Levels between ZCL steps are interpolated
+ *  on the level -> compare table, so every PWM period gets own duty value.
+ */
+static void led_fade_render(LedChannel ch, uint16_t *buf)
+{
+    LedFadeCtx *f = &led_fade.fade[ch];
+    const uint16_t *lut = led_channel_lut_get(ch);
+
+    for (size_t i = 0; i < LED_FADE_BUF_LEN; i++)
+    {
+        if (f->rendered < f->periods)
+        {
+            f->rendered++;
+            f->level_q16 += f->step_q16;
+
+            f->err += f->rem_q16;
+            if (f->err >= f->periods)
+            {
+                f->err -= f->periods;
+                f->level_q16 += (f->end_q16 > f->start_q16) ? 1 : -1;
+            }
+        }
+
+        if (f->rendered >= f->periods)
+        {
+            f->level_q16 = f->end_q16;
+        }
+
+        uint32_t idx = (uint32_t)f->level_q16 >> 16;
+        int32_t frac = f->level_q16 & (LED_FADE_Q16_ONE - 1);
+        int32_t lo = lut[idx];
+        int32_t hi = lut[idx + 1];
+
+        buf[i] = (uint16_t)(lo + (((hi - lo) * frac) >> 16));
+    }
+}
+
+/* called from LDMA interrupt when one of ping-pong buffers was consumed */
+static bool led_fade_dma_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+    LedChannel ch = (LedChannel)(uintptr_t)userParam;
+    LedFadeCtx *f = &led_fade.fade[ch];
+
+    if (f->active == false)
+    {
+        return false;
+    }
+
+    f->sequence = sequenceNo;
+
+    if (sequenceNo * LED_FADE_BUF_LEN >= f->periods)
+    {
+        /* last value is already latched in CC buffer */
+        f->active = false;
+        led_fade.done_mask |= (1 << ch);
+        sl_zigbee_event_set_active(&led_fade.done_event);
+        return false;
+    }
+
+    /* buffers are used alternately, so consumed one is refilled */
+    led_fade_render(ch, f->buf[(sequenceNo - 1) & 1]);
+
+    return true;
+}
+
+static void led_fade_done_event_cb(sl_zigbee_event_t *event)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_CRITICAL();
+    uint32_t mask = led_fade.done_mask;
+    led_fade.done_mask = 0;
+    CORE_EXIT_CRITICAL();
+
+    for (LedChannel ch = 0; ch < APP_TIMER_CHANNEL_COUNT; ch++)
+    {
+        if ((mask & (1 << ch)) != 0 && led_fade.fade[ch].done_cb != NULL)
+        {
+            led_fade.fade[ch].done_cb(ch);
+        }
+    }
+}
+
+void led_fade_init(void)
+{
+    if (led_fade.initialized)
+    {
+        return;
+    }
+
+    DMADRV_Init();
+
+    for (size_t i = 0; i < APP_TIMER_CHANNEL_COUNT; i++)
+    {
+        Ecode_t status = DMADRV_AllocateChannel(&led_fade.fade[i].dma_ch, NULL);
+        if (status != ECODE_EMDRV_DMADRV_OK)
+        {
+            DBG_LOG("Can't allocate DMA channel for fade %d: 0x%X", i, status);
+            return;
+        }
+    }
+
+    sl_zigbee_event_init(&led_fade.done_event, led_fade_done_event_cb);
+    led_fade.initialized = true;
+}
+
+bool led_fade_start(LedChannel ch, uint8_t from_level, uint8_t to_level,
+                    uint32_t duration_ms, LedFadeDoneCb done_cb)
+{
+    if (led_fade.initialized == false || ch >= APP_TIMER_CHANNEL_COUNT)
+    {
+        return false;
+    }
+
+    sl_led_pwm_t *led = led_channel_pwm_get(ch);
+    uint32_t periods = (duration_ms * led->frequency) / 1000;
+
+    if (periods == 0)
+    {
+        return false;
+    }
+
+    led_fade_stop(ch);
+
+    /* start level is set through led_channel, so output is routed */
+    led_channel_zcl_level_set(ch, from_level);
+    led_channel_output_invalidate(ch);
+
+    LedFadeCtx *f = &led_fade.fade[ch];
+
+    int32_t delta_q16 = ((int32_t)to_level - (int32_t)from_level) << 16;
+
+    f->periods = periods;
+    f->rendered = 0;
+    f->sequence = 0;
+    f->err = 0;
+    f->start_q16 = (int32_t)from_level << 16;
+    f->end_q16 = (int32_t)to_level << 16;
+    f->level_q16 = f->start_q16;
+    f->step_q16 = delta_q16 / (int32_t)periods;
+    f->rem_q16 = (uint32_t)(delta_q16 < 0 ? -delta_q16 : delta_q16) % periods;
+    f->done_cb = done_cb;
+
+    led_fade_render(ch, f->buf[0]);
+    led_fade_render(ch, f->buf[1]);
+
+    f->active = true;
+
+    Ecode_t status = DMADRV_MemoryPeripheralPingPong(f->dma_ch,
+                                                     led_fade_signal_get(led->timer),
+                                                     (void*)&led->timer->CC[led->channel].OCB,
+                                                     f->buf[0], f->buf[1],
+                                                     true,
+                                                     LED_FADE_BUF_LEN,
+                                                     dmadrvDataSize2,
+                                                     led_fade_dma_cb,
+                                                     (void*)(uintptr_t)ch);
+    if (status != ECODE_EMDRV_DMADRV_OK)
+    {
+        DBG_LOG("Can't start DMA fade on channel %d: 0x%X", ch, status);
+        f->active = false;
+        return false;
+    }
+
+    DBG_LOG("DMA fade ch %d: %d -> %d in %d periods", ch, from_level, to_level, periods);
+
+    return true;
+}
+
+uint8_t led_fade_stop(LedChannel ch)
+{
+    if (ch >= APP_TIMER_CHANNEL_COUNT)
+    {
+        return 0;
+    }
+
+    LedFadeCtx *f = &led_fade.fade[ch];
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_CRITICAL();
+    bool active = f->active;
+    f->active = false;
+    led_fade.done_mask &= ~(1 << ch);
+    CORE_EXIT_CRITICAL();
+
+    if (active == false)
+    {
+        return (uint8_t)(f->end_q16 >> 16);
+    }
+
+    int remaining = 0;
+
+    DMADRV_StopTransfer(f->dma_ch);
+    DMADRV_TransferRemainingCount(f->dma_ch, &remaining);
+
+    uint32_t consumed = f->sequence * LED_FADE_BUF_LEN + (LED_FADE_BUF_LEN - (uint32_t)remaining);
+
+    if (consumed > f->periods)
+    {
+        consumed = f->periods;
+    }
+
+    int32_t level_q16 = f->start_q16 + (int32_t)(((int64_t)(f->end_q16 - f->start_q16) * consumed) / f->periods);
+
+    return (uint8_t)((level_q16 + (LED_FADE_Q16_ONE / 2)) >> 16);
+}
+
+bool led_fade_is_active(LedChannel ch)
+{
+    return ch < APP_TIMER_CHANNEL_COUNT && led_fade.fade[ch].active;
+}
+
+#endif /* APP_DMA_TRANSITIONS */
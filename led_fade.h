@@ -0,0 +1,56 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_FADE_H_
+#define LED_FADE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_channel.h"
+
+typedef void (*LedFadeDoneCb)(LedChannel ch);
+
+void led_fade_init(void);
+
+/**
+ * @brief
+ *  Starts level fade rendered into compare value buffer and streamed into TIMER
+ *  CC buffer by LDMA on every TIMER overflow (one value per PWM period).
+ *
+ * @param ch - PWM channel to fade (AUX and external outputs not supported)
+ * @param from_level - start level
+ * @param to_level - target level
+ * @param duration_ms - fade duration
+ * @param done_cb - called from application context when fade is finished
+ * @return true when fade was started
+ */
+bool led_fade_start(LedChannel ch, uint8_t from_level, uint8_t to_level,
+                    uint32_t duration_ms, LedFadeDoneCb done_cb);
+
+/**
+ * @brief
+ *  Stops fade in progress. Output is left on the last streamed value.
+ *
+ * @param ch - PWM channel
+ * @return level reached by the fade
+ */
+uint8_t led_fade_stop(LedChannel ch);
+
+bool led_fade_is_active(LedChannel ch);
+
+#endif /* LED_FADE_H_ */
@@ -0,0 +1,285 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "led_light.h"
+#include "app.h"
+#include "dbg_log.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LED_LIGHT_RGBW_COUNT    4
+#define LED_LIGHT_CAL_SHIFT     14
+#define LED_LIGHT_XYZ_SHIFT     12
+
+typedef struct
+{
+    uint16_t    level_q8;                       /* last staged level of mixed light, Q8.8 */
+    uint16_t    mireds;                         /* color temperature of tunable white light */
+    uint16_t    mixes[LED_LIGHT_RGBW_COUNT];    /* shares of CH1 - CH4 outputs of RGBW light */
+
+} LedLightCtx;
+
+static LedLightCtx led_light;
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE
+/**
+ * @brief
+ *  Mixing kernel of tunable white light. Share of warm channel changes
+ *  linearly in mireds, sum of both shares is constant, so light output
+ *  doesn't depend on color temperature.
+ *
+ * @param mireds - color temperature
+ * @return share of warm channel in Q15
+ */
+static uint16_t led_light_warm_mix_get(uint16_t mireds)
+{
+    if (mireds <= APP_TW_COOL_MIREDS)
+    {
+        return 0;
+    }
+
+    if (mireds >= APP_TW_WARM_MIREDS)
+    {
+        return LED_CHANNEL_MIX_ONE;
+    }
+
+    return (uint16_t)(((uint32_t)(mireds - APP_TW_COOL_MIREDS) * LED_CHANNEL_MIX_ONE +
+                       (APP_TW_WARM_MIREDS - APP_TW_COOL_MIREDS) / 2) /
+                      (APP_TW_WARM_MIREDS - APP_TW_COOL_MIREDS));
+}
+#endif
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+static const int16_t led_light_rgbw_cal[LED_LIGHT_RGBW_COUNT][LED_LIGHT_RGBW_COUNT] = APP_RGBW_CALIBRATION;
+
+/* CIE XYZ -> linear sRGB (D65 white point), LED_LIGHT_XYZ_SHIFT fractional bits */
+static const int16_t led_light_xyz_to_rgb[3][3] =
+{
+    {  13273,  -6296,  -2042 },
+    {  -3969,   7683,    170 },
+    {    228,   -836,   4329 },
+};
+
+/**
+ * @brief
+ *  Converts ZCL hue and saturation to RGB, the strongest component is
+ *  LED_CHANNEL_MIX_ONE.
+ */
+static void led_light_hs_to_rgb(uint8_t hue, uint8_t saturation, int32_t *rgb)
+{
+    /* hue 0 - 254 is 0 - 360 deg, split into 6 sectors of LED_CHANNEL_MIX_ONE */
+    int32_t h = ((int32_t)hue * 6 * LED_CHANNEL_MIX_ONE) / 255;
+    int32_t f = h % LED_CHANNEL_MIX_ONE;
+    int32_t s = saturation >= 254 ? LED_CHANNEL_MIX_ONE : ((int32_t)saturation * LED_CHANNEL_MIX_ONE) / 254;
+    int32_t p = LED_CHANNEL_MIX_ONE - s;
+    int32_t q = LED_CHANNEL_MIX_ONE - ((s * f) >> 15);
+    int32_t t = LED_CHANNEL_MIX_ONE - ((s * (LED_CHANNEL_MIX_ONE - f)) >> 15);
+
+    switch (h / LED_CHANNEL_MIX_ONE)
+    {
+        case 0:  rgb[0] = LED_CHANNEL_MIX_ONE; rgb[1] = t; rgb[2] = p; break;
+        case 1:  rgb[0] = q; rgb[1] = LED_CHANNEL_MIX_ONE; rgb[2] = p; break;
+        case 2:  rgb[0] = p; rgb[1] = LED_CHANNEL_MIX_ONE; rgb[2] = t; break;
+        case 3:  rgb[0] = p; rgb[1] = q; rgb[2] = LED_CHANNEL_MIX_ONE; break;
+        case 4:  rgb[0] = t; rgb[1] = p; rgb[2] = LED_CHANNEL_MIX_ONE; break;
+        default: rgb[0] = LED_CHANNEL_MIX_ONE; rgb[1] = p; rgb[2] = q; break;
+    }
+}
+
+/**
+ * @brief
+ *  Converts ZCL x, y chromaticity to linear RGB, the strongest component is
+ *  LED_CHANNEL_MIX_ONE. Colors out of sRGB gamut are clipped.
+ */
+static void led_light_xy_to_rgb(uint16_t x, uint16_t y, int32_t *rgb)
+{
+    int32_t xyz[3];
+    int32_t max = 0;
+
+    if (y == 0)
+    {
+        rgb[0] = rgb[1] = rgb[2] = LED_CHANNEL_MIX_ONE;
+        return;
+    }
+
+    /* XYZ of the color with luminance Y = 1 */
+    int32_t z = 0x10000 - (int32_t)x - (int32_t)y;
+
+    xyz[0] = ((int32_t)x << LED_LIGHT_XYZ_SHIFT) / y;
+    xyz[1] = 1 << LED_LIGHT_XYZ_SHIFT;
+    xyz[2] = z > 0 ? (z << LED_LIGHT_XYZ_SHIFT) / y : 0;
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        int64_t acc = 0;
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            acc += (int64_t)led_light_xyz_to_rgb[i][j] * xyz[j];
+        }
+
+        rgb[i] = acc > 0 ? (int32_t)(acc >> LED_LIGHT_XYZ_SHIFT) : 0;
+        max = rgb[i] > max ? rgb[i] : max;
+    }
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        rgb[i] = max > 0 ? (int32_t)(((int64_t)rgb[i] * LED_CHANNEL_MIX_ONE) / max) : LED_CHANNEL_MIX_ONE;
+    }
+}
+
+/**
+ * @brief
+ *  Mixing kernel of RGBW light. Common part of R, G and B is moved to the
+ *  white channel, then outputs are corrected by APP_RGBW_CALIBRATION and
+ *  scaled, so the strongest channel gives full level output.
+ */
+static void led_light_rgbw_mixes_set(const int32_t *rgb)
+{
+    int32_t w = rgb[0];
+    int32_t out[LED_LIGHT_RGBW_COUNT];
+    int32_t max = 0;
+
+    w = rgb[1] < w ? rgb[1] : w;
+    w = rgb[2] < w ? rgb[2] : w;
+
+    int32_t in[LED_LIGHT_RGBW_COUNT] = { rgb[0] - w, rgb[1] - w, rgb[2] - w, w };
+
+    for (size_t ch = 0; ch < LED_LIGHT_RGBW_COUNT; ch++)
+    {
+        int32_t acc = 0;
+
+        for (size_t j = 0; j < LED_LIGHT_RGBW_COUNT; j++)
+        {
+            acc += ((int32_t)led_light_rgbw_cal[ch][j] * in[j]) >> LED_LIGHT_CAL_SHIFT;
+        }
+
+        out[ch] = acc > 0 ? acc : 0;
+        max = out[ch] > max ? out[ch] : max;
+    }
+
+    for (size_t ch = 0; ch < LED_LIGHT_RGBW_COUNT; ch++)
+    {
+        led_light.mixes[ch] = max > 0 ? (uint16_t)(((int64_t)out[ch] * LED_CHANNEL_MIX_ONE) / max) : 0;
+    }
+}
+#endif
+
+static void led_light_mixed_stage(void)
+{
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE
+    uint16_t warm = led_light_warm_mix_get(led_light.mireds);
+
+    led_channel_level_mix_stage(LedChannel_CH1, led_light.level_q8, warm);
+    led_channel_level_mix_stage(LedChannel_CH2, led_light.level_q8, LED_CHANNEL_MIX_ONE - warm);
+#elif APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    for (size_t ch = 0; ch < LED_LIGHT_RGBW_COUNT; ch++)
+    {
+        led_channel_level_mix_stage(ch, led_light.level_q8, led_light.mixes[ch]);
+    }
+#else
+    led_channel_level_fine_stage(LED_LIGHT_MIXED_EP - 1, led_light.level_q8);
+#endif
+}
+
+void led_light_init(void)
+{
+    led_light.level_q8 = 0;
+    led_light.mireds = (APP_TW_WARM_MIREDS + APP_TW_COOL_MIREDS) / 2;
+
+    for (size_t ch = 0; ch < LED_LIGHT_RGBW_COUNT; ch++)
+    {
+        /* white till color is restored */
+        led_light.mixes[ch] = ch == LED_LIGHT_RGBW_COUNT - 1 ? LED_CHANNEL_MIX_ONE : 0;
+    }
+}
+
+bool led_light_is_mixed(uint8_t ep_id)
+{
+    return APP_LIGHT_MODE != APP_LIGHT_MODE_CHANNELS && ep_id == LED_LIGHT_MIXED_EP;
+}
+
+void led_light_level_stage(uint8_t ep_id, uint8_t level)
+{
+    led_light_level_fine_stage(ep_id, level << 8);
+}
+
+void led_light_level_fine_stage(uint8_t ep_id, uint16_t level_q8)
+{
+    if (led_light_is_mixed(ep_id) == false)
+    {
+        led_channel_level_fine_stage(ep_id - 1, level_q8);
+        return;
+    }
+
+    led_light.level_q8 = level_q8;
+    led_light_mixed_stage();
+}
+
+void led_light_color_temp_stage(uint16_t mireds)
+{
+    if (mireds < APP_TW_COOL_MIREDS)
+    {
+        mireds = APP_TW_COOL_MIREDS;
+    }
+    else if (mireds > APP_TW_WARM_MIREDS)
+    {
+        mireds = APP_TW_WARM_MIREDS;
+    }
+
+    if (mireds == led_light.mireds)
+    {
+        return;
+    }
+
+    led_light.mireds = mireds;
+
+    if (APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE)
+    {
+        led_light_mixed_stage();
+    }
+}
+
+void led_light_color_hs_stage(uint8_t hue, uint8_t saturation)
+{
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    int32_t rgb[3];
+
+    led_light_hs_to_rgb(hue, saturation, rgb);
+    led_light_rgbw_mixes_set(rgb);
+    led_light_mixed_stage();
+#else
+    (void)hue;
+    (void)saturation;
+#endif
+}
+
+void led_light_color_xy_stage(uint16_t x, uint16_t y)
+{
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    int32_t rgb[3];
+
+    led_light_xy_to_rgb(x, y, rgb);
+    led_light_rgbw_mixes_set(rgb);
+    led_light_mixed_stage();
+#else
+    (void)x;
+    (void)y;
+#endif
+}
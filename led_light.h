@@ -0,0 +1,86 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_LIGHT_H_
+#define LED_LIGHT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_channel.h"
+
+/* endpoint of the light mixed from multiple channels */
+#define LED_LIGHT_MIXED_EP      1
+
+void led_light_init(void);
+
+/**
+ * @brief
+ *  Checks if endpoint light is mixed from multiple channels (depends on
+ *  APP_LIGHT_MODE). Such light can't be faded by single channel LDMA.
+ */
+bool led_light_is_mixed(uint8_t ep_id);
+
+/**
+ * @brief
+ *  Stages level of the endpoint light. All channels of mixed light are
+ *  staged together, so they change in the same PWM period.
+ *
+ * @param ep_id - endpoint
+ * @param level - ZCL level
+ */
+void led_light_level_stage(uint8_t ep_id, uint8_t level);
+
+/**
+ * @brief
+ *  Stages level of the endpoint light with 8 fractional bits, fraction is
+ *  dithered when channel output supports it (see led_channel_level_fine_stage()).
+ *
+ * @param ep_id - endpoint
+ * @param level_q8 - ZCL level in Q8.8 format
+ */
+void led_light_level_fine_stage(uint8_t ep_id, uint16_t level_q8);
+
+/**
+ * @brief
+ *  Stages color temperature of tunable white light. Channels are mixed with
+ *  the last staged level.
+ *
+ * @param mireds - color temperature, clamped to APP_TW_COOL_MIREDS - APP_TW_WARM_MIREDS
+ */
+void led_light_color_temp_stage(uint16_t mireds);
+
+/**
+ * @brief
+ *  Stages hue and saturation of RGBW light. All four channels are mixed with
+ *  the last staged level.
+ *
+ * @param hue - ZCL hue (0 - 254)
+ * @param saturation - ZCL saturation (0 - 254)
+ */
+void led_light_color_hs_stage(uint8_t hue, uint8_t saturation);
+
+/**
+ * @brief
+ *  Stages CIE 1931 chromaticity of RGBW light.
+ *
+ * @param x - ZCL x (0 - 65279)
+ * @param y - ZCL y (0 - 65279)
+ */
+void led_light_color_xy_stage(uint16_t x, uint16_t y);
+
+#endif /* LED_LIGHT_H_ */
@@ -0,0 +1,266 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app.h"
+
+#if APP_METERING
+
+#include "led_meter.h"
+#include "led_channel.h"
+#include "led_light.h"
+#include "af.h"
+#include "dbg_log.h"
+#include "zigbee_app_framework_event.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* attributes are published when output settles, transition changes duty
+ * every step */
+#define LED_METER_UPDATE_DELAY_MS   1000
+/* summation is refreshed periodically while any channel is lit */
+#define LED_METER_REFRESH_MS        60000
+/* delivered energy is written to NVM hourly and when all channels go dark */
+#define LED_METER_CHECKPOINT_MS     (60UL * 60 * 1000)
+
+#define LED_METER_UJ_PER_WH         3600000000ULL
+
+typedef struct
+{
+    uint64_t    energy_uj;      /* delivered energy, mW * ms */
+    uint32_t    power_mw;       /* power at current duty */
+    uint32_t    duty;
+    uint32_t    since_ms;       /* time energy was accounted till */
+
+} LedMeterChannel;
+
+typedef struct
+{
+    LedMeterChannel     ch[APP_EP_COUNT];
+    tokTypeLedMeter     tok[APP_EP_COUNT];      /* stored rated power and energy */
+    uint32_t            checkpoint_ms;
+    sl_zigbee_event_t   update_event;
+    bool                initialized;
+
+} LedMeterModule;
+
+static LedMeterModule led_meter;
+
+/**
+ * @brief
+ *  Returns endpoint the channel energy is reported by, channels mixed into
+ *  one light are summed on its endpoint.
+ */
+static uint8_t led_meter_endpoint_get(LedChannel ch)
+{
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE
+    if (ch < 2)
+    {
+        return LED_LIGHT_MIXED_EP;
+    }
+#elif APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    if (ch < 4)
+    {
+        return LED_LIGHT_MIXED_EP;
+    }
+#endif
+    return ch + 1;
+}
+
+static void led_meter_accumulate(LedMeterChannel *c, uint32_t now)
+{
+    c->energy_uj += (uint64_t)c->power_mw * (uint32_t)(now - c->since_ms);
+    c->since_ms = now;
+}
+
+static void led_meter_power_update(LedChannel ch)
+{
+    LedMeterChannel *c = &led_meter.ch[ch];
+
+    /* 0.1 W -> mW */
+    c->power_mw = (uint32_t)(((uint64_t)led_meter.tok[ch].rated_power * 100 * c->duty) / LED_CHANNEL_DUTY_ONE);
+}
+
+static void led_meter_update_schedule(void)
+{
+    if (sl_zigbee_event_is_scheduled(&led_meter.update_event) == false ||
+        sl_zigbee_event_get_remaining_ms(&led_meter.update_event) > LED_METER_UPDATE_DELAY_MS)
+    {
+        sl_zigbee_event_set_delay_ms(&led_meter.update_event, LED_METER_UPDATE_DELAY_MS);
+    }
+}
+
+/**
+ * @brief
+ *  Stores whole Wh delivered by channels, token is written only when the
+ *  value changed.
+ */
+static void led_meter_checkpoint(uint32_t now)
+{
+    for (size_t i = 0; i < APP_EP_COUNT; i++)
+    {
+        uint32_t energy_wh = (uint32_t)(led_meter.ch[i].energy_uj / LED_METER_UJ_PER_WH);
+
+        if (energy_wh != led_meter.tok[i].energy)
+        {
+            led_meter.tok[i].energy = energy_wh;
+            halCommonSetIndexedToken(TOKEN_LED_METER, i, &led_meter.tok[i]);
+        }
+    }
+
+    led_meter.checkpoint_ms = now;
+}
+
+static void led_meter_attributes_write(uint8_t ep_id, uint32_t demand_w, uint64_t summation_wh)
+{
+    uint8_t demand[3];
+    uint8_t summation[6];
+
+    for (size_t i = 0; i < sizeof(demand); i++)
+    {
+        demand[i] = (uint8_t)(demand_w >> (8 * i));
+    }
+
+    for (size_t i = 0; i < sizeof(summation); i++)
+    {
+        summation[i] = (uint8_t)(summation_wh >> (8 * i));
+    }
+
+    /* reporting of changed values is done by the stack from reportable change */
+    emberAfWriteServerAttribute(ep_id,
+                                ZCL_SIMPLE_METERING_CLUSTER_ID,
+                                ZCL_INSTANTANEOUS_DEMAND_ATTRIBUTE_ID,
+                                demand,
+                                ZCL_INT24S_ATTRIBUTE_TYPE);
+
+    emberAfWriteServerAttribute(ep_id,
+                                ZCL_SIMPLE_METERING_CLUSTER_ID,
+                                ZCL_CURRENT_SUMMATION_DELIVERED_ATTRIBUTE_ID,
+                                summation,
+                                ZCL_INT48U_ATTRIBUTE_TYPE);
+}
+
+static void led_meter_update_event_cb(sl_zigbee_event_t *event)
+{
+    uint32_t now = halCommonGetInt32uMillisecondTick();
+    uint32_t power_mw[APP_EP_COUNT] = { 0 };
+    uint64_t energy_uj[APP_EP_COUNT] = { 0 };
+    uint32_t ep_mask = 0;
+    bool lit = false;
+
+    for (LedChannel ch = 0; ch < APP_EP_COUNT; ch++)
+    {
+        LedMeterChannel *c = &led_meter.ch[ch];
+        uint8_t ep_idx = led_meter_endpoint_get(ch) - 1;
+
+        led_meter_accumulate(c, now);
+
+        power_mw[ep_idx] += c->power_mw;
+        energy_uj[ep_idx] += c->energy_uj;
+        ep_mask |= 1 << ep_idx;
+        lit = lit || c->power_mw != 0;
+    }
+
+    for (size_t i = 0; i < APP_EP_COUNT; i++)
+    {
+        if ((ep_mask & (1 << i)) != 0)
+        {
+            led_meter_attributes_write(i + 1, (power_mw[i] + 500) / 1000, energy_uj[i] / LED_METER_UJ_PER_WH);
+        }
+    }
+
+    if (lit == false || (uint32_t)(now - led_meter.checkpoint_ms) >= LED_METER_CHECKPOINT_MS)
+    {
+        led_meter_checkpoint(now);
+    }
+
+    if (lit)
+    {
+        sl_zigbee_event_set_delay_ms(&led_meter.update_event, LED_METER_REFRESH_MS);
+    }
+}
+
+void led_meter_init(void)
+{
+    uint32_t now = halCommonGetInt32uMillisecondTick();
+
+    for (LedChannel ch = 0; ch < APP_EP_COUNT; ch++)
+    {
+        LedMeterChannel *c = &led_meter.ch[ch];
+
+        halCommonGetIndexedToken(&led_meter.tok[ch], TOKEN_LED_METER, ch);
+
+        c->energy_uj = (uint64_t)led_meter.tok[ch].energy * LED_METER_UJ_PER_WH;
+        c->since_ms = now;
+        c->duty = led_channel_duty_get(ch);
+        led_meter_power_update(ch);
+
+        DBG_LOG("Channel %d rated %d dW, delivered %d Wh", ch, led_meter.tok[ch].rated_power,
+                led_meter.tok[ch].energy);
+    }
+
+    led_meter.checkpoint_ms = now;
+
+    sl_zigbee_event_init(&led_meter.update_event, led_meter_update_event_cb);
+    sl_zigbee_event_set_active(&led_meter.update_event);
+
+    led_meter.initialized = true;
+}
+
+void led_meter_duty_update(LedChannel ch, uint32_t duty)
+{
+    if (led_meter.initialized == false || ch >= APP_EP_COUNT)
+    {
+        return;
+    }
+
+    LedMeterChannel *c = &led_meter.ch[ch];
+
+    if (duty == c->duty)
+    {
+        return;
+    }
+
+    led_meter_accumulate(c, halCommonGetInt32uMillisecondTick());
+    c->duty = duty;
+    led_meter_power_update(ch);
+    led_meter_update_schedule();
+}
+
+bool led_meter_rated_power_set(LedChannel ch, uint16_t rated_power)
+{
+    if (led_meter.initialized == false || ch >= APP_EP_COUNT)
+    {
+        return false;
+    }
+
+    LedMeterChannel *c = &led_meter.ch[ch];
+
+    led_meter_accumulate(c, halCommonGetInt32uMillisecondTick());
+
+    led_meter.tok[ch].rated_power = rated_power;
+    led_meter.tok[ch].energy = (uint32_t)(c->energy_uj / LED_METER_UJ_PER_WH);
+    halCommonSetIndexedToken(TOKEN_LED_METER, ch, &led_meter.tok[ch]);
+
+    led_meter_power_update(ch);
+    led_meter_update_schedule();
+
+    return true;
+}
+
+#endif /* APP_METERING */
@@ -0,0 +1,53 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_METER_H_
+#define LED_METER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_channel.h"
+
+/**
+ * @brief
+ *  Restores rated power and delivered energy of channels and publishes
+ *  Simple Metering attributes of endpoints. Called after led_channel_init().
+ */
+void led_meter_init(void);
+
+/**
+ * @brief
+ *  Accounts energy delivered at the previous duty and starts accounting of
+ *  the new one. Called by led_channel on every output change.
+ *
+ * @param ch - PWM channel
+ * @param duty - new duty cycle (LED_CHANNEL_DUTY_ONE - always on)
+ */
+void led_meter_duty_update(LedChannel ch, uint32_t duty);
+
+/**
+ * @brief
+ *  Sets power of the strip connected to the channel at full duty.
+ *
+ * @param ch - PWM channel
+ * @param rated_power - power in 0.1 W
+ * @return false when channel is not metered
+ */
+bool led_meter_rated_power_set(LedChannel ch, uint16_t rated_power);
+
+#endif /* LED_METER_H_ */
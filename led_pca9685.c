@@ -0,0 +1,375 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app.h"
+
+#if APP_EXT_CHANNEL_COUNT > 0
+
+#include "led_pca9685.h"
+#include "pin_config.h"
+#include "dbg_log.h"
+
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_gpio.h"
+#include "em_i2c.h"
+#include "sl_component_catalog.h"
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+#include "sl_power_manager.h"
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* I2C1 is in EM0/EM1 domain, EM1 is required only while transfer is running */
+#define LED_PCA9685_I2C             I2C1
+#define LED_PCA9685_I2C_CLOCK       cmuClock_I2C1
+#define LED_PCA9685_I2C_IRQ         I2C1_IRQn
+#define LED_PCA9685_I2C_FREQ        I2C_FREQ_FAST_MAX
+
+#ifndef LED_PCA9685_SDA_PORT
+#define LED_PCA9685_SDA_PORT        gpioPortB
+#endif
+#ifndef LED_PCA9685_SDA_PIN
+#define LED_PCA9685_SDA_PIN         0
+#endif
+#ifndef LED_PCA9685_SCL_PORT
+#define LED_PCA9685_SCL_PORT        gpioPortB
+#endif
+#ifndef LED_PCA9685_SCL_PIN
+#define LED_PCA9685_SCL_PIN         1
+#endif
+
+/* internal oscillator, PWM frequency is OSC / (4096 * (PRE_SCALE + 1)) */
+#define LED_PCA9685_OSC_HZ          25000000UL
+#define LED_PCA9685_PWM_FREQ        1000
+#define LED_PCA9685_PRESCALE_MIN    3
+
+#define LED_PCA9685_OUTPUTS         16
+#define LED_PCA9685_COUNTS          4096
+
+/* when enabled output pulses start at offsets spread over PWM period (LEDn_ON
+ * registers), so outputs switching at the same time are not turned on together */
+#define LED_PCA9685_PHASE_STAGGER   1
+
+#define LED_PCA9685_REG_MODE1       0x00
+#define LED_PCA9685_REG_MODE2       0x01
+#define LED_PCA9685_REG_LED0_ON_L   0x06
+#define LED_PCA9685_REG_ALL_OFF_H   0xFD
+#define LED_PCA9685_REG_PRE_SCALE   0xFE
+
+#define LED_PCA9685_MODE1_AI        0x20    /* register auto increment */
+#define LED_PCA9685_MODE1_SLEEP     0x10
+#define LED_PCA9685_MODE2_OUTDRV    0x04    /* totem pole outputs */
+#define LED_PCA9685_FULL            0x10    /* full on / full off bit of LEDn_ON_H / LEDn_OFF_H */
+
+/* register address and ON_L, ON_H, OFF_L, OFF_H of every output */
+#define LED_PCA9685_BURST_MAX       (1 + LED_PCA9685_OUTPUTS * 4)
+
+typedef struct
+{
+    uint16_t                    duty[LED_PCA9685_OUTPUTS];  /* staged duty, 0 - LED_PCA9685_COUNTS */
+    volatile uint16_t           dirty;                      /* outputs not sent yet, bit per output */
+    uint16_t                    sent;                       /* outputs of running transfer */
+    volatile bool               busy;
+    uint8_t                     tx[LED_PCA9685_BURST_MAX];
+    I2C_TransferSeq_TypeDef     seq;
+    uint32_t                    transfers;
+    uint32_t                    bytes;
+    uint32_t                    errors;
+    uint32_t                    frequency;
+    bool                        initialized;
+
+} LedPca9685Module;
+
+static LedPca9685Module pca9685;
+
+static void led_pca9685_flush(void);
+
+/**
+ * @brief
+ *  Writes registers with blocking transfer. Used during initialization only,
+ *  before transfer interrupt is enabled.
+ */
+static bool led_pca9685_write(uint8_t reg, const uint8_t *data, uint16_t len)
+{
+    I2C_TransferReturn_TypeDef ret;
+
+    pca9685.tx[0] = reg;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        pca9685.tx[1 + i] = data[i];
+    }
+
+    pca9685.seq.addr = APP_PCA9685_ADDRESS << 1;
+    pca9685.seq.flags = I2C_FLAG_WRITE;
+    pca9685.seq.buf[0].data = pca9685.tx;
+    pca9685.seq.buf[0].len = len + 1;
+
+    ret = I2C_TransferInit(LED_PCA9685_I2C, &pca9685.seq);
+    while (ret == i2cTransferInProgress)
+    {
+        ret = I2C_Transfer(LED_PCA9685_I2C);
+    }
+
+    if (ret != i2cTransferDone)
+    {
+        DBG_LOG("PCA9685 register 0x%02X write failed: %d", reg, ret);
+        return false;
+    }
+
+    return true;
+}
+
+static bool led_pca9685_reg_set(uint8_t reg, uint8_t value)
+{
+    return led_pca9685_write(reg, &value, 1);
+}
+
+static void led_pca9685_chip_init(void)
+{
+    CMU_ClockEnable(cmuClock_GPIO, true);
+    CMU_ClockEnable(LED_PCA9685_I2C_CLOCK, true);
+
+    GPIO_PinModeSet(LED_PCA9685_SDA_PORT, LED_PCA9685_SDA_PIN, gpioModeWiredAndPullUpFilter, 1);
+    GPIO_PinModeSet(LED_PCA9685_SCL_PORT, LED_PCA9685_SCL_PIN, gpioModeWiredAndPullUpFilter, 1);
+
+    GPIO->I2CROUTE[I2C_NUM(LED_PCA9685_I2C)].SDAROUTE =
+        (LED_PCA9685_SDA_PORT << _GPIO_I2C_SDAROUTE_PORT_SHIFT) | (LED_PCA9685_SDA_PIN << _GPIO_I2C_SDAROUTE_PIN_SHIFT);
+    GPIO->I2CROUTE[I2C_NUM(LED_PCA9685_I2C)].SCLROUTE =
+        (LED_PCA9685_SCL_PORT << _GPIO_I2C_SCLROUTE_PORT_SHIFT) | (LED_PCA9685_SCL_PIN << _GPIO_I2C_SCLROUTE_PIN_SHIFT);
+    GPIO->I2CROUTE[I2C_NUM(LED_PCA9685_I2C)].ROUTEEN = GPIO_I2C_ROUTEEN_SDAPEN | GPIO_I2C_ROUTEEN_SCLPEN;
+
+    I2C_Init_TypeDef init = I2C_INIT_DEFAULT;
+
+    init.freq = LED_PCA9685_I2C_FREQ;
+    init.clhr = i2cClockHLRAsymetric;
+    I2C_Init(LED_PCA9685_I2C, &init);
+
+    uint32_t prescale = (LED_PCA9685_OSC_HZ + (LED_PCA9685_COUNTS * LED_PCA9685_PWM_FREQ) / 2) /
+                        (LED_PCA9685_COUNTS * LED_PCA9685_PWM_FREQ) - 1;
+
+    if (prescale < LED_PCA9685_PRESCALE_MIN)
+    {
+        prescale = LED_PCA9685_PRESCALE_MIN;
+    }
+
+    pca9685.frequency = LED_PCA9685_OSC_HZ / (LED_PCA9685_COUNTS * (prescale + 1));
+
+    /* prescaler can be written in sleep mode only, all outputs are off till first update */
+    bool ok = led_pca9685_reg_set(LED_PCA9685_REG_MODE1, LED_PCA9685_MODE1_AI | LED_PCA9685_MODE1_SLEEP) &&
+              led_pca9685_reg_set(LED_PCA9685_REG_PRE_SCALE, (uint8_t)prescale) &&
+              led_pca9685_reg_set(LED_PCA9685_REG_MODE2, LED_PCA9685_MODE2_OUTDRV) &&
+              led_pca9685_reg_set(LED_PCA9685_REG_ALL_OFF_H, LED_PCA9685_FULL) &&
+              led_pca9685_reg_set(LED_PCA9685_REG_MODE1, LED_PCA9685_MODE1_AI);
+
+    DBG_LOG("PCA9685 at 0x%02X %s, PWM %d Hz", APP_PCA9685_ADDRESS, ok ? "initialized" : "not responding",
+            pca9685.frequency);
+    (void)ok;
+
+    NVIC_ClearPendingIRQ(LED_PCA9685_I2C_IRQ);
+    NVIC_EnableIRQ(LED_PCA9685_I2C_IRQ);
+
+    pca9685.initialized = true;
+}
+
+void I2C1_IRQHandler(void)
+{
+    I2C_TransferReturn_TypeDef ret = I2C_Transfer(LED_PCA9685_I2C);
+
+    if (ret == i2cTransferInProgress)
+    {
+        return;
+    }
+
+    if (ret == i2cTransferDone)
+    {
+        pca9685.transfers++;
+        pca9685.bytes += 1 + pca9685.seq.buf[0].len;
+    }
+
+    pca9685.busy = false;
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+    if (ret != i2cTransferDone)
+    {
+        /* outputs keep previous values, they are sent again with the next update */
+        pca9685.dirty |= pca9685.sent;
+        pca9685.errors++;
+        return;
+    }
+
+    /* values staged during the transfer */
+    if (pca9685.dirty != 0)
+    {
+        led_pca9685_flush();
+    }
+}
+
+static void led_pca9685_init(sl_led_pwm_t *led)
+{
+    if (pca9685.initialized == false)
+    {
+        led_pca9685_chip_init();
+    }
+
+    led->frequency = pca9685.frequency;
+    led->resolution = LED_PCA9685_COUNTS;
+}
+
+static uint32_t led_pca9685_top_get(sl_led_pwm_t *led)
+{
+    (void)led;
+
+    return LED_PCA9685_COUNTS - 1;
+}
+
+static void led_pca9685_compare_set(sl_led_pwm_t *led, uint32_t compare)
+{
+    uint8_t output = led->channel;
+
+    if (output >= LED_PCA9685_OUTPUTS)
+    {
+        return;
+    }
+
+    if (compare > LED_PCA9685_COUNTS)
+    {
+        compare = LED_PCA9685_COUNTS;
+    }
+
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_CRITICAL();
+    pca9685.duty[output] = (uint16_t)(led->polarity ? LED_PCA9685_COUNTS - compare : compare);
+    pca9685.dirty |= (1 << output);
+    CORE_EXIT_CRITICAL();
+}
+
+/**
+ * @brief
+ *  Sends all staged outputs in one auto-increment write, from the lowest to
+ *  the highest changed output. When transfer is running, values are sent
+ *  after its completion, so updates of the same tick are coalesced.
+ */
+static void led_pca9685_flush(void)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_CRITICAL();
+    uint16_t dirty = pca9685.dirty;
+
+    if (pca9685.busy || dirty == 0)
+    {
+        CORE_EXIT_CRITICAL();
+        return;
+    }
+
+    uint8_t first = 0;
+    uint8_t last = LED_PCA9685_OUTPUTS - 1;
+
+    while ((dirty & (1 << first)) == 0)
+    {
+        first++;
+    }
+
+    while ((dirty & (1 << last)) == 0)
+    {
+        last--;
+    }
+
+    uint8_t *p = pca9685.tx;
+
+    *p++ = LED_PCA9685_REG_LED0_ON_L + first * 4;
+
+    for (uint8_t i = first; i <= last; i++)
+    {
+        uint16_t duty = pca9685.duty[i];
+        uint16_t on = 0;
+        uint16_t off = 0;
+
+        if (duty == 0)
+        {
+            off = LED_PCA9685_FULL << 8;
+        }
+        else if (duty >= LED_PCA9685_COUNTS)
+        {
+            on = LED_PCA9685_FULL << 8;
+        }
+        else
+        {
+#if LED_PCA9685_PHASE_STAGGER
+            on = (i * (LED_PCA9685_COUNTS / LED_PCA9685_OUTPUTS)) & (LED_PCA9685_COUNTS - 1);
+#endif
+            off = (on + duty) & (LED_PCA9685_COUNTS - 1);
+        }
+
+        *p++ = (uint8_t)on;
+        *p++ = (uint8_t)(on >> 8);
+        *p++ = (uint8_t)off;
+        *p++ = (uint8_t)(off >> 8);
+    }
+
+    pca9685.sent = (uint16_t)(((1 << (last + 1)) - 1) & ~((1 << first) - 1));
+    pca9685.dirty = 0;
+    pca9685.busy = true;
+
+    pca9685.seq.addr = APP_PCA9685_ADDRESS << 1;
+    pca9685.seq.flags = I2C_FLAG_WRITE;
+    pca9685.seq.buf[0].data = pca9685.tx;
+    pca9685.seq.buf[0].len = (uint16_t)(p - pca9685.tx);
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+    sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+    /* rest of the transfer is driven from I2C interrupt */
+    if (I2C_TransferInit(LED_PCA9685_I2C, &pca9685.seq) != i2cTransferInProgress)
+    {
+        pca9685.dirty |= pca9685.sent;
+        pca9685.busy = false;
+        pca9685.errors++;
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+        sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+    }
+    CORE_EXIT_CRITICAL();
+}
+
+void led_pca9685_stats_get(uint32_t *transfers, uint32_t *bytes, uint32_t *errors)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_CRITICAL();
+    *transfers = pca9685.transfers;
+    *bytes = pca9685.bytes;
+    *errors = pca9685.errors;
+    CORE_EXIT_CRITICAL();
+}
+
+const LedPwmBackend led_pca9685_backend =
+{
+    .init = led_pca9685_init,
+    .top_get = led_pca9685_top_get,
+    .compare_set = led_pca9685_compare_set,
+    .flush = led_pca9685_flush,
+};
+
+#endif /* APP_EXT_CHANNEL_COUNT > 0 */
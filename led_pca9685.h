@@ -0,0 +1,39 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_PCA9685_H_
+#define LED_PCA9685_H_
+
+#include <stdint.h>
+#include "led_pwm_backend.h"
+
+/* PWM backend of channels from APP_CHANNEL_EXT_TABLE, channel is PCA9685 output */
+extern const LedPwmBackend led_pca9685_backend;
+
+/**
+ * @brief
+ *  Returns number of I2C transfers sent to PCA9685 and their total length in
+ *  bytes (with address byte), so cost of an update can be checked on target.
+ *
+ * @param transfers - completed transfers
+ * @param bytes - bytes sent by completed transfers
+ * @param errors - failed transfers (in ex. not acknowledged)
+ */
+void led_pca9685_stats_get(uint32_t *transfers, uint32_t *bytes, uint32_t *errors);
+
+#endif /* LED_PCA9685_H_ */
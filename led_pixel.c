@@ -0,0 +1,305 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app.h"
+
+#if APP_PIXEL_CHANNEL_COUNT > 0
+
+#include "led_pixel.h"
+#include "pin_config.h"
+#include "dbg_log.h"
+
+#include "dmadrv.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_gpio.h"
+#include "em_usart.h"
+#include "zigbee_app_framework_event.h"
+#include "sl_component_catalog.h"
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+#include "sl_power_manager.h"
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* pixel data bit is sent as 3 USART bits (100 - 0, 110 - 1), so high time is
+ * ~0.4 us or ~0.8 us of 1.25 us bit period */
+#define LED_PIXEL_USART             USART1
+#define LED_PIXEL_USART_CLOCK       cmuClock_USART1
+#define LED_PIXEL_DMA_SIGNAL        dmadrvPeripheralSignal_USART1_TXBL
+#define LED_PIXEL_BIT_RATE          2400000
+
+#ifndef LED_PIXEL_DATA_PORT
+#define LED_PIXEL_DATA_PORT         gpioPortA
+#endif
+#ifndef LED_PIXEL_DATA_PIN
+#define LED_PIXEL_DATA_PIN          0
+#endif
+
+#define LED_PIXEL_FRAME_BYTES       (APP_PIXEL_COUNT * APP_PIXEL_BYTES)
+
+/* data bytes encoded into one LDMA buffer, buffer is 3 times longer */
+#define LED_PIXEL_CHUNK_BYTES       32
+#define LED_PIXEL_CODE_BYTES        3
+
+/* line is kept low for 32 data byte times (~320 us) after frame, it latches
+ * pixel data (WS2812B needs > 280 us) and leaves the line low between frames */
+#define LED_PIXEL_RESET_BYTES       32
+
+#define LED_PIXEL_STREAM_BYTES      (LED_PIXEL_FRAME_BYTES + LED_PIXEL_RESET_BYTES)
+
+typedef struct
+{
+    uint16_t    first;      /* first pixel */
+    uint16_t    count;      /* number of pixels */
+    uint8_t     color;      /* byte of pixel data */
+
+} LedPixelSegmentCfg;
+
+#define LED_PIXEL_SEGMENT(name, first, count, color)    { first, count, color },
+
+static const LedPixelSegmentCfg segments[] =
+{
+    APP_CHANNEL_PIXEL_TABLE(LED_PIXEL_SEGMENT)
+};
+
+typedef struct
+{
+    uint8_t             frame[LED_PIXEL_FRAME_BYTES];   /* pixel data in strip order */
+    uint8_t             buf[2][LED_PIXEL_CHUNK_BYTES * LED_PIXEL_CODE_BYTES];
+    uint32_t            rendered;                       /* frame and reset bytes encoded */
+    unsigned int        dma_ch;
+    volatile bool       busy;                           /* frame is streamed by LDMA */
+    volatile bool       pending;                        /* frame was changed after it was streamed */
+    sl_zigbee_event_t   frame_event;
+    uint32_t            encode_cycles_max;
+    bool                initialized;
+
+} LedPixelModule;
+
+static LedPixelModule led_pixel;
+
+/* USART code of pixel data nibble, MSB first */
+static const uint16_t led_pixel_code[16] =
+{
+    0x924, 0x926, 0x934, 0x936, 0x9A4, 0x9A6, 0x9B4, 0x9B6,
+    0xD24, 0xD26, 0xD34, 0xD36, 0xDA4, 0xDA6, 0xDB4, 0xDB6,
+};
+
+static void led_pixel_flush(void);
+
+/**
+ * @brief
+ *  Encodes next part of the frame into LDMA buffer. Bytes after pixel data
+ *  are left zero, so the line is low during reset.
+ */
+static void led_pixel_render(uint8_t *buf)
+{
+#if defined(DEBUG)
+    uint32_t start = DWT->CYCCNT;
+#endif
+
+    for (size_t i = 0; i < LED_PIXEL_CHUNK_BYTES; i++)
+    {
+        uint32_t code = 0;
+
+        if (led_pixel.rendered < LED_PIXEL_FRAME_BYTES)
+        {
+            uint8_t value = led_pixel.frame[led_pixel.rendered];
+
+            code = ((uint32_t)led_pixel_code[value >> 4] << 12) | led_pixel_code[value & 0x0F];
+        }
+
+        led_pixel.rendered++;
+
+        *buf++ = (uint8_t)(code >> 16);
+        *buf++ = (uint8_t)(code >> 8);
+        *buf++ = (uint8_t)code;
+    }
+
+#if defined(DEBUG)
+    uint32_t cycles = DWT->CYCCNT - start;
+    if (cycles > led_pixel.encode_cycles_max)
+    {
+        led_pixel.encode_cycles_max = cycles;
+    }
+#endif
+}
+
+/* called from LDMA interrupt when one of ping-pong buffers was sent */
+static bool led_pixel_dma_cb(unsigned int channel, unsigned int sequenceNo, void *userParam)
+{
+    if (sequenceNo * LED_PIXEL_CHUNK_BYTES >= LED_PIXEL_STREAM_BYTES)
+    {
+        /* buffer in progress holds reset bytes only */
+        led_pixel.busy = false;
+        sl_zigbee_event_set_active(&led_pixel.frame_event);
+        return false;
+    }
+
+    /* buffers are used alternately, so sent one is refilled */
+    led_pixel_render(led_pixel.buf[(sequenceNo - 1) & 1]);
+
+    return true;
+}
+
+static void led_pixel_frame_event_cb(sl_zigbee_event_t *event)
+{
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+    /* levels changed while the frame was streamed */
+    led_pixel_flush();
+}
+
+static void led_pixel_strip_init(void)
+{
+    CMU_ClockEnable(cmuClock_GPIO, true);
+    CMU_ClockEnable(LED_PIXEL_USART_CLOCK, true);
+
+    GPIO_PinModeSet(LED_PIXEL_DATA_PORT, LED_PIXEL_DATA_PIN, gpioModePushPull, 0);
+
+    USART_InitSync_TypeDef init = USART_INITSYNC_DEFAULT;
+
+    init.enable = usartEnableTx;
+    init.baudrate = LED_PIXEL_BIT_RATE;
+    init.msbf = true;
+    USART_InitSync(LED_PIXEL_USART, &init);
+
+    GPIO->USARTROUTE[USART_NUM(LED_PIXEL_USART)].TXROUTE =
+        (LED_PIXEL_DATA_PORT << _GPIO_USART_TXROUTE_PORT_SHIFT) | (LED_PIXEL_DATA_PIN << _GPIO_USART_TXROUTE_PIN_SHIFT);
+    GPIO->USARTROUTE[USART_NUM(LED_PIXEL_USART)].ROUTEEN = GPIO_USART_ROUTEEN_TXPEN;
+
+    DMADRV_Init();
+
+    Ecode_t status = DMADRV_AllocateChannel(&led_pixel.dma_ch, NULL);
+    if (status != ECODE_EMDRV_DMADRV_OK)
+    {
+        DBG_LOG("Can't allocate DMA channel for pixel strip: 0x%X", status);
+        return;
+    }
+
+    sl_zigbee_event_init(&led_pixel.frame_event, led_pixel_frame_event_cb);
+    led_pixel.initialized = true;
+
+#if defined(DEBUG)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    DBG_LOG("Pixel strip %d pixels, %d bytes RAM per pixel, frame %d [us]", APP_PIXEL_COUNT, APP_PIXEL_BYTES,
+            (LED_PIXEL_STREAM_BYTES * 8 * LED_PIXEL_CODE_BYTES * 1000UL) / (LED_PIXEL_BIT_RATE / 1000));
+}
+
+static void led_pixel_init(sl_led_pwm_t *led)
+{
+    if (led_pixel.initialized == false)
+    {
+        led_pixel_strip_init();
+    }
+
+    /* PWM is generated by pixels */
+    led->frequency = 0;
+    led->resolution = UINT8_MAX + 1;
+}
+
+static uint32_t led_pixel_top_get(sl_led_pwm_t *led)
+{
+    (void)led;
+
+    return UINT8_MAX;
+}
+
+static void led_pixel_compare_set(sl_led_pwm_t *led, uint32_t compare)
+{
+    const LedPixelSegmentCfg *seg = &segments[led->channel];
+    uint8_t value = compare > UINT8_MAX ? UINT8_MAX : (uint8_t)compare;
+
+    for (uint32_t p = seg->first; p < (uint32_t)seg->first + seg->count && p < APP_PIXEL_COUNT; p++)
+    {
+        led_pixel.frame[p * APP_PIXEL_BYTES + seg->color] = value;
+    }
+
+    led_pixel.pending = true;
+}
+
+/**
+ * @brief
+ *  Starts streaming of the frame when it was changed. Frame in progress is
+ *  completed first, then the next one is started from event, so changes of
+ *  multiple segments are coalesced.
+ */
+static void led_pixel_flush(void)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_CRITICAL();
+    if (led_pixel.initialized == false || led_pixel.busy || led_pixel.pending == false)
+    {
+        CORE_EXIT_CRITICAL();
+        return;
+    }
+
+    led_pixel.busy = true;
+    led_pixel.pending = false;
+    CORE_EXIT_CRITICAL();
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+    sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+    led_pixel.rendered = 0;
+    led_pixel_render(led_pixel.buf[0]);
+    led_pixel_render(led_pixel.buf[1]);
+
+    Ecode_t status = DMADRV_MemoryPeripheralPingPong(led_pixel.dma_ch,
+                                                     LED_PIXEL_DMA_SIGNAL,
+                                                     (void*)&LED_PIXEL_USART->TXDATA,
+                                                     led_pixel.buf[0], led_pixel.buf[1],
+                                                     true,
+                                                     sizeof(led_pixel.buf[0]),
+                                                     dmadrvDataSize1,
+                                                     led_pixel_dma_cb,
+                                                     NULL);
+    if (status != ECODE_EMDRV_DMADRV_OK)
+    {
+        DBG_LOG("Can't start pixel strip frame: 0x%X", status);
+        led_pixel.busy = false;
+        led_pixel.pending = true;
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+        sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+    }
+}
+
+uint32_t led_pixel_encode_cycles_get(void)
+{
+    return led_pixel.encode_cycles_max;
+}
+
+const LedPwmBackend led_pixel_backend =
+{
+    .init = led_pixel_init,
+    .top_get = led_pixel_top_get,
+    .compare_set = led_pixel_compare_set,
+    .flush = led_pixel_flush,
+};
+
+#endif /* APP_PIXEL_CHANNEL_COUNT > 0 */
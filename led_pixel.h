@@ -0,0 +1,46 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_PIXEL_H_
+#define LED_PIXEL_H_
+
+#include <stdint.h>
+#include "app.h"
+#include "led_pwm_backend.h"
+
+#define LED_PIXEL_SEGMENT_ENUM(name, ...)   LedPixelSegment_##name,
+
+/* segments from APP_CHANNEL_PIXEL_TABLE, segment is channel of its sl_led_pwm_t */
+typedef enum
+{
+    APP_CHANNEL_PIXEL_TABLE(LED_PIXEL_SEGMENT_ENUM)
+
+    LedPixelSegment_MAX
+} LedPixelSegment;
+
+/* PWM backend of channels from APP_CHANNEL_PIXEL_TABLE, compare value is color byte */
+extern const LedPwmBackend led_pixel_backend;
+
+/**
+ * @brief
+ *  Returns the longest time of encoding one LDMA buffer in CPU cycles
+ *  (measured in DEBUG builds only), see LED_PIXEL_CHUNK_BYTES.
+ */
+uint32_t led_pixel_encode_cycles_get(void);
+
+#endif /* LED_PIXEL_H_ */
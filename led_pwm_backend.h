@@ -0,0 +1,41 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_PWM_BACKEND_H_
+#define LED_PWM_BACKEND_H_
+
+#include <stdint.h>
+#include "sl_pwm_led.h"
+
+/**
+ * @brief
+ *  PWM output driver of led_channel. Compare values are levels mapped by
+ *  channel dimming curve to 0 - TOP + 1 range of the backend. Values written
+ *  by compare_set() may be staged, they are applied by flush(), so values of
+ *  multiple channels set in the same tick are sent to hardware together.
+ */
+typedef struct
+{
+    void        (*init)(sl_led_pwm_t *led);                         /* may update frequency and resolution */
+    uint32_t    (*top_get)(sl_led_pwm_t *led);                      /* compare value of full output - 1 */
+    void        (*compare_set)(sl_led_pwm_t *led, uint32_t compare);
+    void        (*flush)(void);                                     /* NULL when values are applied immediately */
+
+} LedPwmBackend;
+
+#endif /* LED_PWM_BACKEND_H_ */
@@ -0,0 +1,234 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "led_sched.h"
+#include "af.h"
+#include "dbg_log.h"
+#include "zigbee_app_framework_event.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* slots per client, bit of active mask each */
+#define LED_SCHED_SLOTS         LedChannel_MAX
+
+/* deadline is delayed by up to this time to be serviced with another slot */
+#ifndef LED_SCHED_MERGE_MS
+#define LED_SCHED_MERGE_MS      2
+#endif
+
+/* deadlines are kept apart from masks and callbacks, so search for the next
+ * deadline walks one compact array */
+typedef struct
+{
+    uint32_t            deadline_ms[LedSchedClient_MAX * LED_SCHED_SLOTS];
+    uint32_t            latest_ms[LedSchedClient_MAX * LED_SCHED_SLOTS];   /* deadline may be delayed till */
+    uint32_t            active[LedSchedClient_MAX];     /* bit per slot */
+    LedSchedCb          cb[LedSchedClient_MAX];
+    uint32_t            wakeups;
+    uint32_t            serviced;
+    bool                servicing;                      /* event is rescheduled after pass */
+    bool                initialized;
+    sl_zigbee_event_t   event;
+
+} LedSchedModule;
+
+static LedSchedModule led_sched;
+
+_Static_assert(LED_SCHED_SLOTS <= 32, "Scheduler slots don't fit active mask");
+
+/**
+ * @brief
+ *  Schedules event to the nearest deadline of all clients.
+ */
+static void led_sched_reschedule(uint32_t now)
+{
+    bool found = false;
+    int32_t nearest = 0;
+
+    for (size_t c = 0; c < LedSchedClient_MAX; c++)
+    {
+        for (size_t i = 0; i < LED_SCHED_SLOTS && (led_sched.active[c] >> i) != 0; i++)
+        {
+            if ((led_sched.active[c] & (1UL << i)) == 0)
+            {
+                continue;
+            }
+
+            int32_t left = (int32_t)(led_sched.deadline_ms[c * LED_SCHED_SLOTS + i] - now);
+
+            if (found == false || left < nearest)
+            {
+                nearest = left;
+                found = true;
+            }
+        }
+    }
+
+    if (found == false)
+    {
+        sl_zigbee_event_set_inactive(&led_sched.event);
+    }
+    else
+    {
+        sl_zigbee_event_set_delay_ms(&led_sched.event, nearest > 0 ? (uint32_t)nearest : 0);
+    }
+}
+
+static void led_sched_event_cb(sl_zigbee_event_t *event)
+{
+    uint32_t now = halCommonGetInt32uMillisecondTick();
+    uint32_t due[LedSchedClient_MAX];
+
+    led_sched.wakeups++;
+
+    /* due slots are collected first, callbacks can schedule them again */
+    for (size_t c = 0; c < LedSchedClient_MAX; c++)
+    {
+        due[c] = 0;
+
+        for (size_t i = 0; i < LED_SCHED_SLOTS && (led_sched.active[c] >> i) != 0; i++)
+        {
+            if ((led_sched.active[c] & (1UL << i)) != 0 &&
+                (int32_t)(led_sched.deadline_ms[c * LED_SCHED_SLOTS + i] - now) <= 0)
+            {
+                due[c] |= 1UL << i;
+            }
+        }
+
+        led_sched.active[c] &= ~due[c];
+    }
+
+    led_sched.servicing = true;
+
+    for (size_t c = 0; c < LedSchedClient_MAX; c++)
+    {
+        for (size_t i = 0; i < LED_SCHED_SLOTS && (due[c] >> i) != 0; i++)
+        {
+            if ((due[c] & (1UL << i)) != 0 && led_sched.cb[c] != NULL)
+            {
+                led_sched.serviced++;
+                led_sched.cb[c]((uint8_t)i);
+            }
+        }
+    }
+
+    led_sched.servicing = false;
+
+    led_sched_reschedule(halCommonGetInt32uMillisecondTick());
+}
+
+void led_sched_register(LedSchedClient client, LedSchedCb cb)
+{
+    if (led_sched.initialized == false)
+    {
+        sl_zigbee_event_init(&led_sched.event, led_sched_event_cb);
+        led_sched.initialized = true;
+    }
+
+    led_sched.cb[client] = cb;
+}
+
+void led_sched_set_delay_ms(LedSchedClient client, uint8_t index, uint32_t delay_ms)
+{
+    uint32_t now = halCommonGetInt32uMillisecondTick();
+    uint32_t deadline = now + delay_ms;
+    uint32_t merge = LED_SCHED_MERGE_MS + 1;
+
+    if (index >= LED_SCHED_SLOTS)
+    {
+        return;
+    }
+
+    /* the nearest later deadline within merge window is taken */
+    for (size_t c = 0; c < LedSchedClient_MAX; c++)
+    {
+        for (size_t i = 0; i < LED_SCHED_SLOTS && (led_sched.active[c] >> i) != 0; i++)
+        {
+            uint32_t diff = led_sched.deadline_ms[c * LED_SCHED_SLOTS + i] - deadline;
+
+            if ((led_sched.active[c] & (1UL << i)) != 0 && diff < merge &&
+                (c != client || i != index))
+            {
+                merge = diff;
+            }
+        }
+    }
+
+    if (merge <= LED_SCHED_MERGE_MS)
+    {
+        deadline += merge;
+    }
+
+    /* earlier deadlines within their merge window are delayed to this one,
+     * so slots started a few ms apart (group command) don't wake separately */
+    for (size_t c = 0; c < LedSchedClient_MAX; c++)
+    {
+        for (size_t i = 0; i < LED_SCHED_SLOTS && (led_sched.active[c] >> i) != 0; i++)
+        {
+            size_t slot = c * LED_SCHED_SLOTS + i;
+
+            if ((led_sched.active[c] & (1UL << i)) != 0 && (c != client || i != index) &&
+                (int32_t)(deadline - led_sched.deadline_ms[slot]) > 0 &&
+                (int32_t)(led_sched.latest_ms[slot] - deadline) >= 0)
+            {
+                led_sched.deadline_ms[slot] = deadline;
+            }
+        }
+    }
+
+    led_sched.deadline_ms[client * LED_SCHED_SLOTS + index] = deadline;
+    led_sched.latest_ms[client * LED_SCHED_SLOTS + index] = now + delay_ms + LED_SCHED_MERGE_MS;
+    led_sched.active[client] |= 1UL << index;
+
+    if (led_sched.servicing == false)
+    {
+        led_sched_reschedule(now);
+    }
+}
+
+void led_sched_set_active(LedSchedClient client, uint8_t index)
+{
+    led_sched_set_delay_ms(client, index, 0);
+}
+
+void led_sched_set_inactive(LedSchedClient client, uint8_t index)
+{
+    if (index >= LED_SCHED_SLOTS)
+    {
+        return;
+    }
+
+    led_sched.active[client] &= ~(1UL << index);
+
+    if (led_sched.servicing == false)
+    {
+        led_sched_reschedule(halCommonGetInt32uMillisecondTick());
+    }
+}
+
+bool led_sched_is_scheduled(LedSchedClient client, uint8_t index)
+{
+    return index < LED_SCHED_SLOTS && (led_sched.active[client] & (1UL << index)) != 0;
+}
+
+void led_sched_stats_get(uint32_t *wakeups, uint32_t *serviced)
+{
+    *wakeups = led_sched.wakeups;
+    *serviced = led_sched.serviced;
+}
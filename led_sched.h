@@ -0,0 +1,71 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_SCHED_H_
+#define LED_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_channel.h"
+
+/* users of the scheduler, each has timer slot per endpoint or channel */
+typedef enum
+{
+    LedSchedClient_LEVEL,       /* level transitions, index is endpoint - 1 */
+    LedSchedClient_ON_OFF,      /* timed on and delayed off, index is endpoint - 1 */
+    LedSchedClient_EFFECT,      /* LED effects, index is LedChannel */
+    LedSchedClient_COLOR,       /* color transition of mixed light, index 0 */
+
+    LedSchedClient_MAX
+} LedSchedClient;
+
+/* called from scheduler event when slot deadline expired */
+typedef void (*LedSchedCb)(uint8_t index);
+
+/**
+ * @brief
+ *  Sets callback of the client, called from its module init.
+ */
+void led_sched_register(LedSchedClient client, LedSchedCb cb);
+
+/**
+ * @brief
+ *  Schedules callback of client slot. Deadline within LED_SCHED_MERGE_MS
+ *  before already scheduled one is moved to it, so slots of the same
+ *  transition (in ex. group command) are serviced in one wakeup.
+ *
+ * @param client - scheduler user
+ * @param index - slot of the client
+ * @param delay_ms - time from now
+ */
+void led_sched_set_delay_ms(LedSchedClient client, uint8_t index, uint32_t delay_ms);
+
+void led_sched_set_active(LedSchedClient client, uint8_t index);
+
+void led_sched_set_inactive(LedSchedClient client, uint8_t index);
+
+bool led_sched_is_scheduled(LedSchedClient client, uint8_t index);
+
+/**
+ * @brief
+ *  Returns number of scheduler wakeups and of slot callbacks serviced by
+ *  them since boot.
+ */
+void led_sched_stats_get(uint32_t *wakeups, uint32_t *serviced);
+
+#endif /* LED_SCHED_H_ */
@@ -0,0 +1,173 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "led_transition.h"
+#include "app.h"
+
+/**
+ * @brief
+ *  Returns level of transition in progress with given fractional bits.
+ *  Linear transition is rounded half up from exact product, Q16 fraction
+ *  would lag by more than a tick on long transitions of a few levels.
+ *
+ * @param tr - transition
+ * @param elapsed_ms - time from transition start, below duration
+ * @param bits - fractional bits of returned level
+ */
+static int32_t led_transition_level_frac_get(const LedTransition *tr, uint32_t elapsed_ms, uint8_t bits)
+{
+    int32_t delta = (int32_t)tr->target_level - (int32_t)tr->start_level;
+
+    if (tr->ease == LedEase_LINEAR)
+    {
+        int64_t num = ((int64_t)delta << bits) * elapsed_ms * 2 + tr->duration_ms;
+        int64_t den = (int64_t)tr->duration_ms * 2;
+        int64_t step = num >= 0 ? num / den : -((-num + den - 1) / den);
+
+        return ((int32_t)tr->start_level << bits) + (int32_t)step;
+    }
+
+    uint32_t progress = (uint32_t)(((uint64_t)elapsed_ms << 16) / tr->duration_ms);
+    int32_t level_q16 = ((int32_t)tr->start_level << 16) +
+                        (int32_t)(((int64_t)(delta << 16) * led_ease_apply((LedEase)tr->ease, progress)) >> 16);
+
+    return (level_q16 + (0x8000 >> bits)) >> (16 - bits);
+}
+
+uint8_t led_transition_level_get(const LedTransition *tr, uint32_t elapsed_ms)
+{
+    if (elapsed_ms >= tr->duration_ms)
+    {
+        return tr->target_level;
+    }
+
+    return (uint8_t)led_transition_level_frac_get(tr, elapsed_ms, 0);
+}
+
+uint16_t led_transition_level_q8_get(const LedTransition *tr, uint32_t elapsed_ms)
+{
+    if (elapsed_ms >= tr->duration_ms)
+    {
+        return tr->target_level << 8;
+    }
+
+    return (uint16_t)led_transition_level_frac_get(tr, elapsed_ms, 8);
+}
+
+uint32_t led_transition_level_time_get(const LedTransition *tr, uint8_t level)
+{
+    int32_t delta = (int32_t)tr->target_level - (int32_t)tr->start_level;
+    int32_t dist = (int32_t)level - (int32_t)tr->start_level;
+
+    if (delta < 0)
+    {
+        delta = -delta;
+        dist = -dist;
+    }
+
+    if (dist <= 0 || delta == 0)
+    {
+        return 0;
+    }
+
+    if (tr->ease != LedEase_LINEAR)
+    {
+        /* Q16 distance from start to rounding point of the level */
+        int64_t dist_q16 = tr->target_level > tr->start_level ? ((int64_t)dist << 16) - 0x8000 :
+                                                                ((int64_t)dist << 16) - 0x7FFF;
+        uint32_t value = (uint32_t)((dist_q16 + delta - 1) / delta);
+        uint32_t progress = led_ease_progress_get((LedEase)tr->ease, value);
+
+        return (uint32_t)(((uint64_t)progress * tr->duration_ms + LED_EASE_ONE - 1) >> 16);
+    }
+
+    /* inverse of half up rounding, level going down is reached only past the half */
+    uint64_t num = (uint64_t)tr->duration_ms * (uint64_t)(2 * dist - 1);
+    uint64_t den = (uint64_t)delta * 2;
+
+    return tr->target_level > tr->start_level ? (uint32_t)((num + den - 1) / den) : (uint32_t)(num / den + 1);
+}
+
+uint8_t led_transition_next_output_level_get(const uint16_t *lut, uint8_t level, uint8_t target_level)
+{
+    uint8_t next = level;
+
+    while (next != target_level)
+    {
+        next = target_level > next ? next + 1 : next - 1;
+
+        if (lut == NULL || lut[next] != lut[level])
+        {
+            return next;
+        }
+    }
+
+    /* the rest of transition doesn't change output */
+    return level;
+}
+
+uint32_t led_transition_delay_get(const LedTransition *tr, const uint16_t *lut, uint8_t level,
+                                  uint32_t elapsed_ms)
+{
+    uint32_t left_ms = tr->duration_ms - elapsed_ms;
+    uint8_t next_level = led_transition_next_output_level_get(lut, level, tr->target_level);
+    /* output doesn't change any more, only the end of transition is left */
+    uint32_t next_ms = next_level == level ? tr->duration_ms : led_transition_level_time_get(tr, next_level);
+    uint32_t delay_ms = next_ms > elapsed_ms ? next_ms - elapsed_ms : 0;
+
+    if (delay_ms < LED_TRANSITION_TICK_MIN_MS)
+    {
+        delay_ms = LED_TRANSITION_TICK_MIN_MS;
+    }
+
+    if (delay_ms > left_ms)
+    {
+        delay_ms = left_ms;
+    }
+
+    return delay_ms;
+}
+
+uint32_t led_transition_fine_delay_get(const LedTransition *tr, uint32_t elapsed_ms)
+{
+    uint32_t left_ms = tr->duration_ms - elapsed_ms;
+    uint32_t delta = tr->target_level > tr->start_level ? tr->target_level - tr->start_level :
+                                                          tr->start_level - tr->target_level;
+    /* eased transition moves faster than average in the middle, its steps
+     * are still a few 1/256 of level */
+    uint32_t delay_ms = delta != 0 ? tr->duration_ms / (delta << 8) : left_ms;
+
+    if (delay_ms < LED_TRANSITION_TICK_MIN_MS)
+    {
+        delay_ms = LED_TRANSITION_TICK_MIN_MS;
+    }
+
+    if (delay_ms > left_ms)
+    {
+        delay_ms = left_ms;
+    }
+
+    return delay_ms;
+}
+
+uint32_t led_transition_move_duration_get(uint8_t distance, uint8_t rate)
+{
+    uint32_t duration_ms = ((uint32_t)distance * 1000UL + rate / 2) / rate;
+
+    return duration_ms == 0 ? 1 : duration_ms;
+}
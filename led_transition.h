@@ -0,0 +1,125 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_TRANSITION_H_
+#define LED_TRANSITION_H_
+
+#include "led_ease.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* transition wakes up when its output changes, but not more often than this */
+#define LED_TRANSITION_TICK_MIN_MS  (1000 / APP_LEVEL_MAX_TICK_RATE)
+
+typedef struct
+{
+    uint8_t     start_level;
+    uint8_t     target_level;
+    uint8_t     ease;           /* LedEase */
+    uint32_t    duration_ms;    /* 0 for immediate level change */
+
+} LedTransition;
+
+/**
+ * @brief
+ *  Returns level of transition for the time elapsed from its start, so it
+ *  doesn't depend on tick count. Linear transition is rounded from exact
+ *  product, eased one maps its Q16 progress through easing table first.
+ *
+ * @param tr - transition
+ * @param elapsed_ms - time from transition start
+ * @return level, rounded
+ */
+uint8_t led_transition_level_get(const LedTransition *tr, uint32_t elapsed_ms);
+
+/**
+ * @brief
+ *  Returns level of transition for the time elapsed from its start with 8
+ *  fractional bits, for outputs which can show fraction of level (dithered).
+ *
+ * @param tr - transition
+ * @param elapsed_ms - time from transition start
+ * @return level in Q8.8 format, rounded
+ */
+uint16_t led_transition_level_q8_get(const LedTransition *tr, uint32_t elapsed_ms);
+
+/**
+ * @brief
+ *  Returns time from transition start, when interpolated level is rounded
+ *  to the given level (inverse of led_transition_level_get()). Eased
+ *  transition finds it from inverse of easing table.
+ *
+ * @param tr - transition
+ * @param level - level between start and target level
+ * @return time from transition start in ms
+ */
+uint32_t led_transition_level_time_get(const LedTransition *tr, uint8_t level);
+
+/**
+ * @brief
+ *  Returns the next level towards target which changes PWM output. Levels
+ *  mapped to the same compare value (in ex. bottom of the CIE curve) are
+ *  skipped.
+ *
+ * @param lut - compare values of levels, NULL when output changes with every level
+ * @param level - current level
+ * @param target_level
+ * @return next level, the given level when output doesn't change any more
+ */
+uint8_t led_transition_next_output_level_get(const uint16_t *lut, uint8_t level, uint8_t target_level);
+
+/**
+ * @brief
+ *  Returns time till the next transition tick, when output changes, but
+ *  not shorter than LED_TRANSITION_TICK_MIN_MS. The last tick ends
+ *  transition exactly on time.
+ *
+ * @param tr - transition
+ * @param lut - compare values of levels, NULL when output changes with every level
+ * @param level - level set by this tick
+ * @param elapsed_ms - time of this tick from transition start, below duration
+ * @return delay in ms
+ */
+uint32_t led_transition_delay_get(const LedTransition *tr, const uint16_t *lut, uint8_t level,
+                                  uint32_t elapsed_ms);
+
+/**
+ * @brief
+ *  Returns time till the next transition tick of output with fine levels
+ *  (see led_transition_level_q8_get()), when level changes by 1/256 at
+ *  average rate of transition, but not shorter than LED_TRANSITION_TICK_MIN_MS.
+ *
+ * @param tr - transition
+ * @param elapsed_ms - time of this tick from transition start, below duration
+ * @return delay in ms
+ */
+uint32_t led_transition_fine_delay_get(const LedTransition *tr, uint32_t elapsed_ms);
+
+/**
+ * @brief
+ *  Returns duration of MOVE over given distance at given rate, rounded to
+ *  ms rather than to 1/10 s of ZCL transition time.
+ *
+ * @param distance - levels to move
+ * @param rate - levels per second, not 0
+ * @return duration in ms, at least 1
+ */
+uint32_t led_transition_move_duration_get(uint8_t distance, uint8_t rate);
+
+#endif /* LED_TRANSITION_H_ */
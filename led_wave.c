@@ -0,0 +1,191 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app.h"
+
+#if APP_WAVE_MONITOR
+
+#include "led_wave.h"
+#include "led_channel.h"
+#include "af.h"
+#include "dbg_log.h"
+#include "zigbee_app_framework_event.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* outputs stable for this time close the burst */
+#define LED_WAVE_SETTLE_MS      500
+
+typedef struct
+{
+    uint32_t        duty;
+    uint32_t        changed_ms;
+    LedWaveStats    burst;      /* stats of currently recorded burst */
+    LedWaveStats    last;       /* stats of the last closed burst */
+    bool            valid;
+
+} LedWaveChannel;
+
+typedef struct
+{
+    LedWaveChannel      ch[LedChannel_MAX];
+    sl_zigbee_event_t   settle_event;
+    bool                initialized;
+
+} LedWaveModule;
+
+static LedWaveModule led_wave;
+
+/**
+ * @brief
+ *  Computes flicker of duty seen over consecutive PWM periods. Fractional
+ *  compare value is dithered, so periods alternate between n and n + 1
+ *  counts. For fraction f of periods with n + 1 counts percent flicker is
+ *  1 / (2n + 1) and flicker index is f(1 - f) / (n + f). Undithered output
+ *  has the same duty in every period.
+ */
+static void led_wave_flicker_get(LedChannel ch, uint32_t duty, uint16_t *pct, uint16_t *idx)
+{
+    uint32_t period = led_channel_resolution_get(ch);
+    uint32_t on_q8 = (uint32_t)(((uint64_t)duty * period + 0x80) >> 8);
+    uint32_t n = on_q8 >> 8;
+    uint32_t f = on_q8 & 0xFF;
+
+    if (f == 0)
+    {
+        *pct = 0;
+        *idx = 0;
+        return;
+    }
+
+    *pct = (uint16_t)(1000 / (2 * n + 1));
+    *idx = (uint16_t)((1000 * f * (256 - f)) / (256 * (256 * n + f)));
+}
+
+static void led_wave_settle_event_cb(sl_zigbee_event_t *event)
+{
+    for (LedChannel ch = 0; ch < LedChannel_MAX; ch++)
+    {
+        LedWaveChannel *c = &led_wave.ch[ch];
+
+        if (c->burst.updates == 0)
+        {
+            continue;
+        }
+
+        c->last = c->burst;
+        c->valid = true;
+        memset(&c->burst, 0, sizeof(c->burst));
+
+        DBG_LOG("Channel %d: %d updates, min %d ms, step %d (%d rel), flicker %d, index %d [1/1000]",
+                ch, c->last.updates, c->last.min_interval_ms, c->last.step_max,
+                c->last.rel_step_max, c->last.flicker_pct_max, c->last.flicker_idx_max);
+    }
+}
+
+void led_wave_init(void)
+{
+    for (LedChannel ch = 0; ch < LedChannel_MAX; ch++)
+    {
+        led_wave.ch[ch].duty = led_channel_duty_get(ch);
+    }
+
+    sl_zigbee_event_init(&led_wave.settle_event, led_wave_settle_event_cb);
+    led_wave.initialized = true;
+}
+
+void led_wave_duty_update(LedChannel ch, uint32_t duty)
+{
+    if (led_wave.initialized == false || ch >= LedChannel_MAX)
+    {
+        return;
+    }
+
+    LedWaveChannel *c = &led_wave.ch[ch];
+    LedWaveStats *s = &c->burst;
+    uint32_t now = halCommonGetInt32uMillisecondTick();
+
+    if (duty == c->duty)
+    {
+        return;
+    }
+
+    uint32_t step = duty > c->duty ? duty - c->duty : c->duty - duty;
+    uint32_t brighter = duty > c->duty ? duty : c->duty;
+    uint16_t step_pm = (uint16_t)((step * 1000ULL) / LED_CHANNEL_DUTY_ONE);
+    uint16_t rel_step_pm = (uint16_t)((step * 1000ULL) / brighter);
+    uint16_t pct, idx;
+
+    /* the first change of burst has no previous one to measure from */
+    if (s->updates == 1 || (s->updates > 1 && now - c->changed_ms < s->min_interval_ms))
+    {
+        s->min_interval_ms = now - c->changed_ms;
+    }
+
+    /* switching from or to dark is not a discontinuity of transition */
+    if (duty != 0 && c->duty != 0)
+    {
+        if (step_pm > s->step_max)
+        {
+            s->step_max = step_pm;
+        }
+
+        if (rel_step_pm > s->rel_step_max)
+        {
+            s->rel_step_max = rel_step_pm;
+        }
+    }
+
+    led_wave_flicker_get(ch, duty, &pct, &idx);
+
+    if (pct > s->flicker_pct_max)
+    {
+        s->flicker_pct_max = pct;
+    }
+
+    if (idx > s->flicker_idx_max)
+    {
+        s->flicker_idx_max = idx;
+    }
+
+    if (s->updates < UINT16_MAX)
+    {
+        s->updates++;
+    }
+
+    c->duty = duty;
+    c->changed_ms = now;
+
+    sl_zigbee_event_set_delay_ms(&led_wave.settle_event, LED_WAVE_SETTLE_MS);
+}
+
+bool led_wave_stats_get(LedChannel ch, LedWaveStats *stats)
+{
+    if (ch >= LedChannel_MAX || led_wave.ch[ch].valid == false)
+    {
+        return false;
+    }
+
+    *stats = led_wave.ch[ch].last;
+
+    return true;
+}
+
+#endif /* APP_WAVE_MONITOR */
@@ -0,0 +1,59 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LED_WAVE_H_
+#define LED_WAVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_channel.h"
+
+/* output quality of the channel over one burst of output changes (transition
+ * or effect), all ratios are in 1/1000 */
+typedef struct
+{
+    uint16_t    updates;            /* output changes in burst */
+    uint32_t    min_interval_ms;    /* shortest time between two changes */
+    uint16_t    step_max;           /* largest duty step of full scale */
+    uint16_t    rel_step_max;       /* largest duty step of brighter of two outputs */
+    uint16_t    flicker_pct_max;    /* percent flicker of per period duty */
+    uint16_t    flicker_idx_max;    /* flicker index of per period duty */
+
+} LedWaveStats;
+
+void led_wave_init(void);
+
+/**
+ * @brief
+ *  Records output change of the channel. Burst is closed when outputs are
+ *  stable for LED_WAVE_SETTLE_MS, its stats are logged in DEBUG builds.
+ *
+ * @param ch - PWM channel
+ * @param duty - new duty cycle (LED_CHANNEL_DUTY_ONE - always on)
+ */
+void led_wave_duty_update(LedChannel ch, uint32_t duty);
+
+/**
+ * @brief
+ *  Returns stats of the last closed burst of the channel.
+ *
+ * @return false when channel had no output changes yet
+ */
+bool led_wave_stats_get(LedChannel ch, LedWaveStats *stats);
+
+#endif /* LED_WAVE_H_ */
@@ -19,31 +19,49 @@
 #include "level_extension.h"
 #include "af.h"
 #include "app.h"
+#include "sl_component_catalog.h"
+#if defined(SL_CATALOG_ZIGBEE_REPORTING_PRESENT)
+#include "reporting.h"
+#endif
 #include "sl_custom_token_header.h"
 #include "zigbee_app_framework_event.h"
 #include "led_channel.h"
+#include "led_light.h"
 #include "on_off_extension.h"
+#include "led_sched.h"
+#include "led_ease.h"
+#include "led_transition.h"
+#if APP_DMA_TRANSITIONS
+#include "led_fade.h"
+#endif
 
 #include "dbg_log.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 
-#define LEVEL_STEP_PER_SEC  (20)
+/* level is stored in NVM when burst of commands settles for this time */
+#define LEVEL_SAVE_DELAY_MS       3000
+
+/* command of a burst arriving this late after the previous transition ended
+ * (radio jitter) still continues the burst */
+#define LEVEL_BURST_GAP_MS        100
 
 typedef struct
 {
-  sl_zigbee_event_t   transition_event;
   uint8_t             saved_level;
   uint8_t             current_level;
-  uint8_t             target_level;
-  int16_t             transition_step       : 10;
+  LedTransition       tr;                           /* levels, duration and easing of transition */
+  uint32_t            start_ms;                     /* time transition was started */
+  uint16_t            ticks;                        /* transition events, for DEBUG stats */
   bool                with_on_off           : 1;    /* true when command version is WITH_ON_OFF */
   bool                is_direction_up       : 1;    /* true when transition is UP */
   bool                trigerred_by_onoff    : 1;    /* true when triggered by OnOff cluster */
   bool                disable_light_effect  : 1;    /* do only transition without updating PWM output */
   bool                init                  : 1;    /* true on first level_extension_on_level_updated() call */
   bool                with_attribute_update : 1;    /* true will update level attributes when doing transition */
+  bool                with_easing           : 1;    /* false for constant rate MOVE, always linear */
+  bool                retargetable          : 1;    /* started by STEP or MOVE_TO_LEVEL, next one of a burst is retargeted */
 
 } TransitionCtx;
 
@@ -56,6 +74,39 @@ typedef enum
 } LevelCmdRunMode;
 
 static TransitionCtx tr_ctx[APP_EP_COUNT];
+static sl_zigbee_event_t level_save_event;
+static uint32_t level_save_mask;
+
+static bool level_extension_transition_is_active(uint8_t ep_id)
+{
+#if APP_DMA_TRANSITIONS
+  if (led_fade_is_active(ep_id - 1))
+  {
+    return true;
+  }
+#endif
+  return led_sched_is_scheduled(LedSchedClient_LEVEL, ep_id - 1);
+}
+
+/**
+ * @brief
+ *  Returns RemainingTime of the endpoint in 1/10 s, computed from transition
+ *  start and duration. Transitions triggered by OnOff cluster don't report it.
+ */
+static uint16_t level_extension_remaining_time_get(uint8_t ep_id)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+  uint32_t elapsed_ms = halCommonGetInt32uMillisecondTick() - ctx->start_ms;
+
+  if (ctx->with_attribute_update == false ||
+      level_extension_transition_is_active(ep_id) == false ||
+      elapsed_ms >= ctx->tr.duration_ms)
+  {
+    return 0;
+  }
+
+  return (uint16_t)((ctx->tr.duration_ms - elapsed_ms + 99) / 100);
+}
 
 EmberAfStatus emberAfExternalAttributeWriteCallback(int8u endpoint,
                                                          EmberAfClusterId clusterId,
@@ -71,6 +122,13 @@ EmberAfStatus emberAfExternalAttributeWriteCallback(int8u endpoint,
       return EMBER_ZCL_STATUS_SUCCESS;
     }
 
+    /* computed from transition state on read */
+    if (clusterId == ZCL_LEVEL_CONTROL_CLUSTER_ID &&
+        attributeMetadata->attributeId == ZCL_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE_ID)
+    {
+      return EMBER_ZCL_STATUS_SUCCESS;
+    }
+
     return EMBER_ZCL_STATUS_FAILURE;
 }
 
@@ -87,6 +145,13 @@ EmberAfStatus emberAfExternalAttributeReadCallback(int8u endpoint,
         TransitionCtx* ctx = &tr_ctx[endpoint - 1];
         uint8_t *level = (uint8_t*)buffer;
 
+        /* level isn't written on every tick, so exact one is computed */
+        if (ctx->with_attribute_update && level_extension_transition_is_active(endpoint))
+        {
+            *level = led_transition_level_get(&ctx->tr, halCommonGetInt32uMillisecondTick() - ctx->start_ms);
+            return EMBER_ZCL_STATUS_SUCCESS;
+        }
+
         *level = ctx->current_level;
 
         if (*level < EMBER_AF_PLUGIN_LEVEL_CONTROL_MINIMUM_LEVEL ||
@@ -107,21 +172,62 @@ EmberAfStatus emberAfExternalAttributeReadCallback(int8u endpoint,
         return EMBER_ZCL_STATUS_SUCCESS;
     }
 
+    if (clusterId == ZCL_LEVEL_CONTROL_CLUSTER_ID &&
+        attributeMetadata->attributeId == ZCL_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE_ID)
+    {
+        uint16_t time_remaining = level_extension_remaining_time_get(endpoint);
+
+        buffer[0] = (uint8_t)time_remaining;
+        buffer[1] = (uint8_t)(time_remaining >> 8);
+
+        return EMBER_ZCL_STATUS_SUCCESS;
+    }
+
     return EMBER_ZCL_STATUS_FAILURE;
 }
 
+static void level_extension_save_event_cb(sl_zigbee_event_t *event)
+{
+  for (uint8_t i = 0; i < APP_EP_COUNT; i++)
+  {
+    if ((level_save_mask & (1 << i)) == 0)
+    {
+      continue;
+    }
+
+    uint8_t stored_level;
+
+    halCommonGetIndexedToken(&stored_level, TOKEN_CURRENT_LEVEL, i);
+
+    /* burst can end at the level it started from */
+    if (stored_level != tr_ctx[i].saved_level)
+    {
+      DBG_LOG("Saving current level %d for ep %d", tr_ctx[i].saved_level, i + 1);
+      halCommonSetIndexedToken(TOKEN_CURRENT_LEVEL, i, &tr_ctx[i].saved_level);
+    }
+  }
+
+  level_save_mask = 0;
+}
+
+/**
+ * @brief
+ *  Takes current level as saved one. NVM write is deferred until commands
+ *  stop for LEVEL_SAVE_DELAY_MS, so burst of Step or Move/Stop commands
+ *  sent while remote button is held writes token once.
+ */
 void level_extension_current_level_save(uint8_t endpoint)
 {
   TransitionCtx* ctx = &tr_ctx[endpoint - 1];
   if (ctx->saved_level != ctx->current_level)
   {
-      DBG_LOG("Saving current level %d for ep %d", ctx->current_level, endpoint);
-      halCommonSetIndexedToken(TOKEN_CURRENT_LEVEL, endpoint - 1, &ctx->current_level);
       ctx->saved_level = ctx->current_level;
+      level_save_mask |= (1 << (endpoint - 1));
+      sl_zigbee_event_set_delay_ms(&level_save_event, LEVEL_SAVE_DELAY_MS);
   }
 }
 
-static void level_extension_on_level_updated(uint8_t ep_id, uint8_t level_value, bool done)
+static void level_extension_on_level_updated(uint8_t ep_id, uint16_t level_q8, bool done)
 {
   TransitionCtx* ctx = &tr_ctx[ep_id - 1];
 
@@ -129,7 +235,7 @@ static void level_extension_on_level_updated(uint8_t ep_id, uint8_t level_value,
   {
     if (done && ctx->is_direction_up == false)
     {
-      level_value = 0;
+      level_q8 = 0;
     }
   }
   else
@@ -147,7 +253,7 @@ static void level_extension_on_level_updated(uint8_t ep_id, uint8_t level_value,
     {
       if (done && ctx->with_on_off)
       {
-        level_value = 0;
+        level_q8 = 0;
         emberAfOnOffClusterSetValueCallback(ep_id,
                                             ZCL_OFF_COMMAND_ID,
                                             true);
@@ -156,41 +262,256 @@ static void level_extension_on_level_updated(uint8_t ep_id, uint8_t level_value,
   }
 
   ctx->init = false;
-  led_channel_zcl_level_set(ep_id - 1, level_value);
+
+  /* endpoints stepping in the same tick (in ex. group command) are committed together,
+   * fraction of level is kept for dithered output */
+  led_light_level_fine_stage(ep_id, level_q8);
 }
 
-void level_extension_do_transition(uint8_t ep_id, uint8_t target_level,
-                                   uint16_t transition_time, bool with_attribute_update,
-                                   bool with_onoff)
+static void level_extension_transition_update(uint8_t ep_id, uint16_t level_q8, bool done)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+
+  level_extension_on_level_updated(ep_id, level_q8, done);
+
+#if defined(SL_CATALOG_ZIGBEE_REPORTING_PRESENT)
+  /* CurrentLevel and RemainingTime are external attributes served from
+   * transition state, only reporting is told about level change */
+  if (ctx->with_attribute_update)
+  {
+    emberAfReportingAttributeChangeCallback(ep_id,
+                                            ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                                            ZCL_CURRENT_LEVEL_ATTRIBUTE_ID,
+                                            CLUSTER_MASK_SERVER,
+                                            EMBER_AF_NULL_MANUFACTURER_CODE,
+                                            ZCL_INT8U_ATTRIBUTE_TYPE,
+                                            &ctx->current_level);
+  }
+#endif
+
+  if (done)
+  {
+    if (!ctx->with_attribute_update)
+    {
+      //restore level
+      ctx->current_level = ctx->saved_level;
+    }
+    else
+    {
+      level_extension_current_level_save(ep_id);
+    }
+  }
+}
+
+#if APP_DMA_TRANSITIONS
+static void level_extension_dma_transition_done(LedChannel ch)
+{
+  TransitionCtx* ctx = &tr_ctx[ch];
+
+  ctx->current_level = ctx->tr.target_level;
+  level_extension_transition_update(ch + 1, ctx->current_level << 8, true);
+}
+
+/**
+ * @brief
+ *  Starts transition streamed to PWM by LDMA. CPU is woken only at the end
+ *  of transition to update attributes.
+ *
+ * @param ep_id
+ * @return true when transition is handled by LDMA
+ */
+static bool level_extension_dma_transition_start(uint8_t ep_id)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+
+  if (ctx->tr.duration_ms == 0 ||
+      ctx->current_level == ctx->tr.target_level ||
+      ctx->tr.ease != LedEase_LINEAR ||
+      led_light_is_mixed(ep_id))
+  {
+    return false;
+  }
+
+  /* first update is done by CPU, as it can switch the light on */
+  level_extension_on_level_updated(ep_id, ctx->current_level << 8, false);
+
+  if (led_fade_start(ep_id - 1, ctx->current_level, ctx->tr.target_level,
+                     ctx->tr.duration_ms, level_extension_dma_transition_done) == false)
+  {
+    return false;
+  }
+
+  return true;
+}
+#endif
+
+/**
+ * @brief
+ *  Stops LDMA transition in progress and takes the level it reached as current
+ *  level, the same way as event driven transition keeps it updated on every step.
+ *
+ * @param ep_id
+ */
+static void level_extension_dma_transition_sync(uint8_t ep_id)
+{
+#if APP_DMA_TRANSITIONS
+  if (led_fade_is_active(ep_id - 1))
+  {
+    TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+
+    ctx->current_level = led_fade_stop(ep_id - 1);
+    led_channel_zcl_level_set(ep_id - 1, ctx->current_level);
+  }
+#else
+  (void)ep_id;
+#endif
+}
+
+/**
+ * @brief
+ *  Stops any transition in progress. Level isn't written on every tick, so
+ *  level reached at this moment is taken from interpolation.
+ *
+ * @param ep_id
+ */
+static void level_extension_transition_sync(uint8_t ep_id)
+{
+  if (led_sched_is_scheduled(LedSchedClient_LEVEL, ep_id - 1))
+  {
+    TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+
+    led_sched_set_inactive(LedSchedClient_LEVEL, ep_id - 1);
+    ctx->current_level = led_transition_level_get(&ctx->tr, halCommonGetInt32uMillisecondTick() - ctx->start_ms);
+    led_channel_zcl_level_set(ep_id - 1, ctx->current_level);
+  }
+
+  level_extension_dma_transition_sync(ep_id);
+}
+
+static void level_extension_transition_start(uint8_t ep_id, uint8_t target_level,
+                                             uint32_t duration_ms, LedEase ease,
+                                             bool with_attribute_update, bool with_onoff)
 {
   TransitionCtx* ctx = &tr_ctx[ep_id - 1];
 
   /* disable previous transition if in progress */
-  sl_zigbee_event_set_inactive(&ctx->transition_event);
+  level_extension_transition_sync(ep_id);
 
-  ctx->target_level = target_level;
+  ctx->tr.target_level = target_level;
   ctx->with_attribute_update = with_attribute_update;
   ctx->with_on_off = with_onoff;
   ctx->init = true;
 
-  if (transition_time == 0xFFFF ||
-      transition_time == 0x0000)
+  ctx->tr.start_level = ctx->current_level;
+  ctx->start_ms = halCommonGetInt32uMillisecondTick();
+  ctx->ticks = 0;
+  ctx->tr.ease = ease;
+  ctx->tr.duration_ms = duration_ms;
+
+  DBG_LOG("DO_TRANSITION: %d - > %d in %d [ms], ease %d", ctx->current_level, target_level,
+          ctx->tr.duration_ms, ctx->tr.ease);
+
+#if APP_DMA_TRANSITIONS
+  if (level_extension_dma_transition_start(ep_id))
   {
-    ctx->transition_step = (target_level - ctx->current_level);
+    return;
   }
-  else
+#endif
+
+  led_sched_set_active(LedSchedClient_LEVEL, ep_id - 1);
+}
+
+void level_extension_do_transition(uint8_t ep_id, uint8_t target_level,
+                                   uint16_t transition_time, bool with_attribute_update,
+                                   bool with_onoff)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+
+  level_extension_transition_start(ep_id, target_level,
+                                   transition_time == 0xFFFF ? 0 : transition_time * 100UL,
+                                   ctx->with_easing ? led_ease_get(ep_id) : LedEase_LINEAR,
+                                   with_attribute_update, with_onoff);
+}
+
+/**
+ * @brief
+ *  Returns velocity of transition in progress in Q16 levels per ms, taken
+ *  from slope of its easing at elapsed time.
+ */
+static uint32_t level_extension_velocity_get(uint8_t ep_id)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+  uint32_t elapsed_ms = halCommonGetInt32uMillisecondTick() - ctx->start_ms;
+
+  if (level_extension_transition_is_active(ep_id) == false ||
+      ctx->tr.duration_ms == 0 ||
+      elapsed_ms >= ctx->tr.duration_ms)
   {
-    float tmp = (transition_time * 100.0f * LEVEL_STEP_PER_SEC) / 1000.0f;
-    ctx->transition_step = (int16_t)((target_level - ctx->current_level) / tmp + 0.5f);
+    return 0;
+  }
 
-    if (ctx->transition_step == 0)
-    {
-      ctx->transition_step = (target_level - ctx->current_level);
-    }
+  uint32_t delta = ctx->tr.target_level > ctx->tr.start_level ? ctx->tr.target_level - ctx->tr.start_level :
+                                                                ctx->tr.start_level - ctx->tr.target_level;
+  uint32_t progress = (uint32_t)(((uint64_t)elapsed_ms << 16) / ctx->tr.duration_ms);
+
+  return (uint32_t)(((uint64_t)delta * led_ease_slope_get((LedEase)ctx->tr.ease, progress)) / ctx->tr.duration_ms);
+}
+
+/**
+ * @brief
+ *  Returns true when retargetable transition ended not longer than
+ *  LEVEL_BURST_GAP_MS ago, so command arriving now continues its burst.
+ */
+static bool level_extension_burst_gap_is_short(uint8_t ep_id)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+  uint32_t elapsed_ms = halCommonGetInt32uMillisecondTick() - ctx->start_ms;
+
+  return ctx->retargetable &&
+         elapsed_ms >= ctx->tr.duration_ms &&
+         elapsed_ms - ctx->tr.duration_ms <= LEVEL_BURST_GAP_MS;
+}
+
+/**
+ * @brief
+ *  Returns easing of transition continuing a burst. Eased one doesn't speed
+ *  up from zero velocity again, but slows down with quadratic ease-out.
+ */
+static LedEase level_extension_burst_ease_get(uint8_t ep_id)
+{
+  return tr_ctx[ep_id - 1].tr.ease == LedEase_LINEAR ? LedEase_LINEAR : LedEase_QUADRATIC_OUT;
+}
+
+/**
+ * @brief
+ *  Moves transition in progress to the new target, keeping its velocity.
+ *  Linear transition goes on at the same velocity, eased one slows down
+ *  from it with quadratic ease-out, so the burst ends softly.
+ *
+ * @param ep_id
+ * @param target_level
+ * @param velocity - velocity of interrupted transition, Q16 levels per ms
+ * @param max_ms - the longest duration of retargeted transition
+ * @param with_onoff
+ */
+static void level_extension_retarget(uint8_t ep_id, uint8_t target_level, uint32_t velocity,
+                                     uint32_t max_ms, bool with_onoff)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+  LedEase ease = level_extension_burst_ease_get(ep_id);
+  uint32_t distance = target_level > ctx->current_level ? target_level - ctx->current_level :
+                                                          ctx->current_level - target_level;
+  /* ease-out starts at double of its average velocity */
+  uint64_t duration_ms = (((uint64_t)distance << 16) * (ease == LedEase_LINEAR ? 1 : 2)) / velocity;
+
+  if (duration_ms > max_ms)
+  {
+    duration_ms = max_ms;
   }
 
-  DBG_LOG("DO_TRANSITION: %d - > %d, step %d", ctx->current_level, target_level, ctx->transition_step);
-  sl_zigbee_event_set_active(&ctx->transition_event);
+  DBG_LOG("RETARGET(%d): %d -> %d in %d [ms]", ep_id, ctx->current_level, target_level, (uint32_t)duration_ms);
+
+  level_extension_transition_start(ep_id, target_level, (uint32_t)duration_ms, ease, true, with_onoff);
 }
 
 static LevelCmdRunMode level_extension_can_execute_cmd(uint8_t ep_id, uint8_t options, bool with_on_off)
@@ -215,9 +536,11 @@ static LevelCmdRunMode level_extension_can_execute_cmd(uint8_t ep_id, uint8_t op
   return LevelCmdRunMode_EXECUTE;
 }
 
-static void level_extension_channel_event_cb(uint8_t ep_id)
+static void level_extension_channel_event_cb(uint8_t index)
 {
-  if (ep_id > APP_EP_COUNT || ep_id == 0)
+  uint8_t ep_id = index + 1;
+
+  if (ep_id > APP_EP_COUNT)
   {
       DBG_LOG("Invalid endpoint ID: %d", ep_id);
       return;
@@ -225,108 +548,32 @@ static void level_extension_channel_event_cb(uint8_t ep_id)
 
   TransitionCtx* ctx = &tr_ctx[ep_id - 1];
 
-  int16_t new_level = ctx->current_level + ctx->transition_step;
+  uint32_t elapsed_ms = halCommonGetInt32uMillisecondTick() - ctx->start_ms;
 
-  if (ctx->transition_step < 0)
-  {
-    /* move down*/
-    if (new_level <= ctx->target_level)
-    {
-      ctx->current_level = ctx->target_level;
-    }
-    else
-    {
-      ctx->current_level = (uint8_t)new_level;
-    }
-  }
-  else
-  {
-    if (new_level >= ctx->target_level)
-    {
-      ctx->current_level = ctx->target_level;
-    }
-    else
-    {
-      ctx->current_level = (uint8_t)new_level;
-    }
-  }
-
-  bool done = ctx->current_level == ctx->target_level;
-  level_extension_on_level_updated(ep_id, ctx->current_level,
-                                   done);
-
-  if (ctx->with_attribute_update)
-  {
-    EmberAfStatus status = emberAfWriteServerAttribute (ep_id,
-                                          ZCL_LEVEL_CONTROL_CLUSTER_ID,
-                                          ZCL_CURRENT_LEVEL_ATTRIBUTE_ID,
-                                          &ctx->current_level,
-                                          ZCL_INT8U_ATTRIBUTE_TYPE);
-    if (status != EMBER_ZCL_STATUS_SUCCESS)
-    {
-      DBG_LOG("ERR: unable to set current level %x", status);
-    }
+  ctx->current_level = led_transition_level_get(&ctx->tr, elapsed_ms);
 
-#if defined(ZCL_USING_LEVEL_CONTROL_CLUSTER_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE)
-    do {
-
-      uint16_t time_remaining = 0;
-      if (!done)
-      {
-         status = emberAfReadAttribute(ep_id,
-                                        ZCL_LEVEL_CONTROL_CLUSTER_ID,
-                                        ZCL_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE_ID,
-                                        CLUSTER_MASK_SERVER,
-                                        (uint8_t *)&time_remaining,
-                                        sizeof(time_remaining),
-                                        NULL); // data type
+  /* rounded level can reach target before transition time elapsed */
+  bool done = elapsed_ms >= ctx->tr.duration_ms || ctx->tr.start_level == ctx->tr.target_level;
+  bool dithered = led_channel_is_dithered(ep_id - 1);
+  level_extension_transition_update(ep_id,
+                                    dithered ? led_transition_level_q8_get(&ctx->tr, elapsed_ms) :
+                                               ctx->current_level << 8,
+                                    done);
 
-        if (status != EMBER_ZCL_STATUS_SUCCESS)
-        {
-            DBG_LOG("Can't read REMAINING TIME attribute! Status %x, ep %d", status, ep_id);
-            break;
-        }
+  ctx->ticks++;
 
-        int32_t time_ms = time_remaining * 100 - (1000 / LEVEL_STEP_PER_SEC);
-        if (time_ms < 0)
-        {
-          time_remaining = 0;
-        }
-        else
-        {
-          time_remaining = time_ms / 100;
-        }
-      }
-
-      status = emberAfWriteServerAttribute (ep_id,
-                                            ZCL_LEVEL_CONTROL_CLUSTER_ID,
-                                            ZCL_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE_ID,
-                                            (uint8_t*) &time_remaining,
-                                            ZCL_INT16U_ATTRIBUTE_TYPE);
-      if (status != EMBER_ZCL_STATUS_SUCCESS)
-      {
-        DBG_LOG("ERR: unable to set REMAINING TIME %x", status);
-      }
-    } while(0);
-#endif
-  }
-
-  if (!done)
+  if (done)
   {
-    sl_zigbee_event_set_delay_ms(&ctx->transition_event, (1000 / LEVEL_STEP_PER_SEC));
-  }
-  else
-  {
-    if (!ctx->with_attribute_update)
-    {
-      //restore level
-      ctx->current_level = ctx->saved_level;
-    }
-    else
-    {
-      level_extension_current_level_save(ep_id);
-    }
+    DBG_LOG("Transition of ep %d done in %d ticks", ep_id, ctx->ticks);
+    return;
   }
+
+  const uint16_t *lut = led_light_is_mixed(ep_id) ? NULL : led_channel_lut_get(ep_id - 1);
+  /* dithered output changes with fraction of level too */
+  uint32_t delay_ms = dithered ? led_transition_fine_delay_get(&ctx->tr, elapsed_ms) :
+                                 led_transition_delay_get(&ctx->tr, lut, ctx->current_level, elapsed_ms);
+
+  led_sched_set_delay_ms(LedSchedClient_LEVEL, ep_id - 1, delay_ms);
 }
 
 void level_extension_statup_level_setup(uint8_t ep_id, bool with_on_off)
@@ -354,7 +601,13 @@ void emberAfOnOffClusterLevelControlEffectCallback(int8u ep_id,
 {
   TransitionCtx* ctx = &tr_ctx[ep_id - 1];
   uint16_t transition_time = 0xFFFF;
+  uint8_t target_level = ctx->saved_level;
+#if defined(ZCL_USING_LEVEL_CONTROL_CLUSTER_ON_OFF_TRANSITION_TIME_ATTRIBUTE) || \
+    defined(ZCL_USING_LEVEL_CONTROL_CLUSTER_ON_LEVEL_ATTRIBUTE)
   EmberAfStatus status;
+#endif
+
+  level_extension_transition_sync(ep_id);
 
   // Read the OnOffTransitionTime attribute.
 #ifdef ZCL_USING_LEVEL_CONTROL_CLUSTER_ON_OFF_TRANSITION_TIME_ATTRIBUTE
@@ -391,11 +644,11 @@ void emberAfOnOffClusterLevelControlEffectCallback(int8u ep_id,
   }
 #endif
 
-  uint8_t target_level = ctx->saved_level;
-
   ctx->with_on_off = false;
   ctx->trigerred_by_onoff = true;
   ctx->is_direction_up = (onoff_state != 0);
+  ctx->with_easing = true;
+  ctx->retargetable = false;
 
   DBG_LOG("%s: ep %d, level %d", __FUNCTION__, ep_id, target_level);
 
@@ -419,6 +672,33 @@ void emberAfOnOffClusterLevelControlEffectCallback(int8u ep_id,
   }
 }
 
+/**
+ * @brief
+ *  Restores level of the light which was on before power loss. Stored level
+ *  is staged at once, without OnOffTransitionTime fade, so light is back as
+ *  soon as staged levels are committed.
+ * @param ep_id
+ */
+void level_extension_power_on_restore(uint8_t ep_id)
+{
+  TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+
+  led_sched_set_inactive(LedSchedClient_LEVEL, ep_id - 1);
+
+  ctx->current_level = ctx->saved_level;
+  ctx->tr.target_level = ctx->saved_level;
+  ctx->tr.start_level = ctx->saved_level;
+  ctx->tr.duration_ms = 0;
+  ctx->with_attribute_update = false;
+  ctx->with_on_off = false;
+  ctx->trigerred_by_onoff = true;
+  ctx->is_direction_up = true;
+
+  DBG_LOG("POWER_ON_RESTORE: ep %d, level %d", ep_id, ctx->current_level);
+
+  level_extension_on_level_updated(ep_id, ctx->current_level << 8, true);
+}
+
 /**
  * @brief
  *  MOVE_TO_LEVEL ZCL command handler
@@ -462,12 +742,32 @@ bool level_extension_handle_move_to_level(uint8_t ep_id, uint8_t level, uint16_t
           ep_id, level, transition_time * 100);
 
   TransitionCtx* ctx = &tr_ctx[ep_id - 1];
+  bool burst = ctx->retargetable && transition_time != 0x0000 && transition_time != 0xFFFF &&
+               (level_extension_velocity_get(ep_id) != 0 || level_extension_burst_gap_is_short(ep_id));
+
+  level_extension_transition_sync(ep_id);
 
   level_extension_statup_level_setup(ep_id, with_on_off);
 
+  /* command of a burst (slider or held button) in the same direction goes on
+   * without stopping the light, transition time is kept as ZCL requires, but
+   * eased transition eases out instead of starting from zero velocity again */
+  bool retarget = burst && ctx->is_direction_up == (level > ctx->current_level);
+
   ctx->trigerred_by_onoff = false;
   ctx->is_direction_up = level > ctx->current_level;
   ctx->disable_light_effect = (exec == LevelCmdRunMode_EXECUTE_NO_EFFECT);
+  ctx->with_easing = true;
+  ctx->retargetable = true;
+
+  if (retarget)
+  {
+    DBG_LOG("RETARGET(%d): %d -> %d in %d [ms]", ep_id, ctx->current_level, level, transition_time * 100);
+    level_extension_transition_start(ep_id, level, transition_time * 100UL,
+                                     level_extension_burst_ease_get(ep_id), true, with_on_off);
+    return true;
+  }
+
   level_extension_do_transition(ep_id, level, transition_time, true, with_on_off);
 
   return true;
@@ -496,6 +796,8 @@ bool level_extension_handle_move_level(uint8_t ep_id, EmberAfMoveMode mode, uint
   uint8_t move_diff;
   uint8_t level;
 
+  level_extension_transition_sync(ep_id);
+
   if (mode == EMBER_ZCL_MOVE_MODE_UP)
   {
     move_diff = EMBER_AF_PLUGIN_LEVEL_CONTROL_MAXIMUM_LEVEL - ctx->current_level;
@@ -512,8 +814,6 @@ bool level_extension_handle_move_level(uint8_t ep_id, EmberAfMoveMode mode, uint
     return true;
   }
 
-  uint16_t transition_time = 0;
-
   if (rate == 0xFF || rate == 0x00)
   {
 #ifdef ZCL_USING_LEVEL_CONTROL_CLUSTER_DEFAULT_MOVE_RATE_ATTRIBUTE
@@ -525,41 +825,30 @@ bool level_extension_handle_move_level(uint8_t ep_id, EmberAfMoveMode mode, uint
     if (status != EMBER_ZCL_STATUS_SUCCESS)
     {
       DBG_LOG("ERR: reading default move rate %x", status);
-      transition_time = 1;
-    }
-    else
-    {
-      if (rate == 0xFF || rate == 0x00)
-      {
-        transition_time = 1;
-      }
+      rate = 0;
     }
 #else
-    transition_time = 1;
+    rate = 0;
 #endif
   }
-  else
-  {
-    float time = (float)(move_diff * 10) / (float)(rate);
 
-    transition_time = (uint16_t)(time + 0.5f);
-    if (transition_time == 0)
-    {
-      transition_time = 1;
-    }
-  }
+  /* rate is levels per second, duration is kept in ms, as 1/10 s of
+   * transition time is too coarse for fast moves */
+  uint32_t duration_ms = (rate == 0xFF || rate == 0x00) ? 100 : led_transition_move_duration_get(move_diff, rate);
 
   DBG_LOG("MOVE_LEVEL%s(%d, %s) in %d [ms]", with_on_off ? "_WITH_ONOFF" : "",
           ep_id,
           mode == EMBER_ZCL_MOVE_MODE_UP ? "UP" : "DOWN",
-          transition_time * 100);
+          duration_ms);
 
   level_extension_statup_level_setup(ep_id, with_on_off);
 
   ctx->trigerred_by_onoff = false;
   ctx->is_direction_up = level > ctx->current_level;
   ctx->disable_light_effect = (exec == LevelCmdRunMode_EXECUTE_NO_EFFECT);
-  level_extension_do_transition(ep_id, level, transition_time, true, with_on_off);
+  ctx->with_easing = false;
+  ctx->retargetable = false;
+  level_extension_transition_start(ep_id, level, duration_ms, LedEase_LINEAR, true, with_on_off);
 
   return true;
 }
@@ -583,25 +872,12 @@ bool level_extension_handle_stop(uint8_t ep_id, uint8_t options, bool with_on_of
 
   TransitionCtx* ctx = &tr_ctx[ep_id - 1];
 
-  sl_zigbee_event_set_inactive(&ctx->transition_event);
+  level_extension_transition_sync(ep_id);
 
   DBG_LOG("STOP%s(%d)", with_on_off ? "_WITH_ONOFF" : "", ep_id);
 
   if (ctx->with_attribute_update)
   {
-#if defined(ZCL_USING_LEVEL_CONTROL_CLUSTER_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE)
-      uint16_t time_remaining = 0;
-      EmberAfStatus status = emberAfWriteServerAttribute (ep_id,
-                                            ZCL_LEVEL_CONTROL_CLUSTER_ID,
-                                            ZCL_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE_ID,
-                                            (uint8_t*) &time_remaining,
-                                            ZCL_INT16U_ATTRIBUTE_TYPE);
-      if (status != EMBER_ZCL_STATUS_SUCCESS)
-      {
-        DBG_LOG("ERR: unable to reset REMAINING TIME %x", status);
-      }
-#endif
-
     level_extension_current_level_save(ep_id);
   }
   else
@@ -635,14 +911,39 @@ bool level_extension_handle_step_level(uint8_t ep_id, EmberAfStepMode mode, uint
 
   TransitionCtx* ctx = &tr_ctx[ep_id - 1];
   int16_t new_level = 0;
+  uint8_t base_level = ctx->saved_level;
+  uint32_t velocity = 0;
+  uint32_t max_ms = 0;
+  bool burst = false;
+
+  /* step of a burst (button held) continues from target of the previous one,
+   * without stopping the light in between */
+  if (ctx->retargetable &&
+      ctx->is_direction_up == (mode == EMBER_ZCL_STEP_MODE_UP) &&
+      transition_time != 0x0000 && transition_time != 0xFFFF)
+  {
+    velocity = level_extension_velocity_get(ep_id);
+    /* not slower than finishing the previous step and doing this one */
+    max_ms = (level_extension_remaining_time_get(ep_id) + transition_time) * 100UL;
+    burst = velocity != 0 || level_extension_burst_gap_is_short(ep_id);
+  }
+
+  if (velocity != 0)
+  {
+    base_level = ctx->tr.target_level;
+  }
+  else
+  {
+    level_extension_transition_sync(ep_id);
+  }
 
   if (mode == EMBER_ZCL_STEP_MODE_UP)
   {
-    new_level = ctx->saved_level + size;
+    new_level = base_level + size;
   }
   else
   {
-    new_level = ctx->saved_level - size;
+    new_level = base_level - size;
   }
 
   if (new_level > EMBER_AF_PLUGIN_LEVEL_CONTROL_MAXIMUM_LEVEL)
@@ -654,12 +955,15 @@ bool level_extension_handle_step_level(uint8_t ep_id, EmberAfStepMode mode, uint
     new_level = EMBER_AF_PLUGIN_LEVEL_CONTROL_MINIMUM_LEVEL;
   }
 
-  if (new_level == ctx->saved_level)
+  if (new_level == base_level)
   {
     /* nothing to do*/
     return true;
   }
 
+  /* retargeted transition is stopped only now, as it goes on when step is ignored */
+  level_extension_transition_sync(ep_id);
+
   DBG_LOG("STEP_LEVEL%s(%d, %s) in %d [ms]", with_on_off ? "_WITH_ONOFF" : "", ep_id,
           mode == EMBER_ZCL_STEP_MODE_UP ? "UP" : "DOWN",
           transition_time * 100);
@@ -669,19 +973,149 @@ bool level_extension_handle_step_level(uint8_t ep_id, EmberAfStepMode mode, uint
   ctx->trigerred_by_onoff = false;
   ctx->is_direction_up = new_level > ctx->current_level;
   ctx->disable_light_effect = (exec == LevelCmdRunMode_EXECUTE_NO_EFFECT);
+  ctx->with_easing = true;
+  ctx->retargetable = true;
+
+  if (velocity != 0)
+  {
+    level_extension_retarget(ep_id, (uint8_t)new_level, velocity, max_ms, with_on_off);
+    return true;
+  }
+
+  if (burst)
+  {
+    /* previous step just ended, this one continues without easing in */
+    level_extension_transition_start(ep_id, (uint8_t)new_level, transition_time * 100UL,
+                                     level_extension_burst_ease_get(ep_id), true, with_on_off);
+    return true;
+  }
+
   level_extension_do_transition(ep_id, (uint8_t)new_level, transition_time, true, with_on_off);
 
   return true;
 }
 
-void level_extension_init(void)
+/**
+ * @brief
+ *  Updates frequency attributes of all endpoints driven by the same TIMER
+ *  as given endpoint.
+ *
+ * @param ep_id
+ * @param with_range - true will update also MinFrequency and MaxFrequency
+ */
+static void level_extension_frequency_attributes_update(uint8_t ep_id, bool with_range)
 {
-  for(int i = 0; i < APP_EP_COUNT; i++)
+#if defined(ZCL_USING_LEVEL_CONTROL_CLUSTER_LEVEL_CONTROL_CURRENT_FREQUENCY_ATTRIBUTE)
+  TIMER_TypeDef *timer = led_channel_pwm_get(ep_id - 1)->timer;
+
+  for (uint8_t i = 0; i < APP_EP_COUNT; i++)
   {
-    TransitionCtx* ctx = &tr_ctx[i];
+    if (led_channel_pwm_get(i)->timer != timer)
+    {
+      continue;
+    }
 
-    sl_zigbee_endpoint_event_init(&ctx->transition_event, level_extension_channel_event_cb, i + 1);
+    uint16_t frequency = (uint16_t)led_channel_frequency_get(i);
+    EmberAfStatus status = emberAfWriteServerAttribute (i + 1,
+                                          ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                                          ZCL_LEVEL_CONTROL_CURRENT_FREQUENCY_ATTRIBUTE_ID,
+                                          (uint8_t*) &frequency,
+                                          ZCL_INT16U_ATTRIBUTE_TYPE);
+    if (status != EMBER_ZCL_STATUS_SUCCESS)
+    {
+      DBG_LOG("ERR: unable to set CURRENT FREQUENCY %x", status);
+    }
+
+#if defined(ZCL_USING_LEVEL_CONTROL_CLUSTER_LEVEL_CONTROL_MIN_FREQUENCY_ATTRIBUTE) && \
+    defined(ZCL_USING_LEVEL_CONTROL_CLUSTER_LEVEL_CONTROL_MAX_FREQUENCY_ATTRIBUTE)
+    if (with_range)
+    {
+      uint32_t min_freq;
+      uint32_t max_freq;
 
+      led_channel_frequency_range_get(i, &min_freq, &max_freq);
+
+      frequency = (uint16_t)min_freq;
+      status = emberAfWriteServerAttribute (i + 1,
+                                            ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                                            ZCL_LEVEL_CONTROL_MIN_FREQUENCY_ATTRIBUTE_ID,
+                                            (uint8_t*) &frequency,
+                                            ZCL_INT16U_ATTRIBUTE_TYPE);
+      if (status != EMBER_ZCL_STATUS_SUCCESS)
+      {
+        DBG_LOG("ERR: unable to set MIN FREQUENCY %x", status);
+      }
+
+      frequency = (uint16_t)max_freq;
+      status = emberAfWriteServerAttribute (i + 1,
+                                            ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                                            ZCL_LEVEL_CONTROL_MAX_FREQUENCY_ATTRIBUTE_ID,
+                                            (uint8_t*) &frequency,
+                                            ZCL_INT16U_ATTRIBUTE_TYPE);
+      if (status != EMBER_ZCL_STATUS_SUCCESS)
+      {
+        DBG_LOG("ERR: unable to set MAX FREQUENCY %x", status);
+      }
+    }
+#endif
+  }
+#else
+  (void)ep_id;
+  (void)with_range;
+#endif
+}
+
+uint32_t level_extension_frequency_set(uint8_t ep_id, uint16_t frequency, uint32_t *resolution)
+{
+  TIMER_TypeDef *timer = led_channel_pwm_get(ep_id - 1)->timer;
+
+  /* LDMA transitions stream values computed for old TIMER TOP */
+  for (uint8_t i = 0; i < APP_EP_COUNT; i++)
+  {
+    if (led_channel_pwm_get(i)->timer == timer)
+    {
+      level_extension_dma_transition_sync(i + 1);
+    }
+  }
+
+  uint32_t frequency_set = led_channel_frequency_set(ep_id - 1, frequency, resolution);
+
+  level_extension_frequency_attributes_update(ep_id, false);
+
+  return frequency_set;
+}
+
+/**
+ * @brief
+ *  MOVE_TO_CLOSEST_FREQUENCY ZCL command handler. Channels sharing the TIMER
+ *  are switched together, their levels are kept. Resulting resolution is
+ *  answered to MFG_LEVEL_SET_FREQUENCY command only, as this one has default
+ *  response.
+ *
+ * @param ep_id
+ * @param frequency - requested PWM frequency in Hz
+ * @return
+ */
+bool level_extension_handle_move_to_closest_frequency(uint8_t ep_id, uint16_t frequency)
+{
+  uint32_t resolution;
+
+  level_extension_frequency_set(ep_id, frequency, &resolution);
+
+  DBG_LOG("MOVE_TO_CLOSEST_FREQUENCY(%d, %d) -> %d [Hz], %d steps", ep_id, frequency,
+          led_channel_frequency_get(ep_id - 1), resolution);
+
+  return true;
+}
+
+void level_extension_init(void)
+{
+  led_sched_register(LedSchedClient_LEVEL, level_extension_channel_event_cb);
+  sl_zigbee_event_init(&level_save_event, level_extension_save_event_cb);
+  led_ease_init();
+
+  for(int i = 0; i < APP_EP_COUNT; i++)
+  {
     uint8_t level = 0xFE;
     EmberAfStatus status = emberAfReadAttribute(i + 1,
                                   ZCL_LEVEL_CONTROL_CLUSTER_ID,
@@ -694,6 +1128,8 @@ void level_extension_init(void)
     {
         DBG_LOG("Can't read CURRENT_LEVEL attribute! Status %x, ep %d", status, i + 1);
     }
+
+    level_extension_frequency_attributes_update(i + 1, true);
   }
 }
 
@@ -837,6 +1273,17 @@ uint32_t level_extension_handle_cmd(sl_service_opcode_t opcode,
         }
         break;
       }
+      case ZCL_MOVE_TO_CLOSEST_FREQUENCY_COMMAND_ID:
+      {
+        if (cmd->payloadStartIndex < cmd->bufLen)
+        {
+          uint8_t* payload = &cmd->buffer[cmd->payloadStartIndex];
+
+          wasHandled = level_extension_handle_move_to_closest_frequency(ep_id,
+                                                                        *(uint16_t*)&payload[0]);
+        }
+        break;
+      }
     }
 
     if (wasHandled == true)
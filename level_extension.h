@@ -37,4 +37,19 @@ void level_extension_do_transition(uint8_t ep_id, uint8_t target_level,
                                    uint16_t transition_time, bool with_attribute_update,
                                    bool with_onoff);
 
+void level_extension_power_on_restore(uint8_t ep_id);
+
+/**
+ * @brief
+ *  Changes PWM frequency of the endpoint channel and of channels sharing its
+ *  TIMER, updates their CurrentFrequency attributes. Higher frequency leaves
+ *  less counts in PWM period, so the resulting resolution is returned too.
+ *
+ * @param ep_id
+ * @param frequency - requested PWM frequency in Hz, clamped to supported range
+ * @param resolution - set to counts in PWM period (dimming steps) at frequency set
+ * @return frequency set in Hz
+ */
+uint32_t level_extension_frequency_set(uint8_t ep_id, uint16_t frequency, uint32_t *resolution);
+
 #endif /* LEVEL_EXTENSION_H_ */
@@ -0,0 +1,253 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mfg_extension.h"
+#include "app.h"
+#include "led_channel.h"
+#include "led_curve.h"
+#include "led_ease.h"
+#include "level_extension.h"
+#if APP_METERING
+#include "led_meter.h"
+#endif
+#include "dbg_log.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+static EmberAfStatus mfg_extension_set_curve(uint8_t ep_id, const uint8_t *payload, uint16_t len)
+{
+    if (len < 2)
+    {
+        return EMBER_ZCL_STATUS_MALFORMED_COMMAND;
+    }
+
+    DBG_LOG("MFG SET_CURVE(%d, %d, %d)", ep_id, payload[0], payload[1]);
+
+    if (led_curve_set(ep_id - 1, (LedCurve)payload[0], payload[1]) == false)
+    {
+        return EMBER_ZCL_STATUS_INVALID_FIELD;
+    }
+
+    led_channel_curve_update(ep_id - 1);
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+static EmberAfStatus mfg_extension_set_custom_curve(uint8_t ep_id, const uint8_t *payload, uint16_t len)
+{
+    uint8_t levels[LED_CURVE_POINTS_MAX];
+    uint16_t values[LED_CURVE_POINTS_MAX];
+
+    if (len < 1 || len < 1 + payload[0] * 3)
+    {
+        return EMBER_ZCL_STATUS_MALFORMED_COMMAND;
+    }
+
+    uint8_t count = payload[0];
+
+    if (count > LED_CURVE_POINTS_MAX)
+    {
+        return EMBER_ZCL_STATUS_INVALID_FIELD;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t *point = &payload[1 + i * 3];
+
+        levels[i] = point[0];
+        values[i] = point[1] | (point[2] << 8);
+    }
+
+    DBG_LOG("MFG SET_CUSTOM_CURVE(%d, %d points)", ep_id, count);
+
+    if (led_curve_custom_set(ep_id - 1, levels, values, count) == false)
+    {
+        return EMBER_ZCL_STATUS_INVALID_FIELD;
+    }
+
+    led_channel_curve_update(ep_id - 1);
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+static EmberAfStatus mfg_extension_set_trim(uint8_t ep_id, const uint8_t *payload, uint16_t len)
+{
+    if (len < 4)
+    {
+        return EMBER_ZCL_STATUS_MALFORMED_COMMAND;
+    }
+
+    uint16_t min = payload[0] | (payload[1] << 8);
+    uint16_t max = payload[2] | (payload[3] << 8);
+
+    DBG_LOG("MFG SET_TRIM(%d, %d, %d)", ep_id, min, max);
+
+    if (led_curve_trim_set(ep_id - 1, min, max) == false)
+    {
+        return EMBER_ZCL_STATUS_INVALID_FIELD;
+    }
+
+    led_channel_curve_update(ep_id - 1);
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+static EmberAfStatus mfg_extension_set_easing(uint8_t ep_id, const uint8_t *payload, uint16_t len)
+{
+    if (len < 1)
+    {
+        return EMBER_ZCL_STATUS_MALFORMED_COMMAND;
+    }
+
+    DBG_LOG("MFG SET_EASING(%d, %d)", ep_id, payload[0]);
+
+    if (led_ease_set(ep_id, (LedEase)payload[0]) == false)
+    {
+        return EMBER_ZCL_STATUS_INVALID_FIELD;
+    }
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+/**
+ * @brief
+ *  Changes PWM frequency as MoveToClosestFrequency does, but answers with
+ *  frequency set and resolution it leaves (counts in PWM period), so the
+ *  tradeoff is known to the sender.
+ */
+static EmberAfStatus mfg_extension_set_frequency(uint8_t ep_id, const uint8_t *payload, uint16_t len)
+{
+    if (len < 2)
+    {
+        return EMBER_ZCL_STATUS_MALFORMED_COMMAND;
+    }
+
+    uint16_t frequency = payload[0] | (payload[1] << 8);
+    uint32_t resolution;
+
+    if (frequency == 0)
+    {
+        return EMBER_ZCL_STATUS_INVALID_FIELD;
+    }
+
+    uint32_t frequency_set = level_extension_frequency_set(ep_id, frequency, &resolution);
+
+    DBG_LOG("MFG SET_FREQUENCY(%d, %d) -> %d [Hz], %d counts", ep_id, frequency, frequency_set, resolution);
+
+    emberAfFillExternalManufacturerSpecificBuffer((ZCL_CLUSTER_SPECIFIC_COMMAND |
+                                                   ZCL_FRAME_CONTROL_SERVER_TO_CLIENT |
+                                                   ZCL_MANUFACTURER_SPECIFIC_MASK |
+                                                   ZCL_DISABLE_DEFAULT_RESPONSE_MASK),
+                                                  ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                                                  EMBER_AF_MANUFACTURER_CODE,
+                                                  MFG_LEVEL_FREQUENCY_RESPONSE_COMMAND_ID,
+                                                  "vv",
+                                                  (uint16_t)frequency_set,
+                                                  (uint16_t)resolution);
+    emberAfSendResponse();
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+#if APP_METERING
+static EmberAfStatus mfg_extension_set_rated_power(uint8_t ep_id, const uint8_t *payload, uint16_t len)
+{
+    if (len < 2)
+    {
+        return EMBER_ZCL_STATUS_MALFORMED_COMMAND;
+    }
+
+    uint16_t rated_power = payload[0] | (payload[1] << 8);
+
+    DBG_LOG("MFG SET_RATED_POWER(%d, %d)", ep_id, rated_power);
+
+    if (led_meter_rated_power_set(ep_id - 1, rated_power) == false)
+    {
+        return EMBER_ZCL_STATUS_INVALID_FIELD;
+    }
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+#endif
+
+uint32_t mfg_extension_level_handle_cmd(sl_service_opcode_t opcode,
+                                        sl_service_function_context_t *context)
+{
+    EmberAfClusterCommand* cmd = (EmberAfClusterCommand *)context->data;
+    uint8_t ep_id = emberAfCurrentEndpoint();
+    const uint8_t *payload = &cmd->buffer[cmd->payloadStartIndex];
+    uint16_t len = cmd->bufLen - cmd->payloadStartIndex;
+    EmberAfStatus status;
+
+    if (ep_id < 1 || ep_id > APP_EP_COUNT)
+    {
+        return EMBER_ZCL_STATUS_UNSUP_COMMAND;
+    }
+
+    switch(cmd->commandId)
+    {
+        case MFG_LEVEL_SET_CURVE_COMMAND_ID:
+        {
+            status = mfg_extension_set_curve(ep_id, payload, len);
+            break;
+        }
+        case MFG_LEVEL_SET_CUSTOM_CURVE_COMMAND_ID:
+        {
+            status = mfg_extension_set_custom_curve(ep_id, payload, len);
+            break;
+        }
+        case MFG_LEVEL_SET_TRIM_COMMAND_ID:
+        {
+            status = mfg_extension_set_trim(ep_id, payload, len);
+            break;
+        }
+        case MFG_LEVEL_SET_EASING_COMMAND_ID:
+        {
+            status = mfg_extension_set_easing(ep_id, payload, len);
+            break;
+        }
+        case MFG_LEVEL_SET_FREQUENCY_COMMAND_ID:
+        {
+            status = mfg_extension_set_frequency(ep_id, payload, len);
+
+            /* success is answered by FREQUENCY_RESPONSE */
+            if (status == EMBER_ZCL_STATUS_SUCCESS)
+            {
+                return EMBER_ZCL_STATUS_SUCCESS;
+            }
+            break;
+        }
+#if APP_METERING
+        case MFG_LEVEL_SET_RATED_POWER_COMMAND_ID:
+        {
+            status = mfg_extension_set_rated_power(ep_id, payload, len);
+            break;
+        }
+#endif
+        default:
+        {
+            DBG_LOG("Unknown MFG LEVEL command %02x received for ep %02x", cmd->commandId, ep_id);
+            return EMBER_ZCL_STATUS_UNSUP_COMMAND;
+        }
+    }
+
+    emberAfSendImmediateDefaultResponse(status);
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
@@ -0,0 +1,39 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFG_EXTENSION_H_
+#define MFG_EXTENSION_H_
+
+#include "app/framework/include/af.h"
+#include "sl_service_function.h"
+
+/* manufacturer specific commands of Level Control cluster (EMBER_AF_MANUFACTURER_CODE) */
+#define MFG_LEVEL_SET_CURVE_COMMAND_ID          0x00    /* curve (uint8), param (uint8) */
+#define MFG_LEVEL_SET_CUSTOM_CURVE_COMMAND_ID   0x01    /* count (uint8), count * (level (uint8), value (uint16)) */
+#define MFG_LEVEL_SET_TRIM_COMMAND_ID           0x02    /* min (uint16), max (uint16) */
+#define MFG_LEVEL_SET_RATED_POWER_COMMAND_ID    0x03    /* power at full duty in 0.1 W (uint16) */
+#define MFG_LEVEL_SET_EASING_COMMAND_ID         0x04    /* easing of level transitions (uint8) */
+#define MFG_LEVEL_SET_FREQUENCY_COMMAND_ID      0x05    /* PWM frequency in Hz (uint16), answered by FREQUENCY_RESPONSE */
+
+/* manufacturer specific responses of Level Control cluster (server to client) */
+#define MFG_LEVEL_FREQUENCY_RESPONSE_COMMAND_ID 0x05    /* frequency set in Hz (uint16), counts in PWM period (uint16) */
+
+uint32_t mfg_extension_level_handle_cmd(sl_service_opcode_t opcode,
+                                        sl_service_function_context_t *context);
+
+#endif /* MFG_EXTENSION_H_ */
@@ -18,6 +18,8 @@
 
 #include "on_off_extension.h"
 #include "led_channel.h"
+#include "level_extension.h"
+#include "led_sched.h"
 #include "app.h"
 #include "dbg_log.h"
 
@@ -28,7 +30,6 @@
 typedef struct
 {
     OnOffState          state[APP_EP_COUNT];
-    sl_zigbee_event_t   event[APP_EP_COUNT];
     bool                initialized;
 } OnOffCtx;
 
@@ -49,10 +50,12 @@ static void on_off_extension_state_update(uint8_t endpoint, OnOffState new_state
     uint8_t ch = endpoint -1;
     if (ctx.state[ch] != new_state)
     {
+#if defined(DEBUG)
         static const char* state_txt[] = { "OFF", "ON", "TIMED_ON", "TIMED_OFF"};
         DBG_LOG("Channel %d state change: [%s] -> [%s]", ch,
                 state_txt[ctx.state[ch]],
                 state_txt[new_state]);
+#endif
 
         ctx.state[ch] = new_state;
     }
@@ -189,12 +192,14 @@ static void on_off_extension_timed_state_update(uint16_t ep_id, bool dec_time)
 
     if (next_timeout != 0)
     {
-        sl_zigbee_endpoint_event_set_delay_ms(ctx.event, ep_id, next_timeout);
+        led_sched_set_delay_ms(LedSchedClient_ON_OFF, ep_id - 1, next_timeout);
     }
 }
 
-static void on_off_extension_channel_event_cb(uint8_t ep_id)
+static void on_off_extension_channel_event_cb(uint8_t index)
 {
+    uint8_t ep_id = index + 1;
+
     if (ep_id > APP_EP_COUNT)
     {
         DBG_LOG("Invalid endpoint ID: %d", ep_id);
@@ -231,7 +236,7 @@ bool on_off_extension_handle_off(uint8_t ep_id, bool currentValue)
                                   CLUSTER_MASK_SERVER,
                                   (uint8_t*) &time, ZCL_INT16U_ATTRIBUTE_TYPE);
 
-            sl_zigbee_event_set_inactive(&ctx.event[ep_id - 1]);
+            led_sched_set_inactive(LedSchedClient_ON_OFF, ep_id - 1);
 
             on_off_extension_timed_state_update(ep_id, false);
             break;
@@ -262,7 +267,7 @@ bool on_off_extension_handle_on(uint8_t ep_id, bool currentValue)
         {
             uint16_t time = 0;
 
-            sl_zigbee_event_set_inactive(&ctx.event[ep_id - 1]);
+            led_sched_set_inactive(LedSchedClient_ON_OFF, ep_id - 1);
 
             emberAfWriteAttribute(ep_id,
                                   ZCL_ON_OFF_CLUSTER_ID,
@@ -393,6 +398,8 @@ void on_off_attribute_written(uint8_t endpoint, EmberAfAttributeId attributeId,
 
 void on_off_extension_init(void)
 {
+    led_sched_register(LedSchedClient_ON_OFF, on_off_extension_channel_event_cb);
+
     for(int i = 0; i < APP_EP_COUNT; i++)
     {
         uint8_t currentValue = 0;
@@ -406,13 +413,12 @@ void on_off_extension_init(void)
         if (currentValue != 0)
         {
           ctx.state[i] = OnOffState_On;
-          emberAfOnOffClusterLevelControlEffectCallback(i + 1, true);
+          level_extension_power_on_restore(i + 1);
         }
         else
         {
           ctx.state[i] = OnOffState_Off;
         }
-        sl_zigbee_endpoint_event_init(&ctx.event[i], on_off_extension_channel_event_cb, i + 1);
     }
 
     ctx.initialized = true;
@@ -30,6 +30,7 @@
 #include <stddef.h>
 
 #include "sl_pwm_led.h"
+#include "sl_pwm_led_ext.h"
 
 /*
  *  Private functions
@@ -44,7 +45,7 @@ static CMU_Clock_TypeDef pwm_led_get_timer_clock(TIMER_TypeDef *timer)
 #error "Unknown root of clock tree"
 #endif
 
-  switch ((uint32_t)timer) {
+  switch ((uintptr_t)timer) {
 #if defined(TIMER0_BASE)
     case TIMER0_BASE:
       timer_clock = cmuClock_TIMER0;
@@ -141,6 +142,20 @@ void sl_pwm_led_stop(void *led_handler)
 #endif
 }
 
+bool sl_pwm_led_is_started(void *led_handler)
+{
+  sl_led_pwm_t *led = (sl_led_pwm_t *)led_handler;
+#if defined(_TIMER_ROUTE_MASK)
+  return (led->timer->ROUTE & (1 << (led->channel + _TIMER_ROUTE_CC0PEN_SHIFT))) != 0;
+#elif defined(_TIMER_ROUTELOC0_MASK)
+  return (led->timer->ROUTEPEN & (1 << (led->channel + _TIMER_ROUTEPEN_CC0PEN_SHIFT))) != 0;
+#elif defined(_GPIO_TIMER_ROUTEEN_MASK)
+  return (GPIO->TIMERROUTE[TIMER_NUM(led->timer)].ROUTEEN & (1 << (led->channel + _GPIO_TIMER_ROUTEEN_CC0PEN_SHIFT))) != 0;
+#else
+#error "Unknown route setting"
+#endif
+}
+
 /*
  *  Public functions
  */
@@ -170,9 +185,11 @@ sl_status_t sl_pwm_led_init(void *led_handler)
   led->timer->EN_SET = TIMER_EN_EN;
 #endif
 
-  // The configured resolution configuration has to be at least 2. And not bigger than the timer max count + 1
+  // The configured resolution configuration has to be at least 2. And not bigger than the timer max count + 1.
+  // Resolution 0 selects high resolution mode, where the whole counter range at the configured frequency is used.
   uint32_t max_count = TIMER_MaxCount(led->timer);
-  if ((led->resolution < 2UL) || (led->resolution > (max_count))) {
+  if ((led->resolution == 0UL && led->frequency == 0UL)
+      || (led->resolution == 1UL) || (led->resolution > (max_count))) {
     // The user configured max level value is invalid
 #if !defined(_SILICON_LABS_32B_SERIES_2)
     CMU_ClockEnable(cmuClock_HFPER, false);
@@ -220,19 +237,32 @@ if (led->frequency > 0U) {
   top = (CMU_ClockFreqGet(timer_clock) / (led->frequency)) - 1U;
 }
 
-// Then adjust it to make it an even multiplier of the PWM resolution config
-top = (top / (led->resolution - 1)) * (led->resolution - 1);
+if (led->resolution == 0U) {
+  // High resolution mode: one level step is a single timer count, so the resolution
+  // is the number of timer counts in the PWM period (limited by the counter width).
+  // Compare value TOP + 1 keeps the output constantly active, so it has to fit the
+  // CC register and TOP is kept below the counter max.
+  if (top > max_count - 1U) {
+    top = max_count - 1U;
+  }
+  led->resolution = top + 1U;
+} else {
+  // Then adjust it to make it an even multiplier of the PWM resolution config
+  top = (top / (led->resolution - 1)) * (led->resolution - 1);
 
-if (top < (led->resolution - 1)) {
-  // The PWM resolution config demands a higher TOP value than what the frequency config sets.
-  // In this case the resolution config takes precedence over frequency.
-  // So simply set the TOP value equal to the max input value (resolution value - 1).
-  top = led->resolution - 1;
+  if (top < (led->resolution - 1)) {
+    // The PWM resolution config demands a higher TOP value than what the frequency config sets.
+    // In this case the resolution config takes precedence over frequency.
+    // So simply set the TOP value equal to the max input value (resolution value - 1).
+    top = led->resolution - 1;
+  }
 }
 TIMER_TopSet(led->timer, top);
 
 // Initialize TIMER
 TIMER_Init_TypeDef timer_init = TIMER_INIT_DEFAULT;
+// Overflow DMA request is cleared when LDMA writes CC buffer (see led_fade.c)
+timer_init.dmaClrAct = true;
 TIMER_Init(led->timer, &timer_init);
 
 // Initialize the level settings values
@@ -251,11 +281,74 @@ void sl_pwm_led_set_color(void *led_handler, uint16_t color)
   uint32_t level_increments = TIMER_TopGet(led->timer) / (led->resolution - 1);
   led->level = color;
 
-  sl_pwm_led_stop(led);
-  TIMER_CompareBufSet(led->timer, led->channel, led->level * level_increments);
+  sl_pwm_led_set_compare(led, led->level * level_increments);
+}
+
+void sl_pwm_led_set_compare(void *led_handler, uint32_t compare)
+{
+  sl_led_pwm_t *led = (sl_led_pwm_t *)led_handler;
+
+  if (sl_pwm_led_is_started(led)) {
+    // Buffered value is latched on overflow, so the running period is completed with
+    // the old duty. Zero compare keeps the routed output inactive for the whole period.
+    TIMER_CompareBufSet(led->timer, led->channel, compare);
+    return;
+  }
+
+  // Output is not routed, so CC can be written directly. PWM output changes only on
+  // overflow and compare match, so after routing the first full period is correct.
+  TIMER_CompareSet(led->timer, led->channel, compare);
+  TIMER_CompareBufSet(led->timer, led->channel, compare);
   sl_pwm_led_start(led);
 }
 
+void sl_pwm_led_right_align(void *led_handler)
+{
+  sl_led_pwm_t *led = (sl_led_pwm_t *)led_handler;
+
+  TIMER_InitCC_TypeDef channel_init = TIMER_INITCC_DEFAULT;
+  channel_init.mode = timerCCModePWM;
+  channel_init.cmoa = timerOutputActionToggle;
+  channel_init.edge = timerEdgeBoth;
+  // PWM output is set on overflow and cleared on compare match. Inverted output is
+  // active from compare match till overflow, so the pulse is aligned to period end.
+  channel_init.outInvert = !led->polarity;
+  TIMER_InitCC(led->timer, led->channel, &channel_init);
+}
+
+uint32_t sl_pwm_led_clock_get(void *led_handler)
+{
+  sl_led_pwm_t *led = (sl_led_pwm_t *)led_handler;
+
+  return CMU_ClockFreqGet(pwm_led_get_timer_clock(led->timer));
+}
+
+void sl_pwm_led_timer_enable(void *led_handler, bool enable)
+{
+  sl_led_pwm_t *led = (sl_led_pwm_t *)led_handler;
+  CMU_Clock_TypeDef timer_clock = pwm_led_get_timer_clock(led->timer);
+
+  if (enable) {
+    CMU_ClockEnable(timer_clock, true);
+#if defined(_SILICON_LABS_32B_SERIES_2)
+    led->timer->EN_SET = TIMER_EN_EN;
+#endif
+    return;
+  }
+
+  // Counter is stopped first, configuration registers are kept while the clock is gated
+  TIMER_Enable(led->timer, false);
+#if defined(_SILICON_LABS_32B_SERIES_2)
+  TIMER_SyncWait(led->timer);
+  led->timer->EN_CLR = TIMER_EN_EN;
+#if defined(_TIMER_EN_DISABLING_MASK)
+  while (led->timer->EN & _TIMER_EN_DISABLING_MASK) {
+  }
+#endif
+#endif
+  CMU_ClockEnable(timer_clock, false);
+}
+
 void sl_pwm_led_get_color(void *led_handler, uint16_t *color)
 {
   sl_led_pwm_t *led = (sl_led_pwm_t *)led_handler;
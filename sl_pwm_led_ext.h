@@ -0,0 +1,78 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SL_PWM_LED_EXT_H_
+#define SL_PWM_LED_EXT_H_
+
+#include "sl_pwm_led.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief
+ *  Sets raw TIMER compare value of PWM LED. Value is written to CC buffer register,
+ *  so it is applied on next TIMER overflow and running PWM period is never cut.
+ *  Output routing is touched only when output is currently disabled.
+ *
+ * @param led_handler - PWM LED instance
+ * @param compare - TIMER compare value (0 - off, TOP + 1 - fully on, inverted
+ *                  for right aligned output)
+ */
+void sl_pwm_led_set_compare(void *led_handler, uint32_t compare);
+
+/**
+ * @brief
+ *  Moves active part of PWM period to its end. Compare value of such output
+ *  is TOP + 1 - duty. Has to be called after sl_pwm_led_init().
+ *
+ * @param led_handler - PWM LED instance
+ */
+void sl_pwm_led_right_align(void *led_handler);
+
+/**
+ * @brief
+ *  Checks if PWM LED output is routed to the pin.
+ *
+ * @param led_handler - PWM LED instance
+ * @return true when output is enabled
+ */
+bool sl_pwm_led_is_started(void *led_handler);
+
+/**
+ * @brief
+ *  Returns input clock frequency of PWM LED TIMER.
+ *
+ * @param led_handler - PWM LED instance
+ * @return TIMER clock in Hz
+ */
+uint32_t sl_pwm_led_clock_get(void *led_handler);
+
+/**
+ * @brief
+ *  Enables or gates clock of PWM LED TIMER. Counter is stopped before the
+ *  clock is gated, TOP, compare and routing configuration is kept. Counter
+ *  has to be started by caller after the clock is enabled. TIMER is shared by
+ *  its channels, so caller has to track if any of them is still in use.
+ *
+ * @param led_handler - PWM LED instance
+ * @param enable - true to enable clock, false to stop TIMER and gate its clock
+ */
+void sl_pwm_led_timer_enable(void *led_handler, bool enable);
+
+#endif /* SL_PWM_LED_EXT_H_ */
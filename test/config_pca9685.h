@@ -0,0 +1,42 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* all 16 PCA9685 outputs as endpoints 5 - 20, included before app.h */
+
+#ifndef CONFIG_PCA9685_H_
+#define CONFIG_PCA9685_H_
+
+#define APP_CHANNEL_EXT_TABLE(X)            \
+    X(CH5,  0,  0)                          \
+    X(CH6,  1,  0)                          \
+    X(CH7,  2,  0)                          \
+    X(CH8,  3,  0)                          \
+    X(CH9,  4,  0)                          \
+    X(CH10, 5,  0)                          \
+    X(CH11, 6,  0)                          \
+    X(CH12, 7,  0)                          \
+    X(CH13, 8,  0)                          \
+    X(CH14, 9,  0)                          \
+    X(CH15, 10, 0)                          \
+    X(CH16, 11, 0)                          \
+    X(CH17, 12, 0)                          \
+    X(CH18, 13, 0)                          \
+    X(CH19, 14, 0)                          \
+    X(CH20, 15, 0)
+
+#endif /* CONFIG_PCA9685_H_ */
@@ -0,0 +1,29 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* RGB strip of 60 WS2812 pixels (G, R, B) as endpoints 5 - 7, included before app.h */
+
+#ifndef CONFIG_PIXEL_H_
+#define CONFIG_PIXEL_H_
+
+#define APP_CHANNEL_PIXEL_TABLE(X)          \
+    X(CH5, 0, 60, 1)                        \
+    X(CH6, 0, 60, 0)                        \
+    X(CH7, 0, 60, 2)
+
+#endif /* CONFIG_PIXEL_H_ */
@@ -0,0 +1,257 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host stand-in of Zigbee application framework API used by the firmware.
+ * Attribute storage, tokens and events are provided by stack.c. */
+
+#ifndef AF_H_
+#define AF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint8_t     int8u;
+typedef int8_t      int8s;
+typedef uint16_t    int16u;
+typedef uint32_t    int32u;
+
+typedef uint8_t     EmberStatus;
+typedef uint8_t     EmberAfStatus;
+typedef uint16_t    EmberAfClusterId;
+typedef uint16_t    EmberAfAttributeId;
+typedef uint8_t     EmberAfAttributeType;
+typedef uint8_t     EmberAfMoveMode;
+typedef uint8_t     EmberAfStepMode;
+
+typedef struct
+{
+    EmberAfAttributeId      attributeId;
+    EmberAfAttributeType    attributeType;
+    uint16_t                size;
+    uint8_t                 mask;
+
+} EmberAfAttributeMetadata;
+
+typedef struct
+{
+    uint16_t    profileId;
+    uint16_t    clusterId;
+    uint8_t     sourceEndpoint;
+    uint8_t     destinationEndpoint;
+
+} EmberApsFrame;
+
+typedef struct
+{
+    EmberApsFrame   *apsFrame;
+    uint8_t         *buffer;
+    uint16_t        bufLen;
+    bool            clusterSpecific;
+    bool            mfgSpecific;
+    uint16_t        mfgCode;
+    uint8_t         seqNum;
+    uint8_t         commandId;
+    uint8_t         payloadStartIndex;
+    uint8_t         direction;
+
+} EmberAfClusterCommand;
+
+#define EMBER_SUCCESS                                   0x00
+
+#define EMBER_ZCL_STATUS_SUCCESS                        0x00
+#define EMBER_ZCL_STATUS_FAILURE                        0x01
+#define EMBER_ZCL_STATUS_MALFORMED_COMMAND              0x80
+#define EMBER_ZCL_STATUS_UNSUP_COMMAND                  0x81
+#define EMBER_ZCL_STATUS_INVALID_FIELD                  0x85
+#define EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE          0x86
+#define EMBER_ZCL_STATUS_INVALID_VALUE                  0x87
+
+#define EMBER_AF_NULL_MANUFACTURER_CODE                 0x0000
+#define EMBER_AF_MANUFACTURER_CODE                      0x1002
+#define CLUSTER_MASK_SERVER                             0x40
+
+#define ZCL_INT8U_ATTRIBUTE_TYPE                        0x20
+#define ZCL_INT16U_ATTRIBUTE_TYPE                       0x21
+#define ZCL_INT24U_ATTRIBUTE_TYPE                       0x22
+#define ZCL_INT32U_ATTRIBUTE_TYPE                       0x23
+#define ZCL_INT24S_ATTRIBUTE_TYPE                       0x2A
+#define ZCL_INT48U_ATTRIBUTE_TYPE                       0x25
+#define ZCL_BITMAP16_ATTRIBUTE_TYPE                     0x19
+#define ZCL_ENUM8_ATTRIBUTE_TYPE                        0x30
+
+#define ZCL_ON_OFF_CLUSTER_ID                           0x0006
+#define ZCL_LEVEL_CONTROL_CLUSTER_ID                    0x0008
+#define ZCL_COLOR_CONTROL_CLUSTER_ID                    0x0300
+#define ZCL_SIMPLE_METERING_CLUSTER_ID                  0x0702
+
+#define ZCL_ON_OFF_ATTRIBUTE_ID                         0x0000
+#define ZCL_CURRENT_LEVEL_ATTRIBUTE_ID                  0x0000
+#define ZCL_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE_ID   0x0001
+#define ZCL_LEVEL_CONTROL_CURRENT_FREQUENCY_ATTRIBUTE_ID 0x0004
+#define ZCL_LEVEL_CONTROL_MIN_FREQUENCY_ATTRIBUTE_ID    0x0005
+#define ZCL_LEVEL_CONTROL_MAX_FREQUENCY_ATTRIBUTE_ID    0x0006
+#define ZCL_OPTIONS_ATTRIBUTE_ID                        0x000F
+#define ZCL_ON_TIME_ATTRIBUTE_ID                        0x4001
+#define ZCL_OFF_WAIT_TIME_ATTRIBUTE_ID                  0x4002
+#define ZCL_ON_OFF_TRANSITION_TIME_ATTRIBUTE_ID         0x0010
+#define ZCL_ON_LEVEL_ATTRIBUTE_ID                       0x0011
+#define ZCL_DEFAULT_MOVE_RATE_ATTRIBUTE_ID              0x0014
+#define ZCL_CURRENT_SUMMATION_DELIVERED_ATTRIBUTE_ID    0x0000
+#define ZCL_INSTANTANEOUS_DEMAND_ATTRIBUTE_ID           0x0400
+#define ZCL_COLOR_CONTROL_CURRENT_HUE_ATTRIBUTE_ID      0x0000
+#define ZCL_COLOR_CONTROL_CURRENT_SATURATION_ATTRIBUTE_ID 0x0001
+#define ZCL_COLOR_CONTROL_REMAINING_TIME_ATTRIBUTE_ID   0x0002
+#define ZCL_COLOR_CONTROL_CURRENT_X_ATTRIBUTE_ID        0x0003
+#define ZCL_COLOR_CONTROL_CURRENT_Y_ATTRIBUTE_ID        0x0004
+#define ZCL_COLOR_CONTROL_COLOR_TEMPERATURE_ATTRIBUTE_ID 0x0007
+#define ZCL_COLOR_CONTROL_COLOR_MODE_ATTRIBUTE_ID       0x0008
+#define ZCL_COLOR_CONTROL_ENHANCED_COLOR_MODE_ATTRIBUTE_ID 0x4001
+#define ZCL_COLOR_CONTROL_COLOR_CAPABILITIES_ATTRIBUTE_ID 0x400A
+#define ZCL_COLOR_CONTROL_COLOR_TEMP_PHYSICAL_MIN_ATTRIBUTE_ID 0x400B
+#define ZCL_COLOR_CONTROL_COLOR_TEMP_PHYSICAL_MAX_ATTRIBUTE_ID 0x400C
+
+#define ZCL_OFF_COMMAND_ID                              0x00
+#define ZCL_ON_COMMAND_ID                               0x01
+#define ZCL_TOGGLE_COMMAND_ID                           0x02
+#define ZCL_ON_WITH_TIMED_OFF_COMMAND_ID                0x42
+
+#define ZCL_MOVE_TO_LEVEL_COMMAND_ID                    0x00
+#define ZCL_MOVE_COMMAND_ID                             0x01
+#define ZCL_STEP_COMMAND_ID                             0x02
+#define ZCL_STOP_COMMAND_ID                             0x03
+#define ZCL_MOVE_TO_LEVEL_WITH_ON_OFF_COMMAND_ID        0x04
+#define ZCL_MOVE_WITH_ON_OFF_COMMAND_ID                 0x05
+#define ZCL_STEP_WITH_ON_OFF_COMMAND_ID                 0x06
+#define ZCL_STOP_WITH_ON_OFF_COMMAND_ID                 0x07
+#define ZCL_MOVE_TO_CLOSEST_FREQUENCY_COMMAND_ID        0x08
+
+#define ZCL_MOVE_TO_HUE_COMMAND_ID                      0x00
+#define ZCL_MOVE_HUE_COMMAND_ID                         0x01
+#define ZCL_STEP_HUE_COMMAND_ID                         0x02
+#define ZCL_MOVE_TO_SATURATION_COMMAND_ID               0x03
+#define ZCL_MOVE_SATURATION_COMMAND_ID                  0x04
+#define ZCL_STEP_SATURATION_COMMAND_ID                  0x05
+#define ZCL_MOVE_TO_HUE_AND_SATURATION_COMMAND_ID       0x06
+#define ZCL_MOVE_TO_COLOR_COMMAND_ID                    0x07
+#define ZCL_MOVE_COLOR_COMMAND_ID                       0x08
+#define ZCL_STEP_COLOR_COMMAND_ID                       0x09
+#define ZCL_MOVE_TO_COLOR_TEMPERATURE_COMMAND_ID        0x0A
+#define ZCL_STOP_MOVE_STEP_COMMAND_ID                   0x47
+#define ZCL_MOVE_COLOR_TEMPERATURE_COMMAND_ID           0x4B
+#define ZCL_STEP_COLOR_TEMPERATURE_COMMAND_ID           0x4C
+
+#define EMBER_ZCL_MOVE_MODE_UP                          0x00
+#define EMBER_ZCL_MOVE_MODE_DOWN                        0x01
+#define EMBER_ZCL_STEP_MODE_UP                          0x00
+#define EMBER_ZCL_STEP_MODE_DOWN                        0x01
+
+#define EMBER_ZCL_LEVEL_CONTROL_OPTIONS_EXECUTE_IF_OFF  0x01
+
+#define EMBER_ZCL_COLOR_MODE_CURRENT_HUE_AND_CURRENT_SATURATION 0x00
+#define EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y    0x01
+#define EMBER_ZCL_COLOR_MODE_COLOR_TEMPERATURE          0x02
+
+#define ZCL_CLUSTER_SPECIFIC_COMMAND                    0x01
+#define ZCL_MANUFACTURER_SPECIFIC_MASK                  0x04
+#define ZCL_FRAME_CONTROL_SERVER_TO_CLIENT              0x08
+#define ZCL_DISABLE_DEFAULT_RESPONSE_MASK               0x10
+
+#define MEMSET      memset
+#define MEMCOPY     memcpy
+
+/* command being processed, set by firmware.c */
+extern EmberAfClusterCommand *emAfCurrentCommand;
+
+#define emberAfCurrentCommand()     (emAfCurrentCommand)
+#define emberAfCurrentEndpoint()    (emberAfCurrentCommand()->apsFrame->destinationEndpoint)
+
+uint8_t emberAfIndexFromEndpoint(uint8_t endpoint);
+bool emberAfEndpointEnableDisable(uint8_t endpoint, bool enable);
+
+EmberAfStatus emberAfReadAttribute(uint8_t endpoint, EmberAfClusterId cluster, EmberAfAttributeId attributeId,
+                                   uint8_t mask, uint8_t *dataPtr, uint16_t readLength,
+                                   EmberAfAttributeType *dataType);
+EmberAfStatus emberAfReadServerAttribute(uint8_t endpoint, EmberAfClusterId cluster,
+                                         EmberAfAttributeId attributeId, uint8_t *dataPtr,
+                                         uint16_t readLength);
+EmberAfStatus emberAfWriteAttribute(uint8_t endpoint, EmberAfClusterId cluster, EmberAfAttributeId attributeId,
+                                    uint8_t mask, uint8_t *dataPtr, EmberAfAttributeType dataType);
+EmberAfStatus emberAfWriteServerAttribute(uint8_t endpoint, EmberAfClusterId cluster,
+                                          EmberAfAttributeId attributeId, uint8_t *dataPtr,
+                                          EmberAfAttributeType dataType);
+
+EmberStatus emberAfSendImmediateDefaultResponse(EmberAfStatus status);
+
+/* response is recorded by stack.c, format chars u/v/w are int8u/int16u/int32u */
+uint16_t emberAfFillExternalManufacturerSpecificBuffer(uint8_t frameControl, EmberAfClusterId clusterId,
+                                                       uint16_t manufacturerCode, uint8_t commandId,
+                                                       const char *format, ...);
+EmberStatus emberAfSendResponse(void);
+
+void emberAfPostAttributeChangeCallback(uint8_t endpoint, EmberAfClusterId clusterId, EmberAfAttributeId attributeId,
+                                        uint8_t mask, uint16_t manufacturerCode, uint8_t type, uint8_t size,
+                                        uint8_t *value);
+
+EmberAfStatus emberAfOnOffClusterSetValueCallback(uint8_t endpoint, uint8_t command, bool initiatedByLevelChange);
+void emberAfOnOffClusterLevelControlEffectCallback(uint8_t endpoint, bool newValue);
+
+EmberAfStatus emberAfExternalAttributeReadCallback(uint8_t endpoint, EmberAfClusterId clusterId,
+                                                   EmberAfAttributeMetadata *attributeMetadata,
+                                                   uint16_t manufacturerCode, uint8_t *buffer,
+                                                   uint16_t maxReadLength);
+EmberAfStatus emberAfExternalAttributeWriteCallback(uint8_t endpoint, EmberAfClusterId clusterId,
+                                                    EmberAfAttributeMetadata *attributeMetadata,
+                                                    uint16_t manufacturerCode, uint8_t *buffer);
+
+void sl_zigbee_app_debug_print(const char *format, ...);
+
+uint32_t halCommonGetInt32uMillisecondTick(void);
+
+/* tokens of sl_custom_token_header.h, defaults are set by stack.c */
+#define NVM3KEY_DOMAIN_ZIGBEE   0x10000
+
+#define DEFINETYPES
+#include "sl_custom_token_header.h"
+#undef DEFINETYPES
+
+#define DEFINE_BASIC_TOKEN(name, type, ...)                 TOKEN_##name,
+#define DEFINE_INDEXED_TOKEN(name, type, arraysize, ...)    TOKEN_##name,
+
+typedef enum
+{
+#define DEFINETOKENS
+#include "sl_custom_token_header.h"
+#undef DEFINETOKENS
+    MODEL_TOKEN_COUNT
+
+} ModelToken;
+
+#undef DEFINE_BASIC_TOKEN
+#undef DEFINE_INDEXED_TOKEN
+
+void model_token_get(ModelToken token, uint32_t index, void *data);
+void model_token_set(ModelToken token, uint32_t index, const void *data);
+
+#define halCommonGetToken(data, token)                  model_token_get(token, 0, data)
+#define halCommonGetIndexedToken(data, token, index)    model_token_get(token, index, data)
+#define halCommonSetToken(token, data)                  model_token_set(token, 0, data)
+#define halCommonSetIndexedToken(token, index, data)    model_token_set(token, index, data)
+
+#endif /* AF_H_ */
@@ -0,0 +1,61 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DMADRV_H_
+#define DMADRV_H_
+
+#include "em_device.h"
+
+typedef uint32_t Ecode_t;
+
+#define ECODE_EMDRV_DMADRV_OK   0
+
+typedef enum
+{
+    dmadrvPeripheralSignal_NONE,
+    dmadrvPeripheralSignal_TIMER0_UFOF,
+    dmadrvPeripheralSignal_TIMER1_UFOF,
+    dmadrvPeripheralSignal_TIMER2_UFOF,
+    dmadrvPeripheralSignal_TIMER3_UFOF,
+    dmadrvPeripheralSignal_USART1_TXBL
+
+} DMADRV_PeripheralSignal_t;
+
+typedef enum
+{
+    dmadrvDataSize1,
+    dmadrvDataSize2,
+    dmadrvDataSize4
+
+} DMADRV_DataSize_t;
+
+typedef bool (*DMADRV_Callback_t)(unsigned int channel, unsigned int sequenceNo, void *userParam);
+
+Ecode_t DMADRV_Init(void);
+Ecode_t DMADRV_AllocateChannel(unsigned int *channelId, void *capabilities);
+Ecode_t DMADRV_MemoryPeripheral(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                void *dst, void *src, bool srcInc, int len, DMADRV_DataSize_t size,
+                                DMADRV_Callback_t callback, void *cbUserParam);
+Ecode_t DMADRV_MemoryPeripheralPingPong(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                        void *dst, void *src0, void *src1, bool srcInc, int len,
+                                        DMADRV_DataSize_t size, DMADRV_Callback_t callback,
+                                        void *cbUserParam);
+Ecode_t DMADRV_StopTransfer(unsigned int channelId);
+Ecode_t DMADRV_TransferRemainingCount(unsigned int channelId, int *remaining);
+
+#endif /* DMADRV_H_ */
@@ -0,0 +1,44 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EM_CMU_H_
+#define EM_CMU_H_
+
+#include "em_device.h"
+
+typedef enum
+{
+    cmuClock_SYSCLK,
+    cmuClock_TIMER0,
+    cmuClock_TIMER1,
+    cmuClock_TIMER2,
+    cmuClock_TIMER3,
+    cmuClock_GPIO,
+    cmuClock_LETIMER0,
+    cmuClock_I2C1,
+    cmuClock_USART0,
+    cmuClock_USART1,
+    cmuClock_LDMA,
+    MODEL_CLOCK_COUNT
+
+} CMU_Clock_TypeDef;
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable);
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock);
+
+#endif /* EM_CMU_H_ */
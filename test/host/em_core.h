@@ -0,0 +1,36 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EM_CORE_H_
+#define EM_CORE_H_
+
+#include "em_device.h"
+
+typedef uint32_t CORE_irqState_t;
+
+/* interrupts pending in the model are delivered when critical section is left */
+CORE_irqState_t CORE_EnterCritical(void);
+void CORE_ExitCritical(CORE_irqState_t irq_state);
+
+#define CORE_DECLARE_IRQ_STATE      CORE_irqState_t irqState
+#define CORE_ENTER_CRITICAL()       irqState = CORE_EnterCritical()
+#define CORE_EXIT_CRITICAL()        CORE_ExitCritical(irqState)
+#define CORE_ENTER_ATOMIC()         CORE_ENTER_CRITICAL()
+#define CORE_EXIT_ATOMIC()          CORE_EXIT_CRITICAL()
+
+#endif /* EM_CORE_H_ */
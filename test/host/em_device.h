@@ -0,0 +1,246 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host stand-in of EFR32MG21 device header. Only registers used by the
+ * firmware are declared. Peripherals are mapped by the register model at
+ * fixed addresses (see model.c), so TIMERn are address constants as on
+ * target and can be used in static initializers and switch cases. */
+
+#ifndef EM_DEVICE_H_
+#define EM_DEVICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define _SILICON_LABS_32B_SERIES_2          1
+#define _SILICON_LABS_32B_SERIES_2_CONFIG_1 1
+
+typedef struct
+{
+    volatile uint32_t CFG;
+    volatile uint32_t CTRL;
+    volatile uint32_t OC;
+    volatile uint32_t OCB;
+    volatile uint32_t ICF;
+} TIMER_CC_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t IPVERSION;
+    volatile uint32_t CFG;
+    volatile uint32_t CTRL;
+    volatile uint32_t CMD;
+    volatile uint32_t STATUS;
+    volatile uint32_t IF;
+    volatile uint32_t IEN;
+    volatile uint32_t TOP;
+    volatile uint32_t TOPB;
+    volatile uint32_t CNT;
+    volatile uint32_t EN;
+    volatile uint32_t SYNCBUSY;
+    TIMER_CC_TypeDef  CC[3];
+    /* set/clear aliases are folded into the registers by the model */
+    volatile uint32_t EN_SET;
+    volatile uint32_t EN_CLR;
+} TIMER_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t ROUTEEN;
+    volatile uint32_t CC0ROUTE;
+    volatile uint32_t CC1ROUTE;
+    volatile uint32_t CC2ROUTE;
+    volatile uint32_t CDTI0ROUTE;
+    volatile uint32_t CDTI1ROUTE;
+    volatile uint32_t CDTI2ROUTE;
+} GPIO_TIMERROUTE_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t ROUTEEN;
+    volatile uint32_t SCLROUTE;
+    volatile uint32_t SDAROUTE;
+} GPIO_I2CROUTE_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t ROUTEEN;
+    volatile uint32_t CSROUTE;
+    volatile uint32_t CTSROUTE;
+    volatile uint32_t RTSROUTE;
+    volatile uint32_t RXROUTE;
+    volatile uint32_t CLKROUTE;
+    volatile uint32_t TXROUTE;
+} GPIO_USARTROUTE_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t ROUTEEN;
+    volatile uint32_t OUT0ROUTE;
+    volatile uint32_t OUT1ROUTE;
+} GPIO_LETIMERROUTE_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t MODEL;
+    volatile uint32_t DOUT;
+    volatile uint32_t DIN;
+} GPIO_PORT_TypeDef;
+
+typedef struct
+{
+    GPIO_PORT_TypeDef           P[4];
+    GPIO_TIMERROUTE_TypeDef     TIMERROUTE[4];
+    GPIO_I2CROUTE_TypeDef       I2CROUTE[2];
+    GPIO_USARTROUTE_TypeDef     USARTROUTE[3];
+    GPIO_LETIMERROUTE_TypeDef   LETIMERROUTE[1];
+    /* set/clear aliases are folded into the registers by the model */
+    GPIO_TIMERROUTE_TypeDef     TIMERROUTE_SET[4];
+    GPIO_TIMERROUTE_TypeDef     TIMERROUTE_CLR[4];
+} GPIO_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t EN;
+    volatile uint32_t CTRL;
+    volatile uint32_t CNT;
+    volatile uint32_t COMP0;
+    volatile uint32_t COMP1;
+    volatile uint32_t TOP;
+    volatile uint32_t IF;
+    volatile uint32_t IEN;
+} LETIMER_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t EN;
+    volatile uint32_t CTRL;
+    volatile uint32_t STATUS;
+    volatile uint32_t IF;
+    volatile uint32_t IEN;
+} I2C_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t EN;
+    volatile uint32_t CTRL;
+    volatile uint32_t FRAME;
+    volatile uint32_t TXDATA;
+} USART_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* model addresses, in the peripheral window of EFR32MG21 */
+#define MODEL_PERIPH_BASE   0x50000000UL
+#define MODEL_PERIPH_SIZE   0x00100000UL
+
+#define GPIO_BASE           0x5003C000UL
+#define TIMER0_BASE         0x50048000UL
+#define TIMER1_BASE         0x5004C000UL
+#define TIMER2_BASE         0x50050000UL
+#define TIMER3_BASE         0x50054000UL
+#define USART0_BASE         0x50058000UL
+#define USART1_BASE         0x5005C000UL
+#define I2C1_BASE           0x50068000UL
+#define LETIMER0_BASE       0x500A4000UL
+#define DWT_BASE            0x500E0000UL
+#define COREDEBUG_BASE      0x500E1000UL
+
+#define GPIO                ((GPIO_TypeDef *)GPIO_BASE)
+#define TIMER0              ((TIMER_TypeDef *)TIMER0_BASE)
+#define TIMER1              ((TIMER_TypeDef *)TIMER1_BASE)
+#define TIMER2              ((TIMER_TypeDef *)TIMER2_BASE)
+#define TIMER3              ((TIMER_TypeDef *)TIMER3_BASE)
+#define USART0              ((USART_TypeDef *)USART0_BASE)
+#define USART1              ((USART_TypeDef *)USART1_BASE)
+#define I2C1                ((I2C_TypeDef *)I2C1_BASE)
+#define LETIMER0            ((LETIMER_TypeDef *)LETIMER0_BASE)
+#define DWT                 ((DWT_Type *)DWT_BASE)
+#define CoreDebug           ((CoreDebug_Type *)COREDEBUG_BASE)
+
+#define TIMER_COUNT         4
+
+#define TIMER_NUM(ref)      ((ref) == TIMER0 ? 0 : (ref) == TIMER1 ? 1 : (ref) == TIMER2 ? 2 : \
+                             (ref) == TIMER3 ? 3 : -1)
+#define TIMER_REF_VALID(ref)    (TIMER_NUM(ref) >= 0)
+#define TIMER_CH_VALID(ch)      ((ch) < 3)
+#define TIMER_MAX_COUNT(ref)    ((ref) == TIMER0 ? 0xFFFFFFFFUL : 0xFFFFUL)
+#define USART_NUM(ref)      ((ref) == USART0 ? 0 : (ref) == USART1 ? 1 : -1)
+#define I2C_NUM(ref)        ((ref) == I2C1 ? 1 : -1)
+
+#define TIMER_EN_EN                         0x1UL
+#define _TIMER_EN_DISABLING_MASK            0x2UL
+#define TIMER_CMD_START                     0x1UL
+#define TIMER_CMD_STOP                      0x2UL
+#define TIMER_IF_OF                         0x1UL
+#define TIMER_IF_UF                         0x2UL
+#define TIMER_IEN_OF                        0x1UL
+#define TIMER_IEN_UF                        0x2UL
+
+#define _GPIO_TIMER_ROUTEEN_MASK            0x3FUL
+#define _GPIO_TIMER_ROUTEEN_CC0PEN_SHIFT    0
+#define _GPIO_TIMER_CC0ROUTE_PORT_SHIFT     0
+#define _GPIO_TIMER_CC0ROUTE_PIN_SHIFT      16
+#define _GPIO_I2C_SDAROUTE_PORT_SHIFT       0
+#define _GPIO_I2C_SDAROUTE_PIN_SHIFT        16
+#define _GPIO_I2C_SCLROUTE_PORT_SHIFT       0
+#define _GPIO_I2C_SCLROUTE_PIN_SHIFT        16
+#define GPIO_I2C_ROUTEEN_SDAPEN             0x1UL
+#define GPIO_I2C_ROUTEEN_SCLPEN             0x2UL
+#define _GPIO_USART_TXROUTE_PORT_SHIFT      0
+#define _GPIO_USART_TXROUTE_PIN_SHIFT       16
+#define GPIO_USART_ROUTEEN_TXPEN            0x4UL
+#define _GPIO_LETIMER_OUT0ROUTE_PORT_SHIFT  0
+#define _GPIO_LETIMER_OUT0ROUTE_PIN_SHIFT   16
+#define GPIO_LETIMER_ROUTEEN_OUT0PEN        0x1UL
+
+#define _CMU_SYSCLKCTRL_MASK                0x7UL
+
+#define CoreDebug_DEMCR_TRCENA_Msk          (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk              0x1UL
+
+typedef enum
+{
+    TIMER0_IRQn,
+    TIMER1_IRQn,
+    TIMER2_IRQn,
+    TIMER3_IRQn,
+    LETIMER0_IRQn,
+    I2C1_IRQn,
+    LDMA_IRQn,
+    MODEL_IRQ_COUNT
+
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+#define __NOP()
+
+#endif /* EM_DEVICE_H_ */
@@ -0,0 +1,79 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EM_I2C_H_
+#define EM_I2C_H_
+
+#include "em_device.h"
+
+#define I2C_FREQ_STANDARD_MAX   92000
+#define I2C_FREQ_FAST_MAX       392157
+
+#define I2C_FLAG_WRITE          0x0001
+#define I2C_FLAG_READ           0x0002
+#define I2C_FLAG_WRITE_WRITE    0x0008
+
+typedef enum
+{
+    i2cClockHLRStandard,
+    i2cClockHLRAsymetric,
+    i2cClockHLRFast
+
+} I2C_ClockHLR_TypeDef;
+
+typedef struct
+{
+    bool                    enable;
+    bool                    master;
+    uint32_t                refFreq;
+    uint32_t                freq;
+    I2C_ClockHLR_TypeDef    clhr;
+
+} I2C_Init_TypeDef;
+
+#define I2C_INIT_DEFAULT    { true, true, 0, I2C_FREQ_STANDARD_MAX, i2cClockHLRStandard }
+
+typedef struct
+{
+    uint16_t    addr;
+    uint16_t    flags;
+    struct
+    {
+        uint8_t     *data;
+        uint16_t    len;
+    } buf[2];
+
+} I2C_TransferSeq_TypeDef;
+
+typedef enum
+{
+    i2cTransferInProgress = 1,
+    i2cTransferDone = 0,
+    i2cTransferNack = -1,
+    i2cTransferBusErr = -2,
+    i2cTransferArbLost = -3,
+    i2cTransferUsageFault = -4,
+    i2cTransferSwFault = -5
+
+} I2C_TransferReturn_TypeDef;
+
+void I2C_Init(I2C_TypeDef *i2c, const I2C_Init_TypeDef *init);
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c, I2C_TransferSeq_TypeDef *seq);
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c);
+
+#endif /* EM_I2C_H_ */
@@ -0,0 +1,66 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EM_LETIMER_H_
+#define EM_LETIMER_H_
+
+#include "em_device.h"
+
+typedef enum
+{
+    letimerUFOANone,
+    letimerUFOAToggle,
+    letimerUFOAPulse,
+    letimerUFOAPwm
+
+} LETIMER_UFOA_TypeDef;
+
+typedef enum
+{
+    letimerRepeatFree,
+    letimerRepeatOneshot,
+    letimerRepeatBuffered,
+    letimerRepeatDouble
+
+} LETIMER_RepeatMode_TypeDef;
+
+typedef struct
+{
+    bool                        enable;
+    bool                        debugRun;
+    bool                        comp0Top;
+    bool                        bufTop;
+    uint8_t                     out0Pol;
+    uint8_t                     out1Pol;
+    LETIMER_UFOA_TypeDef        ufoa0;
+    LETIMER_UFOA_TypeDef        ufoa1;
+    LETIMER_RepeatMode_TypeDef  repMode;
+    uint32_t                    topValue;
+
+} LETIMER_Init_TypeDef;
+
+#define LETIMER_INIT_DEFAULT    { true, false, false, false, 0, 0, letimerUFOANone, letimerUFOANone, \
+                                  letimerRepeatFree, 0 }
+
+void LETIMER_Init(LETIMER_TypeDef *letimer, const LETIMER_Init_TypeDef *init);
+void LETIMER_Enable(LETIMER_TypeDef *letimer, bool enable);
+void LETIMER_TopSet(LETIMER_TypeDef *letimer, uint32_t value);
+void LETIMER_CompareSet(LETIMER_TypeDef *letimer, unsigned int comp, uint32_t value);
+void LETIMER_CounterSet(LETIMER_TypeDef *letimer, uint32_t value);
+
+#endif /* EM_LETIMER_H_ */
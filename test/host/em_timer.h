@@ -0,0 +1,117 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EM_TIMER_H_
+#define EM_TIMER_H_
+
+#include "em_device.h"
+#include "em_cmu.h"
+
+typedef enum
+{
+    timerCCModeOff,
+    timerCCModeCapture,
+    timerCCModeCompare,
+    timerCCModePWM
+
+} TIMER_CCMode_TypeDef;
+
+typedef enum
+{
+    timerOutputActionNone,
+    timerOutputActionToggle,
+    timerOutputActionClear,
+    timerOutputActionSet
+
+} TIMER_OutputAction_TypeDef;
+
+typedef enum
+{
+    timerEdgeRising,
+    timerEdgeFalling,
+    timerEdgeBoth,
+    timerEdgeNone
+
+} TIMER_Edge_TypeDef;
+
+typedef enum
+{
+    timerModeUp,
+    timerModeDown,
+    timerModeUpDown,
+    timerModeQDec
+
+} TIMER_Mode_TypeDef;
+
+typedef struct
+{
+    int                         eventCtrl;
+    TIMER_Edge_TypeDef          edge;
+    int                         prsSel;
+    TIMER_OutputAction_TypeDef  cufoa;
+    TIMER_OutputAction_TypeDef  cofoa;
+    TIMER_OutputAction_TypeDef  cmoa;
+    TIMER_CCMode_TypeDef        mode;
+    bool                        filter;
+    bool                        prsInput;
+    bool                        coist;
+    bool                        outInvert;
+
+} TIMER_InitCC_TypeDef;
+
+#define TIMER_INITCC_DEFAULT    { 0, timerEdgeRising, 0, timerOutputActionNone, timerOutputActionNone, \
+                                  timerOutputActionNone, timerCCModeOff, false, false, false, false }
+
+typedef struct
+{
+    bool                        enable;
+    bool                        debugRun;
+    int                         prescale;
+    int                         clkSel;
+    bool                        count2x;
+    bool                        ati;
+    TIMER_OutputAction_TypeDef  fallAction;
+    TIMER_OutputAction_TypeDef  riseAction;
+    TIMER_Mode_TypeDef          mode;
+    bool                        dmaClrAct;
+    bool                        quadModeX4;
+    bool                        oneShot;
+    bool                        sync;
+
+} TIMER_Init_TypeDef;
+
+#define TIMER_INIT_DEFAULT      { true, true, 0, 0, false, false, timerOutputActionNone, \
+                                  timerOutputActionNone, timerModeUp, false, false, false, false }
+
+void TIMER_Init(TIMER_TypeDef *timer, const TIMER_Init_TypeDef *init);
+void TIMER_InitCC(TIMER_TypeDef *timer, unsigned int ch, const TIMER_InitCC_TypeDef *init);
+void TIMER_Enable(TIMER_TypeDef *timer, bool enable);
+void TIMER_SyncWait(TIMER_TypeDef *timer);
+void TIMER_TopSet(TIMER_TypeDef *timer, uint32_t val);
+void TIMER_TopBufSet(TIMER_TypeDef *timer, uint32_t val);
+uint32_t TIMER_TopGet(TIMER_TypeDef *timer);
+uint32_t TIMER_CounterGet(TIMER_TypeDef *timer);
+void TIMER_CounterSet(TIMER_TypeDef *timer, uint32_t val);
+void TIMER_CompareSet(TIMER_TypeDef *timer, unsigned int ch, uint32_t val);
+void TIMER_CompareBufSet(TIMER_TypeDef *timer, unsigned int ch, uint32_t val);
+uint32_t TIMER_MaxCount(TIMER_TypeDef *timer);
+void TIMER_IntEnable(TIMER_TypeDef *timer, uint32_t flags);
+void TIMER_IntDisable(TIMER_TypeDef *timer, uint32_t flags);
+void TIMER_IntClear(TIMER_TypeDef *timer, uint32_t flags);
+
+#endif /* EM_TIMER_H_ */
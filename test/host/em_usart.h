@@ -0,0 +1,68 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EM_USART_H_
+#define EM_USART_H_
+
+#include "em_device.h"
+
+typedef enum
+{
+    usartDisable,
+    usartEnableRx,
+    usartEnableTx,
+    usartEnable
+
+} USART_Enable_TypeDef;
+
+typedef enum
+{
+    usartClockMode0,
+    usartClockMode1,
+    usartClockMode2,
+    usartClockMode3
+
+} USART_ClockMode_TypeDef;
+
+typedef enum
+{
+    usartDatabits8 = 5
+
+} USART_Databits_TypeDef;
+
+typedef struct
+{
+    USART_Enable_TypeDef    enable;
+    uint32_t                refFreq;
+    uint32_t                baudrate;
+    USART_Databits_TypeDef  databits;
+    bool                    master;
+    bool                    msbf;
+    USART_ClockMode_TypeDef clockMode;
+    bool                    prsRxEnable;
+    int                     prsRxCh;
+    bool                    autoTx;
+
+} USART_InitSync_TypeDef;
+
+#define USART_INITSYNC_DEFAULT  { usartEnable, 0, 1000000, usartDatabits8, true, false, usartClockMode0, \
+                                  false, 0, false }
+
+void USART_InitSync(USART_TypeDef *usart, const USART_InitSync_TypeDef *init);
+
+#endif /* EM_USART_H_ */
@@ -0,0 +1,214 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "firmware.h"
+#include "stack.h"
+#include "app.h"
+#include "led_channel.h"
+#include "led_light.h"
+#include "led_effect.h"
+#include "on_off_extension.h"
+#include "level_extension.h"
+#include "mfg_extension.h"
+#if APP_LIGHT_MODE != APP_LIGHT_MODE_CHANNELS
+#include "color_extension.h"
+#endif
+#if APP_METERING
+#include "led_meter.h"
+#endif
+#if APP_WAVE_MONITOR
+#include "led_wave.h"
+#endif
+
+#include <string.h>
+
+#define FIRMWARE_ZCL_HEADER_SIZE     3
+#define FIRMWARE_ZCL_MFG_HEADER_SIZE 5
+#define FIRMWARE_ZCL_PAYLOAD_MAX     16
+
+void firmware_boot(void)
+{
+    stack_init();
+
+    /* emberAfMainInitCallback() */
+    led_channel_init();
+    led_light_init();
+    led_effect_init();
+#if APP_METERING
+    led_meter_init();
+#endif
+#if APP_WAVE_MONITOR
+    led_wave_init();
+#endif
+    led_effect_run(LedChannel_AUX, LedEffect_Reboot, 1);
+
+    /* app_init(), zcl_extension_init() */
+    level_extension_init();
+    on_off_extension_init();
+#if APP_LIGHT_MODE != APP_LIGHT_MODE_CHANNELS
+    color_extension_init();
+#endif
+    led_channel_commit_flush();
+    led_channel_endpoints_enable();
+}
+
+void emberAfPostAttributeChangeCallback(uint8_t endpoint, EmberAfClusterId clusterId, EmberAfAttributeId attributeId,
+                                        uint8_t mask, uint16_t manufacturerCode, uint8_t type, uint8_t size,
+                                        uint8_t *value)
+{
+    if (mask == CLUSTER_MASK_SERVER && clusterId == ZCL_ON_OFF_CLUSTER_ID)
+    {
+        on_off_attribute_written(endpoint, attributeId, size, value);
+    }
+}
+
+static uint32_t firmware_cmd(uint8_t endpoint, uint16_t cluster, uint8_t command, bool mfg,
+                             const uint8_t *payload, uint8_t len)
+{
+    static uint8_t seq;
+    uint8_t header = mfg ? FIRMWARE_ZCL_MFG_HEADER_SIZE : FIRMWARE_ZCL_HEADER_SIZE;
+    uint8_t buffer[FIRMWARE_ZCL_MFG_HEADER_SIZE + FIRMWARE_ZCL_PAYLOAD_MAX];
+    EmberApsFrame aps = { .clusterId = cluster, .destinationEndpoint = endpoint };
+    EmberAfClusterCommand cmd =
+    {
+        .apsFrame = &aps,
+        .buffer = buffer,
+        .bufLen = header + len,
+        .clusterSpecific = true,
+        .mfgSpecific = mfg,
+        .mfgCode = mfg ? EMBER_AF_MANUFACTURER_CODE : EMBER_AF_NULL_MANUFACTURER_CODE,
+        .seqNum = seq++,
+        .commandId = command,
+        .payloadStartIndex = header,
+    };
+    sl_service_function_context_t context = { .data = &cmd };
+    uint32_t status = EMBER_ZCL_STATUS_UNSUP_COMMAND;
+
+    if (mfg)
+    {
+        memcpy(buffer, (uint8_t[]){ ZCL_CLUSTER_SPECIFIC_COMMAND | ZCL_MANUFACTURER_SPECIFIC_MASK,
+                                    (uint8_t)EMBER_AF_MANUFACTURER_CODE, EMBER_AF_MANUFACTURER_CODE >> 8,
+                                    cmd.seqNum, command }, header);
+    }
+    else
+    {
+        memcpy(buffer, (uint8_t[]){ ZCL_CLUSTER_SPECIFIC_COMMAND, cmd.seqNum, command }, header);
+    }
+
+    if (len > 0)
+    {
+        memcpy(&buffer[header], payload, len);
+    }
+
+    emAfCurrentCommand = &cmd;
+
+    /* as dispatched by service functions of zcl_extension.c */
+    if (mfg && cluster == ZCL_LEVEL_CONTROL_CLUSTER_ID)
+    {
+        status = mfg_extension_level_handle_cmd(0, &context);
+    }
+    else if (mfg == false && cluster == ZCL_ON_OFF_CLUSTER_ID)
+    {
+        status = on_off_extension_handle_cmd(0, &context);
+    }
+    else if (mfg == false && cluster == ZCL_LEVEL_CONTROL_CLUSTER_ID)
+    {
+        status = level_extension_handle_cmd(0, &context);
+    }
+#if APP_LIGHT_MODE != APP_LIGHT_MODE_CHANNELS
+    else if (mfg == false && cluster == ZCL_COLOR_CONTROL_CLUSTER_ID)
+    {
+        status = color_extension_handle_cmd(0, &context);
+    }
+#endif
+
+    emAfCurrentCommand = NULL;
+
+    return status;
+}
+
+uint32_t firmware_zcl_cmd(uint8_t endpoint, uint16_t cluster, uint8_t command,
+                          const uint8_t *payload, uint8_t len)
+{
+    return firmware_cmd(endpoint, cluster, command, false, payload, len);
+}
+
+uint32_t firmware_mfg_cmd(uint8_t endpoint, uint16_t cluster, uint8_t command,
+                          const uint8_t *payload, uint8_t len)
+{
+    return firmware_cmd(endpoint, cluster, command, true, payload, len);
+}
+
+void firmware_move_to_level(uint8_t endpoint, uint8_t level, uint16_t transition_time, bool with_on_off)
+{
+    uint8_t payload[] = { level, (uint8_t)transition_time, (uint8_t)(transition_time >> 8), 0, 0 };
+
+    firmware_zcl_cmd(endpoint, ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                     with_on_off ? ZCL_MOVE_TO_LEVEL_WITH_ON_OFF_COMMAND_ID : ZCL_MOVE_TO_LEVEL_COMMAND_ID,
+                     payload, sizeof(payload));
+}
+
+void firmware_move(uint8_t endpoint, uint8_t mode, uint8_t rate, bool with_on_off)
+{
+    uint8_t payload[] = { mode, rate, 0, 0 };
+
+    firmware_zcl_cmd(endpoint, ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                     with_on_off ? ZCL_MOVE_WITH_ON_OFF_COMMAND_ID : ZCL_MOVE_COMMAND_ID,
+                     payload, sizeof(payload));
+}
+
+void firmware_step(uint8_t endpoint, uint8_t mode, uint8_t size, uint16_t transition_time, bool with_on_off)
+{
+    uint8_t payload[] = { mode, size, (uint8_t)transition_time, (uint8_t)(transition_time >> 8), 0, 0 };
+
+    firmware_zcl_cmd(endpoint, ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                     with_on_off ? ZCL_STEP_WITH_ON_OFF_COMMAND_ID : ZCL_STEP_COMMAND_ID,
+                     payload, sizeof(payload));
+}
+
+void firmware_stop(uint8_t endpoint, bool with_on_off)
+{
+    uint8_t payload[] = { 0, 0 };
+
+    firmware_zcl_cmd(endpoint, ZCL_LEVEL_CONTROL_CLUSTER_ID,
+                     with_on_off ? ZCL_STOP_WITH_ON_OFF_COMMAND_ID : ZCL_STOP_COMMAND_ID,
+                     payload, sizeof(payload));
+}
+
+void firmware_move_to_closest_frequency(uint8_t endpoint, uint16_t frequency)
+{
+    uint8_t payload[] = { (uint8_t)frequency, (uint8_t)(frequency >> 8) };
+
+    firmware_zcl_cmd(endpoint, ZCL_LEVEL_CONTROL_CLUSTER_ID, ZCL_MOVE_TO_CLOSEST_FREQUENCY_COMMAND_ID,
+                     payload, sizeof(payload));
+}
+
+void firmware_on_off(uint8_t endpoint, uint8_t command)
+{
+    firmware_zcl_cmd(endpoint, ZCL_ON_OFF_CLUSTER_ID, command, NULL, 0);
+}
+
+uint8_t firmware_current_level_get(uint8_t endpoint)
+{
+    uint8_t level = 0;
+
+    emberAfReadServerAttribute(endpoint, ZCL_LEVEL_CONTROL_CLUSTER_ID, ZCL_CURRENT_LEVEL_ATTRIBUTE_ID,
+                               &level, sizeof(level));
+
+    return level;
+}
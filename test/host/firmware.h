@@ -0,0 +1,49 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Firmware started as from emberAfMainInitCallback() and app_init(), ZCL
+ * commands are dispatched to cluster extensions as by the service function
+ * registered in zcl_extension.c. */
+
+#ifndef FIRMWARE_H_
+#define FIRMWARE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void firmware_boot(void);
+
+uint32_t firmware_zcl_cmd(uint8_t endpoint, uint16_t cluster, uint8_t command,
+                          const uint8_t *payload, uint8_t len);
+
+/* manufacturer specific command (EMBER_AF_MANUFACTURER_CODE) */
+uint32_t firmware_mfg_cmd(uint8_t endpoint, uint16_t cluster, uint8_t command,
+                          const uint8_t *payload, uint8_t len);
+
+/* Level Control commands, time in 1/10 s */
+void firmware_move_to_level(uint8_t endpoint, uint8_t level, uint16_t transition_time, bool with_on_off);
+void firmware_move(uint8_t endpoint, uint8_t mode, uint8_t rate, bool with_on_off);
+void firmware_step(uint8_t endpoint, uint8_t mode, uint8_t size, uint16_t transition_time, bool with_on_off);
+void firmware_stop(uint8_t endpoint, bool with_on_off);
+void firmware_move_to_closest_frequency(uint8_t endpoint, uint16_t frequency);
+
+void firmware_on_off(uint8_t endpoint, uint8_t command);
+
+uint8_t firmware_current_level_get(uint8_t endpoint);
+
+#endif /* FIRMWARE_H_ */
@@ -0,0 +1,1115 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_gpio.h"
+#include "em_timer.h"
+#include "em_letimer.h"
+#include "em_i2c.h"
+#include "em_usart.h"
+#include "dmadrv.h"
+#include "sl_power_manager.h"
+
+#include <sys/mman.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    bool        pwm;                /* CC channel is in PWM mode */
+    bool        invert;
+    bool        out;                /* compare output before inversion */
+    bool        ocb_valid;
+    bool        recording;
+    bool        from_overflow;      /* period record started on overflow */
+    ModelPeriod period;
+
+} ModelCc;
+
+typedef struct
+{
+    TIMER_TypeDef       *regs;
+    CMU_Clock_TypeDef   clock;
+    IRQn_Type           irq;
+    bool                started;
+    bool                topb_valid;
+    uint32_t            overflows;
+    ModelCc             cc[3];
+
+} ModelTimer;
+
+typedef enum
+{
+    ModelI2cState_Idle,
+    ModelI2cState_Running,
+    ModelI2cState_Complete,
+
+} ModelI2cState;
+
+/* I2C1 with register file device, written bytes are applied at transfer end */
+typedef struct
+{
+    ModelI2cState       state;
+    uint32_t            freq;
+    uint64_t            done;
+    uint8_t             data[256];
+    uint16_t            len;
+    uint8_t             addr;
+    uint8_t             regs[256];
+    ModelI2cTransfer    *log;
+    size_t              log_count;
+    size_t              log_size;
+
+} ModelI2c;
+
+/* LDMA ping-pong transfer to USART TXDATA, buffer takes its bits at USART baud rate */
+typedef struct
+{
+    bool                active;
+    bool                cb_pending;
+    DMADRV_Callback_t   cb;
+    void                *user;
+    unsigned int        channel;
+    uint8_t             *src[2];
+    uint32_t            len;
+    uint32_t            remaining;          /* items left in buffer at stop */
+    unsigned int        seq;                /* buffers completed */
+    uint64_t            done;
+    uint32_t            baudrate;
+    uint8_t             *stream;            /* bytes sent to USART */
+    size_t              stream_len;
+    size_t              stream_size;
+    uint32_t            callbacks;
+    uint64_t            cb_ns;              /* host time spent in callbacks */
+
+} ModelDma;
+
+typedef struct
+{
+    uint64_t        time;
+    ModelTimer      timers[TIMER_COUNT];
+    bool            clocks[MODEL_CLOCK_COUNT];
+    bool            irq_enabled[MODEL_IRQ_COUNT];
+    bool            masked;             /* PRIMASK */
+    bool            in_irq;             /* handler runs, calls take no time */
+    uint32_t        gpio_in[4];
+    int32_t         em1;
+    ModelPeriodCb   period_cb;
+    ModelI2c        i2c;
+    ModelDma        dma;
+
+} ModelCtx;
+
+static ModelCtx model;
+
+__attribute__((weak)) void TIMER0_IRQHandler(void) {}
+__attribute__((weak)) void TIMER1_IRQHandler(void) {}
+__attribute__((weak)) void TIMER2_IRQHandler(void) {}
+__attribute__((weak)) void TIMER3_IRQHandler(void) {}
+__attribute__((weak)) void LETIMER0_IRQHandler(void) {}
+__attribute__((weak)) void I2C1_IRQHandler(void) {}
+__attribute__((weak)) void LDMA_IRQHandler(void) {}
+
+static void (* const model_irq_handlers[MODEL_IRQ_COUNT])(void) =
+{
+    TIMER0_IRQHandler,
+    TIMER1_IRQHandler,
+    TIMER2_IRQHandler,
+    TIMER3_IRQHandler,
+    LETIMER0_IRQHandler,
+    I2C1_IRQHandler,
+    LDMA_IRQHandler,
+};
+
+/* peripherals are mapped at their addresses before firmware is started */
+__attribute__((constructor)) static void model_map(void)
+{
+    void *base = mmap((void *)MODEL_PERIPH_BASE, MODEL_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (base != (void *)MODEL_PERIPH_BASE)
+    {
+        fprintf(stderr, "model: peripheral window 0x%08lX can't be mapped\n", MODEL_PERIPH_BASE);
+        exit(2);
+    }
+
+    model_reset();
+}
+
+void model_reset(void)
+{
+    static const CMU_Clock_TypeDef clocks[TIMER_COUNT] =
+    {
+        cmuClock_TIMER0, cmuClock_TIMER1, cmuClock_TIMER2, cmuClock_TIMER3
+    };
+    static const IRQn_Type irqs[TIMER_COUNT] =
+    {
+        TIMER0_IRQn, TIMER1_IRQn, TIMER2_IRQn, TIMER3_IRQn
+    };
+    TIMER_TypeDef * const regs[TIMER_COUNT] = { TIMER0, TIMER1, TIMER2, TIMER3 };
+
+    ModelI2cTransfer *log = model.i2c.log;
+    size_t log_size = model.i2c.log_size;
+    uint8_t *stream = model.dma.stream;
+    size_t stream_size = model.dma.stream_size;
+
+    memset((void *)MODEL_PERIPH_BASE, 0, MODEL_PERIPH_SIZE);
+    memset(&model, 0, sizeof(model));
+    model.i2c.log = log;
+    model.i2c.log_size = log_size;
+    model.dma.stream = stream;
+    model.dma.stream_size = stream_size;
+
+    for (unsigned int i = 0; i < TIMER_COUNT; i++)
+    {
+        model.timers[i].regs = regs[i];
+        model.timers[i].clock = clocks[i];
+        model.timers[i].irq = irqs[i];
+        regs[i]->TOP = TIMER_MAX_COUNT(regs[i]);
+    }
+}
+
+void model_period_cb_set(ModelPeriodCb cb)
+{
+    model.period_cb = cb;
+}
+
+uint64_t model_time_get(void)
+{
+    return model.time;
+}
+
+void model_gpio_input_set(GPIO_Port_TypeDef port, unsigned int pin, bool level)
+{
+    model.gpio_in[port] = (model.gpio_in[port] & ~(1UL << pin)) | ((uint32_t)level << pin);
+}
+
+bool model_clock_enabled(CMU_Clock_TypeDef clock)
+{
+    return model.clocks[clock];
+}
+
+uint32_t model_timer_overflows_get(unsigned int timer)
+{
+    return model.timers[timer].overflows;
+}
+
+int32_t model_em1_requirements_get(void)
+{
+    return model.em1;
+}
+
+static ModelTimer* model_timer_get(TIMER_TypeDef *timer)
+{
+    return &model.timers[TIMER_NUM(timer)];
+}
+
+static unsigned int model_timer_num(const ModelTimer *t)
+{
+    return (unsigned int)(t - model.timers);
+}
+
+static bool model_timer_counting(const ModelTimer *t)
+{
+    return t->started && (t->regs->EN & TIMER_EN_EN) != 0 && model.clocks[t->clock];
+}
+
+/*
+ *  Period records
+ */
+static void model_period_start(ModelTimer *t, unsigned int ch, bool from_overflow, uint64_t time)
+{
+    ModelCc *cc = &t->cc[ch];
+
+    memset(&cc->period, 0, sizeof(cc->period));
+    cc->period.timer = (uint8_t)model_timer_num(t);
+    cc->period.cc = (uint8_t)ch;
+    cc->period.start = time;
+    cc->period.oc[0] = t->regs->CC[ch].OC;
+    cc->period.oc_count = 1;
+    cc->recording = true;
+    cc->from_overflow = from_overflow;
+}
+
+static void model_period_end(ModelTimer *t, unsigned int ch, bool by_overflow)
+{
+    ModelCc *cc = &t->cc[ch];
+    unsigned int num = model_timer_num(t);
+
+    if (cc->recording == false)
+    {
+        return;
+    }
+
+    cc->recording = false;
+    cc->period.full = cc->from_overflow && by_overflow;
+    cc->period.invert = cc->invert;
+    cc->period.routed = (GPIO->TIMERROUTE[num].ROUTEEN & (1UL << ch)) != 0;
+
+    if (cc->period.counts > 0 && model.period_cb != NULL)
+    {
+        model.period_cb(&cc->period);
+    }
+}
+
+static void model_periods_restart(ModelTimer *t, bool end, bool start)
+{
+    for (unsigned int ch = 0; ch < 3; ch++)
+    {
+        if (end)
+        {
+            model_period_end(t, ch, false);
+        }
+
+        if (start && t->cc[ch].pwm)
+        {
+            model_period_start(t, ch, false, model.time);
+        }
+    }
+}
+
+static void model_period_oc_add(ModelTimer *t, unsigned int ch, uint32_t oc)
+{
+    ModelPeriod *p = &t->cc[ch].period;
+
+    if (t->cc[ch].recording == false || p->oc[p->oc_count - 1] == oc)
+    {
+        return;
+    }
+
+    if (p->oc_count < MODEL_PERIOD_OC_MAX)
+    {
+        p->oc_count++;
+    }
+
+    p->oc[p->oc_count - 1] = oc;
+}
+
+/*
+ *  TIMER stepping
+ */
+
+/* pin level of CC channel, routed output or GPIO data register */
+static bool model_cc_pin_get(ModelTimer *t, unsigned int ch, bool out)
+{
+    unsigned int num = model_timer_num(t);
+
+    if ((GPIO->TIMERROUTE[num].ROUTEEN & (1UL << ch)) != 0)
+    {
+        return out != t->cc[ch].invert;
+    }
+
+    uint32_t route = (&GPIO->TIMERROUTE[num].CC0ROUTE)[ch];
+    uint32_t port = (route >> _GPIO_TIMER_CC0ROUTE_PORT_SHIFT) & 0x3;
+    uint32_t pin = (route >> _GPIO_TIMER_CC0ROUTE_PIN_SHIFT) & 0xF;
+
+    return ((GPIO->P[port].DOUT >> pin) & 1) != 0;
+}
+
+bool model_pin_get(unsigned int timer, unsigned int cc)
+{
+    ModelTimer *t = &model.timers[timer];
+
+    return model_cc_pin_get(t, cc, t->cc[cc].out);
+}
+
+/**
+ * @brief
+ *  Counts n cycles of counter values [cnt, cnt + n), overflow is not crossed.
+ *  Compare match clears output on entering OC, the last one entered is cnt + n.
+ */
+static void model_timer_count(ModelTimer *t, uint32_t cnt, uint32_t n)
+{
+    for (unsigned int ch = 0; ch < 3; ch++)
+    {
+        ModelCc *cc = &t->cc[ch];
+
+        if (cc->pwm == false)
+        {
+            continue;
+        }
+
+        uint32_t oc = t->regs->CC[ch].OC;
+        uint32_t out_counts = 0;
+        bool routed = (GPIO->TIMERROUTE[model_timer_num(t)].ROUTEEN & (1UL << ch)) != 0;
+
+        if (cc->out)
+        {
+            if (oc > cnt && oc <= cnt + n)
+            {
+                out_counts = oc - cnt;
+                cc->out = false;
+            }
+            else
+            {
+                out_counts = n;
+            }
+        }
+
+        /* output which follows OC at every count */
+        uint32_t ideal_end = oc < cnt + n ? oc : cnt + n;
+        uint32_t ideal_counts = ideal_end > cnt ? ideal_end - cnt : 0;
+
+        if (cc->recording == false)
+        {
+            continue;
+        }
+
+        cc->period.counts += n;
+        cc->period.ideal_high += cc->invert ? n - ideal_counts : ideal_counts;
+
+        if (routed)
+        {
+            cc->period.high += cc->invert ? n - out_counts : out_counts;
+        }
+        else if (model_cc_pin_get(t, ch, false))
+        {
+            cc->period.high += n;
+        }
+    }
+}
+
+static void model_timer_overflow(ModelTimer *t, uint64_t time)
+{
+    TIMER_TypeDef *regs = t->regs;
+
+    for (unsigned int ch = 0; ch < 3; ch++)
+    {
+        model_period_end(t, ch, true);
+    }
+
+    regs->CNT = 0;
+
+    if (t->topb_valid)
+    {
+        regs->TOP = regs->TOPB;
+        t->topb_valid = false;
+    }
+
+    for (unsigned int ch = 0; ch < 3; ch++)
+    {
+        ModelCc *cc = &t->cc[ch];
+
+        if (cc->ocb_valid)
+        {
+            regs->CC[ch].OC = regs->CC[ch].OCB;
+            cc->ocb_valid = false;
+        }
+
+        /* output is set on overflow, zero compare matches at once */
+        cc->out = regs->CC[ch].OC != 0;
+
+        if (cc->pwm)
+        {
+            model_period_start(t, ch, true, time);
+        }
+    }
+
+    regs->IF |= TIMER_IF_OF;
+    t->overflows++;
+}
+
+static void model_timer_run(ModelTimer *t, uint64_t counts)
+{
+    TIMER_TypeDef *regs = t->regs;
+    uint64_t time = model.time;
+
+    while (counts > 0)
+    {
+        uint32_t top = regs->TOP;
+        uint32_t cnt = regs->CNT;
+
+        if (cnt >= top)
+        {
+            model_timer_count(t, cnt, 1);
+            model_timer_overflow(t, ++time);
+            counts--;
+            continue;
+        }
+
+        uint32_t n = counts < top - cnt ? (uint32_t)counts : top - cnt;
+
+        model_timer_count(t, cnt, n);
+        regs->CNT = cnt + n;
+        counts -= n;
+        time += n;
+    }
+}
+
+/* counts till the next overflow of the TIMER */
+static uint64_t model_timer_overflow_distance(const ModelTimer *t)
+{
+    uint32_t top = t->regs->TOP;
+    uint32_t cnt = t->regs->CNT;
+
+    return cnt >= top ? 1 : (uint64_t)(top - cnt) + 1;
+}
+
+static void model_i2c_complete(void)
+{
+    ModelI2c *i2c = &model.i2c;
+    uint8_t reg = i2c->data[0];
+
+    /* auto increment as with PCA9685 MODE1.AI, else every byte goes to the same register */
+    for (uint16_t i = 1; i < i2c->len; i++)
+    {
+        i2c->regs[reg] = i2c->data[i];
+
+        if ((i2c->regs[0] & 0x20) != 0)
+        {
+            reg++;
+        }
+    }
+
+    i2c->log[i2c->log_count - 1].end = model.time;
+    i2c->state = ModelI2cState_Complete;
+    I2C1->IF |= 1;
+}
+
+static void model_i2c_irq_deliver(void)
+{
+    if (model.i2c.state != ModelI2cState_Complete || model.irq_enabled[I2C1_IRQn] == false)
+    {
+        return;
+    }
+
+    model.in_irq = true;
+    model_irq_handlers[I2C1_IRQn]();
+    model.in_irq = false;
+
+    if (model.i2c.state == ModelI2cState_Complete)
+    {
+        fprintf(stderr, "model: I2C transfer not finished by handler\n");
+        model.i2c.state = ModelI2cState_Idle;
+    }
+}
+
+static uint64_t model_dma_buffer_counts(void)
+{
+    return ((uint64_t)model.dma.len * 8 * MODEL_HFCLK_HZ + model.dma.baudrate - 1) / model.dma.baudrate;
+}
+
+/* buffer is sent, the other one is started at once and callback is requested */
+static void model_dma_complete(void)
+{
+    ModelDma *dma = &model.dma;
+    uint8_t *src = dma->src[dma->seq & 1];
+
+    if (dma->stream_len + dma->len > dma->stream_size)
+    {
+        dma->stream_size = (dma->stream_size + dma->len) * 2;
+        dma->stream = realloc(dma->stream, dma->stream_size);
+    }
+
+    memcpy(&dma->stream[dma->stream_len], src, dma->len);
+    dma->stream_len += dma->len;
+    dma->seq++;
+    dma->done = model.time + model_dma_buffer_counts();
+    dma->cb_pending = true;
+}
+
+static void model_dma_irq_deliver(void)
+{
+    ModelDma *dma = &model.dma;
+    struct timespec start;
+    struct timespec end;
+
+    if (dma->cb_pending == false)
+    {
+        return;
+    }
+
+    dma->cb_pending = false;
+
+    model.in_irq = true;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool more = dma->cb(dma->channel, dma->seq, dma->user);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    model.in_irq = false;
+
+    dma->callbacks++;
+    dma->cb_ns += (uint64_t)((end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec));
+
+    /* buffer in progress is dropped */
+    if (more == false)
+    {
+        dma->active = false;
+    }
+}
+
+static void model_irq_deliver(void)
+{
+    if (model.masked || model.in_irq)
+    {
+        return;
+    }
+
+    for (unsigned int i = 0; i < TIMER_COUNT; i++)
+    {
+        ModelTimer *t = &model.timers[i];
+
+        if ((t->regs->IF & t->regs->IEN) == 0 || model.irq_enabled[t->irq] == false)
+        {
+            continue;
+        }
+
+        model.in_irq = true;
+        model_irq_handlers[t->irq]();
+        model.in_irq = false;
+
+        /* level triggered, handler which doesn't clear flag would be called forever */
+        if ((t->regs->IF & t->regs->IEN) != 0)
+        {
+            fprintf(stderr, "model: TIMER%u interrupt flag not cleared by handler\n", i);
+            t->regs->IF = 0;
+        }
+    }
+
+    model_i2c_irq_deliver();
+    model_dma_irq_deliver();
+}
+
+static void model_fold(void)
+{
+    for (unsigned int i = 0; i < TIMER_COUNT; i++)
+    {
+        TIMER_TypeDef *regs = model.timers[i].regs;
+
+        regs->EN = (regs->EN | regs->EN_SET) & ~regs->EN_CLR;
+        regs->EN_SET = 0;
+        regs->EN_CLR = 0;
+
+        GPIO->TIMERROUTE[i].ROUTEEN = (GPIO->TIMERROUTE[i].ROUTEEN | GPIO->TIMERROUTE_SET[i].ROUTEEN) &
+                                      ~GPIO->TIMERROUTE_CLR[i].ROUTEEN;
+        GPIO->TIMERROUTE_SET[i].ROUTEEN = 0;
+        GPIO->TIMERROUTE_CLR[i].ROUTEEN = 0;
+    }
+}
+
+void model_advance_to(uint64_t time)
+{
+    model_fold();
+
+    while (model.time < time)
+    {
+        uint64_t step = time - model.time;
+
+        /* TIMER with overflow interrupt is stopped at each overflow */
+        for (unsigned int i = 0; i < TIMER_COUNT; i++)
+        {
+            ModelTimer *t = &model.timers[i];
+
+            if (model_timer_counting(t) && (t->regs->IEN & TIMER_IEN_OF) != 0 && model.irq_enabled[t->irq])
+            {
+                uint64_t distance = model_timer_overflow_distance(t);
+
+                step = distance < step ? distance : step;
+            }
+        }
+
+        if (model.i2c.state == ModelI2cState_Running && model.i2c.done - model.time < step)
+        {
+            step = model.i2c.done - model.time;
+        }
+
+        if (model.dma.active && model.dma.done - model.time < step)
+        {
+            step = model.dma.done - model.time;
+        }
+
+        for (unsigned int i = 0; i < TIMER_COUNT; i++)
+        {
+            if (model_timer_counting(&model.timers[i]))
+            {
+                model_timer_run(&model.timers[i], step);
+            }
+        }
+
+        model.time += step;
+
+        if (model.i2c.state == ModelI2cState_Running && model.time >= model.i2c.done)
+        {
+            model_i2c_complete();
+        }
+
+        if (model.dma.active && model.time >= model.dma.done)
+        {
+            model_dma_complete();
+        }
+
+        model_irq_deliver();
+    }
+}
+
+void model_call(void)
+{
+    model_fold();
+
+    /* handler runs at the moment of interrupt */
+    if (model.in_irq == false)
+    {
+        model_advance_to(model.time + MODEL_CALL_COUNTS);
+    }
+}
+
+/*
+ *  CORE, NVIC
+ */
+CORE_irqState_t CORE_EnterCritical(void)
+{
+    CORE_irqState_t state = model.masked;
+
+    model.masked = true;
+
+    return state;
+}
+
+void CORE_ExitCritical(CORE_irqState_t irq_state)
+{
+    model.masked = irq_state != 0;
+    model_irq_deliver();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    model.irq_enabled[irq] = true;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    model.irq_enabled[irq] = false;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    (void)irq;
+}
+
+/*
+ *  CMU, GPIO, power manager
+ */
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+    model_call();
+    model.clocks[clock] = enable;
+}
+
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock)
+{
+    return clock == cmuClock_LETIMER0 ? MODEL_LFCLK_HZ : MODEL_HFCLK_HZ;
+}
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out)
+{
+    model_call();
+    GPIO->P[port].MODEL = (GPIO->P[port].MODEL & ~(0xFUL << (pin * 4))) | ((uint32_t)mode << (pin * 4));
+
+    if (out)
+    {
+        GPIO->P[port].DOUT |= 1UL << pin;
+    }
+    else
+    {
+        GPIO->P[port].DOUT &= ~(1UL << pin);
+    }
+}
+
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+    model_call();
+    return (model.gpio_in[port] >> pin) & 1;
+}
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+    model_call();
+    GPIO->P[port].DOUT |= 1UL << pin;
+}
+
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin)
+{
+    model_call();
+    GPIO->P[port].DOUT &= ~(1UL << pin);
+}
+
+void sl_power_manager_add_em_requirement(sl_power_manager_em_t em)
+{
+    model.em1 += em == SL_POWER_MANAGER_EM1;
+}
+
+void sl_power_manager_remove_em_requirement(sl_power_manager_em_t em)
+{
+    model.em1 -= em == SL_POWER_MANAGER_EM1;
+}
+
+/*
+ *  TIMER
+ */
+void TIMER_Init(TIMER_TypeDef *timer, const TIMER_Init_TypeDef *init)
+{
+    ModelTimer *t = model_timer_get(timer);
+
+    model_call();
+    timer->CTRL = init->mode;
+
+    if (init->enable && t->started == false)
+    {
+        t->started = true;
+        model_periods_restart(t, false, true);
+    }
+}
+
+void TIMER_InitCC(TIMER_TypeDef *timer, unsigned int ch, const TIMER_InitCC_TypeDef *init)
+{
+    ModelTimer *t = model_timer_get(timer);
+
+    model_call();
+    timer->CC[ch].CTRL = init->outInvert ? 1 : 0;
+    timer->CC[ch].CFG = init->mode;
+    t->cc[ch].invert = init->outInvert;
+    t->cc[ch].pwm = init->mode == timerCCModePWM;
+}
+
+void TIMER_Enable(TIMER_TypeDef *timer, bool enable)
+{
+    ModelTimer *t = model_timer_get(timer);
+
+    model_call();
+
+    if (enable == t->started)
+    {
+        return;
+    }
+
+    t->started = enable;
+    model_periods_restart(t, true, enable);
+}
+
+void TIMER_SyncWait(TIMER_TypeDef *timer)
+{
+    (void)timer;
+    model_call();
+}
+
+void TIMER_TopSet(TIMER_TypeDef *timer, uint32_t val)
+{
+    model_call();
+    timer->TOP = val;
+}
+
+void TIMER_TopBufSet(TIMER_TypeDef *timer, uint32_t val)
+{
+    model_call();
+    timer->TOPB = val;
+    model_timer_get(timer)->topb_valid = true;
+}
+
+uint32_t TIMER_TopGet(TIMER_TypeDef *timer)
+{
+    model_call();
+    return timer->TOP;
+}
+
+uint32_t TIMER_CounterGet(TIMER_TypeDef *timer)
+{
+    model_call();
+    return timer->CNT;
+}
+
+void TIMER_CounterSet(TIMER_TypeDef *timer, uint32_t val)
+{
+    ModelTimer *t = model_timer_get(timer);
+
+    model_call();
+    model_periods_restart(t, true, false);
+    timer->CNT = val;
+    model_periods_restart(t, false, t->started);
+}
+
+void TIMER_CompareSet(TIMER_TypeDef *timer, unsigned int ch, uint32_t val)
+{
+    model_call();
+    timer->CC[ch].OC = val;
+    model_period_oc_add(model_timer_get(timer), ch, val);
+}
+
+void TIMER_CompareBufSet(TIMER_TypeDef *timer, unsigned int ch, uint32_t val)
+{
+    model_call();
+    timer->CC[ch].OCB = val;
+    model_timer_get(timer)->cc[ch].ocb_valid = true;
+}
+
+uint32_t TIMER_MaxCount(TIMER_TypeDef *timer)
+{
+    return TIMER_MAX_COUNT(timer);
+}
+
+void TIMER_IntEnable(TIMER_TypeDef *timer, uint32_t flags)
+{
+    model_call();
+    timer->IEN |= flags;
+}
+
+void TIMER_IntDisable(TIMER_TypeDef *timer, uint32_t flags)
+{
+    model_call();
+    timer->IEN &= ~flags;
+}
+
+void TIMER_IntClear(TIMER_TypeDef *timer, uint32_t flags)
+{
+    model_call();
+    timer->IF &= ~flags;
+}
+
+/*
+ *  LETIMER, registers are kept only
+ */
+void LETIMER_Init(LETIMER_TypeDef *letimer, const LETIMER_Init_TypeDef *init)
+{
+    model_call();
+    letimer->TOP = init->topValue;
+    letimer->EN = init->enable;
+}
+
+void LETIMER_Enable(LETIMER_TypeDef *letimer, bool enable)
+{
+    model_call();
+    letimer->EN = enable;
+}
+
+void LETIMER_TopSet(LETIMER_TypeDef *letimer, uint32_t value)
+{
+    model_call();
+    letimer->TOP = value;
+}
+
+void LETIMER_CompareSet(LETIMER_TypeDef *letimer, unsigned int comp, uint32_t value)
+{
+    model_call();
+
+    if (comp == 0)
+    {
+        letimer->COMP0 = value;
+    }
+    else
+    {
+        letimer->COMP1 = value;
+    }
+}
+
+void LETIMER_CounterSet(LETIMER_TypeDef *letimer, uint32_t value)
+{
+    model_call();
+    letimer->CNT = value;
+}
+
+/*
+ *  I2C
+ */
+void I2C_Init(I2C_TypeDef *i2c, const I2C_Init_TypeDef *init)
+{
+    model_call();
+    model.i2c.freq = init->freq;
+}
+
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c, I2C_TransferSeq_TypeDef *seq)
+{
+    ModelI2c *m = &model.i2c;
+
+    model_call();
+
+    if (m->state != ModelI2cState_Idle || seq->buf[0].len == 0 || seq->buf[0].len > sizeof(m->data) ||
+        (seq->flags & I2C_FLAG_WRITE) == 0 || m->freq == 0)
+    {
+        return i2cTransferUsageFault;
+    }
+
+    memcpy(m->data, seq->buf[0].data, seq->buf[0].len);
+    m->len = seq->buf[0].len;
+    m->addr = (uint8_t)(seq->addr >> 1);
+
+    /* START, address and data bytes with ACK bits, STOP */
+    uint64_t bits = 2 + 9 * (1 + (uint64_t)m->len);
+
+    m->done = model.time + (bits * MODEL_HFCLK_HZ + m->freq - 1) / m->freq;
+    m->state = ModelI2cState_Running;
+
+    if (m->log_count == m->log_size)
+    {
+        m->log_size = m->log_size != 0 ? m->log_size * 2 : 64;
+        m->log = realloc(m->log, m->log_size * sizeof(ModelI2cTransfer));
+    }
+
+    m->log[m->log_count++] = (ModelI2cTransfer)
+    {
+        .addr = m->addr,
+        .reg = m->data[0],
+        .len = m->len,
+        .start = model.time,
+    };
+
+    return i2cTransferInProgress;
+}
+
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c)
+{
+    model_call();
+
+    switch (model.i2c.state)
+    {
+    case ModelI2cState_Running:
+        return i2cTransferInProgress;
+
+    case ModelI2cState_Complete:
+        model.i2c.state = ModelI2cState_Idle;
+        I2C1->IF = 0;
+        return i2cTransferDone;
+
+    default:
+        return i2cTransferUsageFault;
+    }
+}
+
+size_t model_i2c_transfers_get(const ModelI2cTransfer **transfers)
+{
+    *transfers = model.i2c.log;
+    return model.i2c.log_count;
+}
+
+void model_i2c_transfers_clear(void)
+{
+    model.i2c.log_count = 0;
+}
+
+bool model_i2c_busy(void)
+{
+    return model.i2c.state != ModelI2cState_Idle;
+}
+
+const uint8_t* model_i2c_regs_get(void)
+{
+    return model.i2c.regs;
+}
+
+/*
+ *  USART, DMADRV
+ */
+void USART_InitSync(USART_TypeDef *usart, const USART_InitSync_TypeDef *init)
+{
+    model_call();
+    model.dma.baudrate = init->baudrate;
+}
+
+Ecode_t DMADRV_Init(void)
+{
+    return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_AllocateChannel(unsigned int *channelId, void *capabilities)
+{
+    *channelId = 0;
+    return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_MemoryPeripheral(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                void *dst, void *src, bool srcInc, int len, DMADRV_DataSize_t size,
+                                DMADRV_Callback_t callback, void *cbUserParam)
+{
+    /* only ping-pong transfer to USART is modeled */
+    return ECODE_EMDRV_DMADRV_OK + 1;
+}
+
+Ecode_t DMADRV_MemoryPeripheralPingPong(unsigned int channelId, DMADRV_PeripheralSignal_t peripheralSignal,
+                                        void *dst, void *src0, void *src1, bool srcInc, int len,
+                                        DMADRV_DataSize_t size, DMADRV_Callback_t callback,
+                                        void *cbUserParam)
+{
+    ModelDma *dma = &model.dma;
+
+    model_call();
+
+    if (dma->active || peripheralSignal != dmadrvPeripheralSignal_USART1_TXBL || dma->baudrate == 0 || len <= 0)
+    {
+        return ECODE_EMDRV_DMADRV_OK + 1;
+    }
+
+    dma->active = true;
+    dma->cb_pending = false;
+    dma->cb = callback;
+    dma->user = cbUserParam;
+    dma->channel = channelId;
+    dma->src[0] = src0;
+    dma->src[1] = src1;
+    dma->len = (uint32_t)len;
+    dma->seq = 0;
+    dma->done = model.time + model_dma_buffer_counts();
+
+    return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_StopTransfer(unsigned int channelId)
+{
+    ModelDma *dma = &model.dma;
+
+    /* items of the buffer in progress not sent yet, USART takes them at baud rate */
+    dma->remaining = 0;
+    if (dma->active && dma->done > model.time)
+    {
+        dma->remaining = (uint32_t)((dma->done - model.time) * dma->len / model_dma_buffer_counts());
+    }
+
+    dma->active = false;
+    dma->cb_pending = false;
+
+    return ECODE_EMDRV_DMADRV_OK;
+}
+
+Ecode_t DMADRV_TransferRemainingCount(unsigned int channelId, int *remaining)
+{
+    *remaining = (int)model.dma.remaining;
+
+    return ECODE_EMDRV_DMADRV_OK;
+}
+
+size_t model_usart_stream_get(const uint8_t **stream)
+{
+    *stream = model.dma.stream;
+    return model.dma.stream_len;
+}
+
+void model_usart_stream_clear(void)
+{
+    model.dma.stream_len = 0;
+}
+
+bool model_dma_busy(void)
+{
+    return model.dma.active;
+}
+
+void model_dma_stats_get(uint32_t *callbacks, uint64_t *host_ns)
+{
+    *callbacks = model.dma.callbacks;
+    *host_ns = model.dma.cb_ns;
+}
@@ -0,0 +1,96 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Register model of EFR32MG21 peripherals used by the firmware. Time is
+ * counted in HFCLK cycles and advanced by emlib calls (every call takes
+ * MODEL_CALL_COUNTS cycles) and by the event loop of stack.c. TIMERs are
+ * stepped from overflow to overflow, pin level of every PWM channel is
+ * integrated over the period and reported by period callback. */
+
+#ifndef MODEL_H_
+#define MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+
+#define MODEL_HFCLK_HZ          80000000UL
+#define MODEL_LFCLK_HZ          32768UL
+#define MODEL_CALL_COUNTS       8
+#define MODEL_COUNTS_PER_MS     (MODEL_HFCLK_HZ / 1000)
+
+/* compare values written in one period, more are counted in the last one */
+#define MODEL_PERIOD_OC_MAX     4
+
+typedef struct
+{
+    uint8_t     timer;                      /* TIMER number */
+    uint8_t     cc;                         /* CC channel */
+    uint64_t    start;                      /* HFCLK cycle of period start */
+    uint32_t    counts;                     /* counts of period (TOP + 1 when full) */
+    uint32_t    high;                       /* counts of high pin level */
+    uint32_t    ideal_high;                 /* counts of high pin following OC at each count */
+    uint32_t    oc[MODEL_PERIOD_OC_MAX];    /* OC latched on overflow, then values written directly */
+    uint8_t     oc_count;
+    bool        full;                       /* started on overflow, ended on the next one */
+    bool        invert;                     /* output inversion at period end */
+    bool        routed;                     /* pin routed at period end */
+
+} ModelPeriod;
+
+typedef void (*ModelPeriodCb)(const ModelPeriod *period);
+
+typedef struct
+{
+    uint8_t     addr;                       /* 7-bit address */
+    uint8_t     reg;                        /* first written byte */
+    uint16_t    len;                        /* written bytes without address */
+    uint64_t    start;
+    uint64_t    end;                        /* HFCLK cycle of STOP, 0 while running */
+
+} ModelI2cTransfer;
+
+void model_reset(void);
+void model_period_cb_set(ModelPeriodCb cb);
+
+/* called by every emlib function, folds SET/CLR aliases and takes time */
+void model_call(void);
+void model_advance_to(uint64_t time);
+uint64_t model_time_get(void);
+
+void model_gpio_input_set(GPIO_Port_TypeDef port, unsigned int pin, bool level);
+bool model_clock_enabled(CMU_Clock_TypeDef clock);
+uint32_t model_timer_overflows_get(unsigned int timer);
+bool model_pin_get(unsigned int timer, unsigned int cc);
+int32_t model_em1_requirements_get(void);
+
+size_t model_i2c_transfers_get(const ModelI2cTransfer **transfers);
+void model_i2c_transfers_clear(void);
+bool model_i2c_busy(void);
+const uint8_t* model_i2c_regs_get(void);
+
+size_t model_usart_stream_get(const uint8_t **stream);
+void model_usart_stream_clear(void);
+bool model_dma_busy(void);
+void model_dma_stats_get(uint32_t *callbacks, uint64_t *host_ns);
+
+#endif /* MODEL_H_ */
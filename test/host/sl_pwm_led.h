@@ -0,0 +1,56 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SL_PWM_LED_H_
+#define SL_PWM_LED_H_
+
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_timer.h"
+#include "sl_status.h"
+
+#define EFM_ASSERT(expr)    ((void)(expr))
+
+#define PWM_ACTIVE_HIGH     0
+#define PWM_ACTIVE_LOW      1
+
+typedef void (*sl_led_set_color_t)(void *context, uint16_t color);
+typedef void (*sl_led_get_color_t)(void *context, uint16_t *color);
+
+typedef struct
+{
+    sl_led_set_color_t  set_color;
+    sl_led_get_color_t  get_color;
+    uint8_t             port;
+    uint8_t             pin;
+    uint16_t            level;
+    uint8_t             polarity;
+    uint8_t             channel;
+    TIMER_TypeDef       *timer;
+    uint32_t            frequency;
+    uint32_t            resolution;
+
+} sl_led_pwm_t;
+
+sl_status_t sl_pwm_led_init(void *led_handle);
+void sl_pwm_led_start(void *led_handle);
+void sl_pwm_led_stop(void *led_handle);
+void sl_pwm_led_set_color(void *led_handle, uint16_t color);
+void sl_pwm_led_get_color(void *led_handle, uint16_t *color);
+
+#endif /* SL_PWM_LED_H_ */
@@ -0,0 +1,32 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SL_SERVICE_FUNCTION_H_
+#define SL_SERVICE_FUNCTION_H_
+
+#include <stdint.h>
+
+typedef uint8_t sl_service_opcode_t;
+
+typedef struct
+{
+    void    *data;
+
+} sl_service_function_context_t;
+
+#endif /* SL_SERVICE_FUNCTION_H_ */
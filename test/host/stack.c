@@ -0,0 +1,504 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "stack.h"
+#include "model.h"
+#include "app.h"
+#include "zigbee_app_framework_event.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STACK_ATTRIBUTES_MAX    256
+#define STACK_ATTRIBUTE_SIZE    8
+#define STACK_RESPONSE_MAX      64
+
+typedef struct
+{
+    uint8_t             endpoint;
+    EmberAfClusterId    cluster;
+    EmberAfAttributeId  attribute;
+    uint8_t             size;
+    uint8_t             data[STACK_ATTRIBUTE_SIZE];
+
+} StackAttribute;
+
+typedef struct
+{
+    size_t      size;
+    size_t      count;
+    const void  *def;
+
+} StackTokenDef;
+
+#define DEFINE_BASIC_TOKEN(name, type, ...)                 \
+    [TOKEN_##name] = { sizeof(type), 1, (const type[]){ __VA_ARGS__ } },
+#define DEFINE_INDEXED_TOKEN(name, type, arraysize, ...)    \
+    [TOKEN_##name] = { sizeof(type), arraysize, (const type[]){ __VA_ARGS__ } },
+
+static const StackTokenDef stack_token_defs[MODEL_TOKEN_COUNT] =
+{
+#define DEFINETOKENS
+#include "sl_custom_token_header.h"
+#undef DEFINETOKENS
+};
+
+#undef DEFINE_BASIC_TOKEN
+#undef DEFINE_INDEXED_TOKEN
+
+typedef struct
+{
+    sl_zigbee_event_t   *events;
+    uint32_t            wakeups;
+    uint8_t             *tokens[MODEL_TOKEN_COUNT];
+    uint32_t            token_writes[MODEL_TOKEN_COUNT];
+    StackAttribute      attributes[STACK_ATTRIBUTES_MAX];
+    size_t              attribute_count;
+    bool                endpoints[APP_EP_COUNT + 1];
+    uint8_t             response[STACK_RESPONSE_MAX];   /* filled ZCL frame */
+    size_t              response_len;
+    size_t              response_sent;                  /* length of the last sent frame */
+    EmberAfStatus       default_status;
+    bool                default_sent;
+
+} StackCtx;
+
+static StackCtx stack;
+
+EmberAfClusterCommand *emAfCurrentCommand;
+
+static uint32_t stack_now_ms(void)
+{
+    return (uint32_t)(model_time_get() / MODEL_COUNTS_PER_MS);
+}
+
+/*
+ *  Events
+ */
+void sl_zigbee_event_init(sl_zigbee_event_t *event, void (*handler)(sl_zigbee_event_t *event))
+{
+    event->handler = handler;
+    event->active = false;
+
+    if (event->linked == false)
+    {
+        event->next = stack.events;
+        event->linked = true;
+        stack.events = event;
+    }
+}
+
+void sl_zigbee_event_set_active(sl_zigbee_event_t *event)
+{
+    sl_zigbee_event_set_delay_ms(event, 0);
+}
+
+void sl_zigbee_event_set_inactive(sl_zigbee_event_t *event)
+{
+    event->active = false;
+}
+
+void sl_zigbee_event_set_delay_ms(sl_zigbee_event_t *event, uint32_t delay)
+{
+    event->deadline_ms = stack_now_ms() + delay;
+    event->active = true;
+}
+
+bool sl_zigbee_event_is_scheduled(sl_zigbee_event_t *event)
+{
+    return event->active;
+}
+
+uint32_t sl_zigbee_event_get_remaining_ms(sl_zigbee_event_t *event)
+{
+    if (event->active == false)
+    {
+        return 0xFFFFFFFF;
+    }
+
+    int32_t left = (int32_t)(event->deadline_ms - stack_now_ms());
+
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+void stack_run_ms(uint32_t ms)
+{
+    uint64_t end = model_time_get() + (uint64_t)ms * MODEL_COUNTS_PER_MS;
+
+    for (;;)
+    {
+        sl_zigbee_event_t *next = NULL;
+
+        for (sl_zigbee_event_t *e = stack.events; e != NULL; e = e->next)
+        {
+            if (e->active && (next == NULL || (int32_t)(e->deadline_ms - next->deadline_ms) < 0))
+            {
+                next = e;
+            }
+        }
+
+        if (next == NULL)
+        {
+            break;
+        }
+
+        uint64_t at = (uint64_t)next->deadline_ms * MODEL_COUNTS_PER_MS;
+
+        if (at > end)
+        {
+            break;
+        }
+
+        /* CPU sleeps till the event */
+        if (at > model_time_get())
+        {
+            model_advance_to(at);
+            stack.wakeups++;
+        }
+
+        next->active = false;
+        next->handler(next);
+    }
+
+    model_advance_to(end);
+}
+
+uint32_t stack_wakeups_get(void)
+{
+    return stack.wakeups;
+}
+
+uint32_t halCommonGetInt32uMillisecondTick(void)
+{
+    return stack_now_ms();
+}
+
+/*
+ *  Tokens
+ */
+void model_token_get(ModelToken token, uint32_t index, void *data)
+{
+    const StackTokenDef *def = &stack_token_defs[token];
+
+    memcpy(data, stack.tokens[token] + def->size * index, def->size);
+}
+
+void model_token_set(ModelToken token, uint32_t index, const void *data)
+{
+    const StackTokenDef *def = &stack_token_defs[token];
+
+    memcpy(stack.tokens[token] + def->size * index, data, def->size);
+    stack.token_writes[token]++;
+}
+
+uint32_t stack_token_writes_get(ModelToken token)
+{
+    return stack.token_writes[token];
+}
+
+/*
+ *  Attributes, CurrentLevel and RemainingTime are external
+ */
+static bool stack_attribute_is_external(EmberAfClusterId cluster, EmberAfAttributeId attribute)
+{
+    return cluster == ZCL_LEVEL_CONTROL_CLUSTER_ID &&
+           (attribute == ZCL_CURRENT_LEVEL_ATTRIBUTE_ID || attribute == ZCL_LEVEL_CONTROL_REMAINING_TIME_ATTRIBUTE_ID);
+}
+
+static StackAttribute* stack_attribute_find(uint8_t endpoint, EmberAfClusterId cluster,
+                                            EmberAfAttributeId attribute, bool create)
+{
+    for (size_t i = 0; i < stack.attribute_count; i++)
+    {
+        StackAttribute *a = &stack.attributes[i];
+
+        if (a->endpoint == endpoint && a->cluster == cluster && a->attribute == attribute)
+        {
+            return a;
+        }
+    }
+
+    if (create == false || stack.attribute_count == STACK_ATTRIBUTES_MAX)
+    {
+        return NULL;
+    }
+
+    StackAttribute *a = &stack.attributes[stack.attribute_count++];
+
+    a->endpoint = endpoint;
+    a->cluster = cluster;
+    a->attribute = attribute;
+
+    return a;
+}
+
+static uint8_t stack_attribute_size(EmberAfAttributeType type)
+{
+    switch (type)
+    {
+        case ZCL_INT16U_ATTRIBUTE_TYPE:
+        case ZCL_BITMAP16_ATTRIBUTE_TYPE:
+            return 2;
+        case ZCL_INT24U_ATTRIBUTE_TYPE:
+        case ZCL_INT24S_ATTRIBUTE_TYPE:
+            return 3;
+        case ZCL_INT32U_ATTRIBUTE_TYPE:
+            return 4;
+        case ZCL_INT48U_ATTRIBUTE_TYPE:
+            return 6;
+        default:
+            return 1;
+    }
+}
+
+EmberAfStatus emberAfReadAttribute(uint8_t endpoint, EmberAfClusterId cluster, EmberAfAttributeId attributeId,
+                                   uint8_t mask, uint8_t *dataPtr, uint16_t readLength,
+                                   EmberAfAttributeType *dataType)
+{
+    if (stack_attribute_is_external(cluster, attributeId))
+    {
+        EmberAfAttributeMetadata metadata = { .attributeId = attributeId };
+
+        return emberAfExternalAttributeReadCallback(endpoint, cluster, &metadata,
+                                                    EMBER_AF_NULL_MANUFACTURER_CODE, dataPtr, readLength);
+    }
+
+    StackAttribute *a = stack_attribute_find(endpoint, cluster, attributeId, false);
+
+    if (a == NULL)
+    {
+        return EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+    }
+
+    memcpy(dataPtr, a->data, readLength < a->size ? readLength : a->size);
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+EmberAfStatus emberAfReadServerAttribute(uint8_t endpoint, EmberAfClusterId cluster,
+                                         EmberAfAttributeId attributeId, uint8_t *dataPtr,
+                                         uint16_t readLength)
+{
+    return emberAfReadAttribute(endpoint, cluster, attributeId, CLUSTER_MASK_SERVER, dataPtr, readLength, NULL);
+}
+
+EmberAfStatus emberAfWriteAttribute(uint8_t endpoint, EmberAfClusterId cluster, EmberAfAttributeId attributeId,
+                                    uint8_t mask, uint8_t *dataPtr, EmberAfAttributeType dataType)
+{
+    if (stack_attribute_is_external(cluster, attributeId))
+    {
+        EmberAfAttributeMetadata metadata = { .attributeId = attributeId, .attributeType = dataType };
+
+        return emberAfExternalAttributeWriteCallback(endpoint, cluster, &metadata,
+                                                     EMBER_AF_NULL_MANUFACTURER_CODE, dataPtr);
+    }
+
+    StackAttribute *a = stack_attribute_find(endpoint, cluster, attributeId, true);
+
+    if (a == NULL)
+    {
+        return EMBER_ZCL_STATUS_FAILURE;
+    }
+
+    a->size = stack_attribute_size(dataType);
+    memcpy(a->data, dataPtr, a->size);
+
+    emberAfPostAttributeChangeCallback(endpoint, cluster, attributeId, mask, EMBER_AF_NULL_MANUFACTURER_CODE,
+                                       dataType, a->size, a->data);
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+EmberAfStatus emberAfWriteServerAttribute(uint8_t endpoint, EmberAfClusterId cluster,
+                                          EmberAfAttributeId attributeId, uint8_t *dataPtr,
+                                          EmberAfAttributeType dataType)
+{
+    return emberAfWriteAttribute(endpoint, cluster, attributeId, CLUSTER_MASK_SERVER, dataPtr, dataType);
+}
+
+/* OnOff cluster server of the SDK, level is faded before the light is switched off */
+EmberAfStatus emberAfOnOffClusterSetValueCallback(uint8_t endpoint, uint8_t command, bool initiatedByLevelChange)
+{
+    uint8_t value = 0;
+
+    emberAfReadServerAttribute(endpoint, ZCL_ON_OFF_CLUSTER_ID, ZCL_ON_OFF_ATTRIBUTE_ID, &value, sizeof(value));
+
+    if ((value == 0 && command == ZCL_OFF_COMMAND_ID) || (value != 0 && command == ZCL_ON_COMMAND_ID))
+    {
+        return EMBER_ZCL_STATUS_SUCCESS;
+    }
+
+    value = !value;
+
+    if (value)
+    {
+        emberAfWriteServerAttribute(endpoint, ZCL_ON_OFF_CLUSTER_ID, ZCL_ON_OFF_ATTRIBUTE_ID, &value,
+                                    ZCL_INT8U_ATTRIBUTE_TYPE);
+    }
+
+    if (initiatedByLevelChange == false)
+    {
+        emberAfOnOffClusterLevelControlEffectCallback(endpoint, value);
+    }
+
+    if (value == 0)
+    {
+        emberAfWriteServerAttribute(endpoint, ZCL_ON_OFF_CLUSTER_ID, ZCL_ON_OFF_ATTRIBUTE_ID, &value,
+                                    ZCL_INT8U_ATTRIBUTE_TYPE);
+    }
+
+    return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+EmberStatus emberAfSendImmediateDefaultResponse(EmberAfStatus status)
+{
+    stack.default_status = status;
+    stack.default_sent = true;
+
+    return EMBER_SUCCESS;
+}
+
+uint16_t emberAfFillExternalManufacturerSpecificBuffer(uint8_t frameControl, EmberAfClusterId clusterId,
+                                                       uint16_t manufacturerCode, uint8_t commandId,
+                                                       const char *format, ...)
+{
+    va_list args;
+    size_t len = 0;
+
+    (void)clusterId;
+
+    stack.response[len++] = frameControl;
+    stack.response[len++] = (uint8_t)manufacturerCode;
+    stack.response[len++] = (uint8_t)(manufacturerCode >> 8);
+    stack.response[len++] = emAfCurrentCommand != NULL ? emAfCurrentCommand->seqNum : 0;
+    stack.response[len++] = commandId;
+
+    va_start(args, format);
+
+    for (const char *f = format; *f != '\0'; f++)
+    {
+        uint32_t value = va_arg(args, uint32_t);
+        size_t bytes = *f == 'u' ? 1 : *f == 'v' ? 2 : 4;
+
+        for (size_t i = 0; i < bytes && len < STACK_RESPONSE_MAX; i++)
+        {
+            stack.response[len++] = (uint8_t)(value >> (8 * i));
+        }
+    }
+
+    va_end(args);
+
+    stack.response_len = len;
+
+    return (uint16_t)len;
+}
+
+EmberStatus emberAfSendResponse(void)
+{
+    stack.response_sent = stack.response_len;
+
+    return EMBER_SUCCESS;
+}
+
+size_t stack_response_get(const uint8_t **frame)
+{
+    *frame = stack.response;
+
+    return stack.response_sent;
+}
+
+bool stack_default_response_get(EmberAfStatus *status)
+{
+    *status = stack.default_status;
+
+    return stack.default_sent;
+}
+
+void stack_response_clear(void)
+{
+    stack.response_len = 0;
+    stack.response_sent = 0;
+    stack.default_sent = false;
+}
+
+uint8_t emberAfIndexFromEndpoint(uint8_t endpoint)
+{
+    return endpoint >= 1 && endpoint <= APP_EP_COUNT ? endpoint - 1 : 0xFF;
+}
+
+bool emberAfEndpointEnableDisable(uint8_t endpoint, bool enable)
+{
+    if (emberAfIndexFromEndpoint(endpoint) == 0xFF)
+    {
+        return false;
+    }
+
+    stack.endpoints[endpoint] = enable;
+
+    return true;
+}
+
+bool stack_endpoint_enabled(uint8_t endpoint)
+{
+    return endpoint <= APP_EP_COUNT && stack.endpoints[endpoint];
+}
+
+void sl_zigbee_app_debug_print(const char *format, ...)
+{
+    va_list args;
+
+    if (getenv("MODEL_DEBUG") == NULL)
+    {
+        return;
+    }
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+void stack_init(void)
+{
+    uint16_t zero = 0;
+
+    for (size_t i = 0; i < MODEL_TOKEN_COUNT; i++)
+    {
+        const StackTokenDef *def = &stack_token_defs[i];
+
+        stack.tokens[i] = malloc(def->size * def->count);
+
+        for (size_t j = 0; j < def->count; j++)
+        {
+            memcpy(stack.tokens[i] + def->size * j, def->def, def->size);
+        }
+    }
+
+    /* OnOff cluster attributes of ZAP endpoints, light is off */
+    for (uint8_t ep = 1; ep <= APP_EP_COUNT; ep++)
+    {
+        StackAttribute *a = stack_attribute_find(ep, ZCL_ON_OFF_CLUSTER_ID, ZCL_ON_OFF_ATTRIBUTE_ID, true);
+
+        a->size = 1;
+        a = stack_attribute_find(ep, ZCL_ON_OFF_CLUSTER_ID, ZCL_ON_TIME_ATTRIBUTE_ID, true);
+        a->size = sizeof(zero);
+        a = stack_attribute_find(ep, ZCL_ON_OFF_CLUSTER_ID, ZCL_OFF_WAIT_TIME_ATTRIBUTE_ID, true);
+        a->size = sizeof(zero);
+    }
+}
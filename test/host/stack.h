@@ -0,0 +1,65 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host stand-in of Zigbee stack services used by the firmware: event queue
+ * run against model time, tokens and attribute storage. */
+
+#ifndef STACK_H_
+#define STACK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "af.h"
+
+void stack_init(void);
+
+/**
+ * @brief
+ *  Runs events due in the given time. Every event which needs model time to
+ *  be advanced is counted as wakeup, events due at the same moment are run in
+ *  the same wakeup.
+ *
+ * @param ms - time to run
+ */
+void stack_run_ms(uint32_t ms);
+
+uint32_t stack_wakeups_get(void);
+uint32_t stack_token_writes_get(ModelToken token);
+bool stack_endpoint_enabled(uint8_t endpoint);
+
+/**
+ * @brief
+ *  Returns ZCL frame of the last cluster specific response sent by the
+ *  firmware (frame control, manufacturer code, sequence, command, payload).
+ *
+ * @param frame - set to the frame
+ * @return frame length, 0 when no response was sent since stack_response_clear()
+ */
+size_t stack_response_get(const uint8_t **frame);
+
+/**
+ * @brief
+ *  Returns true when default response was sent since stack_response_clear(),
+ *  its status is set.
+ */
+bool stack_default_response_get(EmberAfStatus *status);
+
+void stack_response_clear(void);
+
+#endif /* STACK_H_ */
@@ -0,0 +1,363 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "waveform.h"
+#include "model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR  "golden"
+#endif
+
+typedef struct
+{
+    WavePeriod  *periods;
+    size_t      count;
+    size_t      size;
+
+} WaveChannel;
+
+static WaveChannel wave[LedChannel_MAX];
+
+#define WAVE_CHANNEL_NAME(name, ...)    #name,
+
+static const char * const wave_names[LedChannel_MAX] =
+{
+    APP_CHANNEL_TABLE(WAVE_CHANNEL_NAME)
+    APP_CHANNEL_EXT_TABLE(WAVE_CHANNEL_NAME)
+    APP_CHANNEL_PIXEL_TABLE(WAVE_CHANNEL_NAME)
+    APP_CHANNEL_AUX(WAVE_CHANNEL_NAME)
+};
+
+const char* wave_channel_name(LedChannel ch)
+{
+    return wave_names[ch];
+}
+
+static int wave_channel_find(unsigned int timer, unsigned int cc)
+{
+    for (int ch = 0; ch < LedChannel_MAX; ch++)
+    {
+        sl_led_pwm_t *pwm = led_channel_pwm_get(ch);
+
+        if (pwm->timer != NULL && TIMER_NUM(pwm->timer) == (int)timer && pwm->channel == cc)
+        {
+            return ch;
+        }
+    }
+
+    return -1;
+}
+
+/* active counts of the pin following compare value for whole period */
+static uint32_t wave_expected_active(const ModelPeriod *p, uint32_t oc, bool polarity)
+{
+    uint32_t out = oc < p->counts ? oc : p->counts;
+    uint32_t high = p->invert ? p->counts - out : out;
+
+    return polarity ? p->counts - high : high;
+}
+
+static void wave_period_cb(const ModelPeriod *p)
+{
+    int ch = wave_channel_find(p->timer, p->cc);
+
+    if (ch < 0)
+    {
+        return;
+    }
+
+    bool polarity = led_channel_pwm_get(ch)->polarity != 0;
+    WaveChannel *w = &wave[ch];
+    WavePeriod period =
+    {
+        .start = p->start,
+        .counts = p->counts,
+        .active = polarity ? p->counts - p->high : p->high,
+        .full = p->full,
+        .glitch = false,
+    };
+
+    if (p->routed == false)
+    {
+        /* pin is held by GPIO data register */
+    }
+    else if (p->full)
+    {
+        /* whole pulse of one of the compare values the period was run with */
+        period.glitch = true;
+        for (size_t i = 0; i < p->oc_count; i++)
+        {
+            if (period.active == wave_expected_active(p, p->oc[i], polarity))
+            {
+                period.glitch = false;
+            }
+        }
+    }
+    else
+    {
+        /* cut period, the part which was run has to follow compare value */
+        uint32_t ideal_active = polarity ? p->counts - p->ideal_high : p->ideal_high;
+
+        period.glitch = period.active != 0 && period.active != ideal_active;
+    }
+
+    if (w->count == w->size)
+    {
+        w->size = w->size != 0 ? w->size * 2 : 1024;
+        w->periods = realloc(w->periods, w->size * sizeof(WavePeriod));
+    }
+
+    w->periods[w->count++] = period;
+}
+
+void wave_init(void)
+{
+    model_period_cb_set(wave_period_cb);
+}
+
+void wave_reset(void)
+{
+    for (size_t i = 0; i < LedChannel_MAX; i++)
+    {
+        wave[i].count = 0;
+    }
+}
+
+size_t wave_periods_get(LedChannel ch, const WavePeriod **periods)
+{
+    *periods = wave[ch].periods;
+    return wave[ch].count;
+}
+
+double wave_duty_get(const WavePeriod *period)
+{
+    return period->counts != 0 ? (double)period->active / period->counts : 0.0;
+}
+
+static uint16_t wave_per_mille(double value)
+{
+    return (uint16_t)(value * 1000.0 + 0.5);
+}
+
+void wave_stats_get(LedChannel ch, WaveStats *stats)
+{
+    const WaveChannel *w = &wave[ch];
+    double *duty = malloc((w->count + 1) * sizeof(double));
+    size_t full = 0;
+    double step_max = 0.0;
+    double rel_step_max = 0.0;
+    double pct_max = 0.0;
+    double idx_max = 0.0;
+
+    memset(stats, 0, sizeof(*stats));
+
+    for (size_t i = 0; i < w->count; i++)
+    {
+        const WavePeriod *p = &w->periods[i];
+
+        stats->periods++;
+        stats->partial += p->full ? 0 : 1;
+        stats->glitches += p->glitch ? 1 : 0;
+
+        if (p->full)
+        {
+            duty[full++] = wave_duty_get(p);
+        }
+    }
+
+    /* switching from and to dark is not a step */
+    for (size_t i = 1; i < full; i++)
+    {
+        double prev = duty[i - 1];
+        double next = duty[i];
+
+        if (prev == 0.0 || next == 0.0)
+        {
+            continue;
+        }
+
+        double step = next > prev ? next - prev : prev - next;
+        double rel = step / (next > prev ? next : prev);
+
+        step_max = step > step_max ? step : step_max;
+        rel_step_max = rel > rel_step_max ? rel : rel_step_max;
+    }
+
+    /* window with monotonic duty is transition, not flicker */
+    for (size_t i = 0; i + WAVE_FLICKER_WINDOW <= full; i++)
+    {
+        const double *d = &duty[i];
+        double min = d[0];
+        double max = d[0];
+        double sum = 0.0;
+        bool rising = true;
+        bool falling = true;
+
+        for (size_t j = 0; j < WAVE_FLICKER_WINDOW; j++)
+        {
+            min = d[j] < min ? d[j] : min;
+            max = d[j] > max ? d[j] : max;
+            sum += d[j];
+
+            if (j > 0)
+            {
+                rising = rising && d[j] >= d[j - 1];
+                falling = falling && d[j] <= d[j - 1];
+            }
+        }
+
+        if (rising || falling || sum == 0.0)
+        {
+            continue;
+        }
+
+        double mean = sum / WAVE_FLICKER_WINDOW;
+        double above = 0.0;
+
+        for (size_t j = 0; j < WAVE_FLICKER_WINDOW; j++)
+        {
+            above += d[j] > mean ? d[j] - mean : 0.0;
+        }
+
+        double pct = (max - min) / (max + min);
+        double idx = above / sum;
+
+        pct_max = pct > pct_max ? pct : pct_max;
+        idx_max = idx > idx_max ? idx : idx_max;
+    }
+
+    stats->step_max = wave_per_mille(step_max);
+    stats->rel_step_max = wave_per_mille(rel_step_max);
+    stats->flicker_pct_max = wave_per_mille(pct_max);
+    stats->flicker_idx_max = wave_per_mille(idx_max);
+
+    free(duty);
+}
+
+static void wave_golden_write(FILE *f, uint32_t mask)
+{
+    for (size_t ch = 0; ch < LedChannel_MAX; ch++)
+    {
+        WaveStats stats;
+
+        if ((mask & (1UL << ch)) == 0)
+        {
+            continue;
+        }
+
+        wave_stats_get(ch, &stats);
+        fprintf(f, "%s: periods %u partial %u glitches %u step_max %u rel_step_max %u "
+                "flicker_pct %u flicker_idx %u\n", wave_names[ch], stats.periods, stats.partial,
+                stats.glitches, stats.step_max, stats.rel_step_max, stats.flicker_pct_max,
+                stats.flicker_idx_max);
+    }
+
+    for (size_t ch = 0; ch < LedChannel_MAX; ch++)
+    {
+        const WaveChannel *w = &wave[ch];
+
+        if ((mask & (1UL << ch)) == 0)
+        {
+            continue;
+        }
+
+        fprintf(f, "\n%s\n", wave_names[ch]);
+
+        for (size_t i = 0; i < w->count;)
+        {
+            const WavePeriod *p = &w->periods[i];
+            size_t run = 1;
+
+            while (i + run < w->count &&
+                   w->periods[i + run].active == p->active && w->periods[i + run].counts == p->counts &&
+                   w->periods[i + run].full == p->full && w->periods[i + run].glitch == p->glitch)
+            {
+                run++;
+            }
+
+            fprintf(f, "%zu x %u/%u%s%s\n", run, p->active, p->counts, p->full ? "" : " partial",
+                    p->glitch ? " glitch" : "");
+            i += run;
+        }
+    }
+}
+
+bool wave_golden_check(const char *name, uint32_t mask)
+{
+    char path[256];
+    char *actual = NULL;
+    size_t actual_len = 0;
+    FILE *f = open_memstream(&actual, &actual_len);
+
+    wave_golden_write(f, mask);
+    fclose(f);
+
+    snprintf(path, sizeof(path), "%s/%s.txt", GOLDEN_DIR, name);
+
+    if (getenv("UPDATE_GOLDEN") != NULL)
+    {
+        f = fopen(path, "w");
+        if (f == NULL)
+        {
+            printf("%s: can't write\n", path);
+            free(actual);
+            return false;
+        }
+
+        fwrite(actual, 1, actual_len, f);
+        fclose(f);
+        printf("%s: updated\n", path);
+        free(actual);
+        return true;
+    }
+
+    f = fopen(path, "r");
+    if (f == NULL)
+    {
+        printf("%s: missing, run with UPDATE_GOLDEN=1\n", path);
+        free(actual);
+        return false;
+    }
+
+    char *expected = malloc(actual_len + 2);
+    size_t expected_len = fread(expected, 1, actual_len + 1, f);
+    bool match = expected_len == actual_len && memcmp(expected, actual, actual_len) == 0;
+
+    fclose(f);
+
+    if (match == false)
+    {
+        size_t line = 1;
+
+        for (size_t i = 0; i < actual_len && i < expected_len && expected[i] == actual[i]; i++)
+        {
+            line += actual[i] == '\n';
+        }
+
+        printf("%s: differs from line %zu\n", path, line);
+    }
+
+    free(expected);
+    free(actual);
+
+    return match;
+}
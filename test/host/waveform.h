@@ -0,0 +1,80 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* PWM periods of the channels recorded from the register model, with the
+ * same output quality metrics as led_wave.c (per mille) and golden files. */
+
+#ifndef WAVEFORM_H_
+#define WAVEFORM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "led_channel.h"
+
+/* window of periods percent flicker and flicker index are computed over */
+#define WAVE_FLICKER_WINDOW     16
+
+typedef struct
+{
+    uint64_t    start;          /* HFCLK cycle */
+    uint32_t    counts;
+    uint32_t    active;         /* counts of active output (polarity applied) */
+    bool        full;           /* whole period, not cut by counter restart */
+    bool        glitch;         /* pulse of none of the compare values of the period */
+
+} WavePeriod;
+
+typedef struct
+{
+    uint32_t    periods;
+    uint32_t    partial;
+    uint32_t    glitches;
+    uint16_t    step_max;           /* largest duty step of full scale */
+    uint16_t    rel_step_max;       /* largest duty step of brighter of two periods */
+    uint16_t    flicker_pct_max;    /* percent flicker over WAVE_FLICKER_WINDOW periods */
+    uint16_t    flicker_idx_max;    /* flicker index over WAVE_FLICKER_WINDOW periods */
+
+} WaveStats;
+
+void wave_init(void);
+void wave_reset(void);
+
+size_t wave_periods_get(LedChannel ch, const WavePeriod **periods);
+
+/* duty of the period, 1.0 is always active */
+double wave_duty_get(const WavePeriod *period);
+
+void wave_stats_get(LedChannel ch, WaveStats *stats);
+
+const char* wave_channel_name(LedChannel ch);
+
+/**
+ * @brief
+ *  Compares metrics and run-length encoded periods of the channels with
+ *  golden file GOLDEN_DIR/<name>.txt. File is written instead when
+ *  UPDATE_GOLDEN is set in environment.
+ *
+ * @param name - golden file name
+ * @param mask - channels, bit per LedChannel
+ * @return true when recorded waveform matches golden one
+ */
+bool wave_golden_check(const char *name, uint32_t mask);
+
+#endif /* WAVEFORM_H_ */
@@ -0,0 +1,43 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZIGBEE_APP_FRAMEWORK_EVENT_H_
+#define ZIGBEE_APP_FRAMEWORK_EVENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* events are run by model_run_ms() of stack.c at their deadlines */
+typedef struct sl_zigbee_event_s
+{
+    void                        (*handler)(struct sl_zigbee_event_s *event);
+    struct sl_zigbee_event_s    *next;
+    uint32_t                    deadline_ms;
+    bool                        active;
+    bool                        linked;
+
+} sl_zigbee_event_t;
+
+void sl_zigbee_event_init(sl_zigbee_event_t *event, void (*handler)(sl_zigbee_event_t *event));
+void sl_zigbee_event_set_active(sl_zigbee_event_t *event);
+void sl_zigbee_event_set_inactive(sl_zigbee_event_t *event);
+void sl_zigbee_event_set_delay_ms(sl_zigbee_event_t *event, uint32_t delay);
+bool sl_zigbee_event_is_scheduled(sl_zigbee_event_t *event);
+uint32_t sl_zigbee_event_get_remaining_ms(sl_zigbee_event_t *event);
+
+#endif /* ZIGBEE_APP_FRAMEWORK_EVENT_H_ */
@@ -0,0 +1,237 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Color Control of mixed light (color_extension.c, led_light.c), built for
+ * tunable white light with LDMA transitions (test_color_tw) and for RGBW
+ * light (test_color_rgbw). Colors reached after transition are checked on
+ * channel duty and attributes, commands of the other color mode are left
+ * to the stack. Tunable white build also runs level transition of separate
+ * endpoint: LDMA fade (led_fade.c) into TIMER isn't modeled, so it is
+ * refused and the transition has to fall back to event driven one. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/stack.h"
+
+#include "app.h"
+#include "led_channel.h"
+#if APP_DMA_TRANSITIONS
+#include "led_fade.h"
+#endif
+
+#include <stdio.h>
+
+#define TEST_EP             1       /* LED_LIGHT_MIXED_EP */
+#define TEST_LEVEL          200
+#define TEST_TIME           10      /* 1/10 s */
+#define TEST_SETTLE_MS      1200
+
+static uint32_t test_color_cmd(uint8_t command, const uint8_t *payload, uint8_t len)
+{
+    uint32_t status = firmware_zcl_cmd(TEST_EP, ZCL_COLOR_CONTROL_CLUSTER_ID, command, payload, len);
+
+    stack_run_ms(TEST_SETTLE_MS);
+
+    return status;
+}
+
+static uint16_t test_attribute_get(EmberAfAttributeId attribute)
+{
+    uint16_t value = 0;
+
+    emberAfReadServerAttribute(TEST_EP, ZCL_COLOR_CONTROL_CLUSTER_ID, attribute, (uint8_t *)&value, sizeof(value));
+
+    return value;
+}
+
+static void test_duty_print(const char *name)
+{
+    printf("%-12s", name);
+    for (LedChannel ch = LedChannel_CH1; ch <= LedChannel_CH4; ch++)
+    {
+        printf(" CH%d %5u", ch + 1, led_channel_duty_get(ch));
+    }
+    printf("\n");
+}
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE
+static void test_color_temp_to(uint16_t mireds)
+{
+    const uint8_t payload[] = { (uint8_t)mireds, mireds >> 8, TEST_TIME, 0 };
+
+    CHECK(test_color_cmd(ZCL_MOVE_TO_COLOR_TEMPERATURE_COMMAND_ID, payload, sizeof(payload)) ==
+          EMBER_ZCL_STATUS_SUCCESS, "%u mireds: command not handled", mireds);
+    CHECK(test_attribute_get(ZCL_COLOR_CONTROL_COLOR_TEMPERATURE_ATTRIBUTE_ID) == mireds,
+          "ColorTemperature %u, expected %u", test_attribute_get(ZCL_COLOR_CONTROL_COLOR_TEMPERATURE_ATTRIBUTE_ID),
+          mireds);
+    CHECK(test_attribute_get(ZCL_COLOR_CONTROL_REMAINING_TIME_ATTRIBUTE_ID) == 0, "%u mireds: RemainingTime %u",
+          mireds, test_attribute_get(ZCL_COLOR_CONTROL_REMAINING_TIME_ATTRIBUTE_ID));
+}
+
+static void test_tunable_white(void)
+{
+    uint32_t warm;
+    uint32_t cool;
+
+    test_color_temp_to(APP_TW_WARM_MIREDS);
+    test_duty_print("warm");
+    CHECK(led_channel_duty_get(LedChannel_CH1) > 0 && led_channel_duty_get(LedChannel_CH2) == 0,
+          "warm: CH1 %u, CH2 %u", led_channel_duty_get(LedChannel_CH1), led_channel_duty_get(LedChannel_CH2));
+    warm = led_channel_duty_get(LedChannel_CH1);
+
+    test_color_temp_to(APP_TW_COOL_MIREDS);
+    test_duty_print("cool");
+    CHECK(led_channel_duty_get(LedChannel_CH1) == 0 && led_channel_duty_get(LedChannel_CH2) > 0,
+          "cool: CH1 %u, CH2 %u", led_channel_duty_get(LedChannel_CH1), led_channel_duty_get(LedChannel_CH2));
+    cool = led_channel_duty_get(LedChannel_CH2);
+
+    /* level of the light is kept by both ends of the range */
+    CHECK(warm == cool, "warm CH1 %u, cool CH2 %u", warm, cool);
+
+    test_color_temp_to((APP_TW_WARM_MIREDS + APP_TW_COOL_MIREDS) / 2);
+    test_duty_print("middle");
+    CHECK(led_channel_duty_get(LedChannel_CH1) > 0 && led_channel_duty_get(LedChannel_CH2) > 0,
+          "middle: CH1 %u, CH2 %u", led_channel_duty_get(LedChannel_CH1), led_channel_duty_get(LedChannel_CH2));
+
+    /* out of range color temperature is clamped */
+    const uint8_t payload[] = { 0xE8, 0x03, 0, 0 };
+
+    test_color_cmd(ZCL_MOVE_TO_COLOR_TEMPERATURE_COMMAND_ID, payload, sizeof(payload));
+    CHECK(test_attribute_get(ZCL_COLOR_CONTROL_COLOR_TEMPERATURE_ATTRIBUTE_ID) == APP_TW_WARM_MIREDS,
+          "1000 mireds: ColorTemperature %u", test_attribute_get(ZCL_COLOR_CONTROL_COLOR_TEMPERATURE_ATTRIBUTE_ID));
+
+    /* hue and saturation are not supported by tunable white light */
+    const uint8_t hs[] = { 0, 254, TEST_TIME, 0 };
+
+    CHECK(test_color_cmd(ZCL_MOVE_TO_HUE_AND_SATURATION_COMMAND_ID, hs, sizeof(hs)) ==
+          EMBER_ZCL_STATUS_UNSUP_COMMAND, "MoveToHueAndSaturation handled by tunable white light");
+}
+#endif
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+static LedChannel test_strongest_get(void)
+{
+    LedChannel strongest = LedChannel_CH1;
+
+    for (LedChannel ch = LedChannel_CH2; ch <= LedChannel_CH4; ch++)
+    {
+        if (led_channel_duty_get(ch) > led_channel_duty_get(strongest))
+        {
+            strongest = ch;
+        }
+    }
+
+    return strongest;
+}
+
+static void test_rgbw(void)
+{
+    static const struct
+    {
+        const char  *name;
+        uint8_t     hue;
+        uint8_t     saturation;
+        LedChannel  strongest;
+
+    } colors[] =
+    {
+        { "red",    0,   254, LedChannel_CH1 },
+        { "green",  85,  254, LedChannel_CH2 },
+        { "blue",   170, 254, LedChannel_CH3 },
+        { "white",  0,   0,   LedChannel_CH4 },
+    };
+
+    for (size_t i = 0; i < sizeof(colors) / sizeof(colors[0]); i++)
+    {
+        const uint8_t payload[] = { colors[i].hue, colors[i].saturation, TEST_TIME, 0 };
+
+        CHECK(test_color_cmd(ZCL_MOVE_TO_HUE_AND_SATURATION_COMMAND_ID, payload, sizeof(payload)) ==
+              EMBER_ZCL_STATUS_SUCCESS, "%s: command not handled", colors[i].name);
+        test_duty_print(colors[i].name);
+        CHECK(test_strongest_get() == colors[i].strongest, "%s: CH%d is the strongest, expected CH%d",
+              colors[i].name, test_strongest_get() + 1, colors[i].strongest + 1);
+        CHECK((uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_CURRENT_HUE_ATTRIBUTE_ID) == colors[i].hue &&
+              (uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_CURRENT_SATURATION_ATTRIBUTE_ID) == colors[i].saturation,
+              "%s: CurrentHue %u, CurrentSaturation %u", colors[i].name,
+              (uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_CURRENT_HUE_ATTRIBUTE_ID),
+              (uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_CURRENT_SATURATION_ATTRIBUTE_ID));
+        CHECK((uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_COLOR_MODE_ATTRIBUTE_ID) ==
+              EMBER_ZCL_COLOR_MODE_CURRENT_HUE_AND_CURRENT_SATURATION,
+              "%s: ColorMode %u", colors[i].name, (uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_COLOR_MODE_ATTRIBUTE_ID));
+    }
+
+    /* red in CIE 1931 chromaticity (x 0.64, y 0.33) */
+    const uint8_t xy[] = { 0xD7, 0xA3, 0x7B, 0x54, TEST_TIME, 0 };
+
+    CHECK(test_color_cmd(ZCL_MOVE_TO_COLOR_COMMAND_ID, xy, sizeof(xy)) == EMBER_ZCL_STATUS_SUCCESS,
+          "MoveToColor not handled");
+    test_duty_print("x/y red");
+    CHECK(test_strongest_get() == LedChannel_CH1, "x/y red: CH%d is the strongest", test_strongest_get() + 1);
+    CHECK((uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_COLOR_MODE_ATTRIBUTE_ID) ==
+          EMBER_ZCL_COLOR_MODE_CURRENT_X_AND_CURRENT_Y,
+          "x/y red: ColorMode %u", (uint8_t)test_attribute_get(ZCL_COLOR_CONTROL_COLOR_MODE_ATTRIBUTE_ID));
+
+    /* color temperature is not supported by RGBW light */
+    const uint8_t ct[] = { 0xFA, 0x00, TEST_TIME, 0 };
+
+    CHECK(test_color_cmd(ZCL_MOVE_TO_COLOR_TEMPERATURE_COMMAND_ID, ct, sizeof(ct)) ==
+          EMBER_ZCL_STATUS_UNSUP_COMMAND, "MoveToColorTemperature handled by RGBW light");
+}
+#endif
+
+#if APP_DMA_TRANSITIONS
+static void test_dma_fallback(void)
+{
+    uint8_t ep = LedChannel_CH3 + 1;
+    uint8_t level;
+
+    firmware_move_to_level(ep, 150, TEST_TIME, true);
+    CHECK(led_fade_is_active(LedChannel_CH3) == false, "LDMA fade started on TIMER, not modeled");
+
+    stack_run_ms(500);
+    level = firmware_current_level_get(ep);
+    CHECK(level > 1 && level < 150, "fallback transition: level %u at half of time", level);
+
+    stack_run_ms(TEST_SETTLE_MS);
+    level = firmware_current_level_get(ep);
+    CHECK(level == 150, "fallback transition: level %u at the end", level);
+    CHECK(led_channel_duty_get(LedChannel_CH3) > 0, "CH3 dark after fallback transition");
+
+    printf("LDMA fade refused, CH%d level %u by event driven transition\n", LedChannel_CH3 + 1, level);
+}
+#endif
+
+int main(void)
+{
+    firmware_boot();
+    stack_run_ms(3000);
+
+    firmware_move_to_level(TEST_EP, TEST_LEVEL, 0, true);
+    stack_run_ms(200);
+
+#if APP_LIGHT_MODE == APP_LIGHT_MODE_TUNABLE_WHITE
+    test_tunable_white();
+#elif APP_LIGHT_MODE == APP_LIGHT_MODE_RGBW
+    test_rgbw();
+#endif
+#if APP_DMA_TRANSITIONS
+    test_dma_fallback();
+#endif
+
+    return check_result("test_color");
+}
@@ -0,0 +1,250 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Effective resolution of sigma-delta dithering: fine levels between adjacent
+ * table entries are staged, the dither interrupt runs from the model TIMER
+ * overflow and mean duty over sliding windows of N whole periods is compared
+ * with the fractional compare value. Plain PWM rounds to the nearest count
+ * (up to 0.5 count error), so extra bits of the dithered output averaged
+ * over N periods are log2(0.5 / max error), up to LED_CHANNEL_DITHER_BITS.
+ * Then a slow MoveToLevel fade is run through the Level Control handler, and
+ * mean duty of its windows is compared with the interpolated level, which
+ * whole levels only follow by steps of the table. Cycles of the interrupt
+ * are measured with DWT on target only. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/model.h"
+#include "host/stack.h"
+#include "host/waveform.h"
+
+#include "led_channel.h"
+#include "led_ease.h"
+
+#include <math.h>
+
+#define TEST_DITHER_BITS    8
+#define TEST_PERIODS        512
+#define TEST_SETTLE_PERIODS 2
+
+typedef struct
+{
+    uint32_t    periods;        /* averaging window */
+    double      extra_bits_min;
+    double      err_max;
+
+} TestWindow;
+
+static TestWindow test_windows[] =
+{
+    { 16,   3.0 },
+    { 64,   5.0 },
+    { 256,  TEST_DITHER_BITS },
+};
+
+static const uint8_t test_levels[] = { 1, 2, 10, 60, 150 };
+
+/* slow fade at the bottom of the curve, where steps of whole levels are visible */
+#define TEST_FADE_FROM      20
+#define TEST_FADE_TO        24
+#define TEST_FADE_TT        200     /* 1/10 s */
+#define TEST_FADE_WINDOW    64      /* periods */
+
+/* largest error of mean active counts over every window position */
+static void test_windows_check(LedChannel ch, double target)
+{
+    const WavePeriod *periods;
+    size_t count = wave_periods_get(ch, &periods);
+    uint32_t active[TEST_PERIODS];
+    size_t used = 0;
+
+    for (size_t i = TEST_SETTLE_PERIODS; i < count && used < TEST_PERIODS; i++)
+    {
+        if (periods[i].full)
+        {
+            active[used++] = periods[i].active;
+        }
+    }
+
+    CHECK(used == TEST_PERIODS, "only %zu periods recorded", used);
+
+    for (size_t w = 0; w < ARRAY_SIZE(test_windows); w++)
+    {
+        TestWindow *window = &test_windows[w];
+        uint64_t sum = 0;
+
+        for (size_t i = 0; i < used; i++)
+        {
+            sum += active[i];
+
+            if (i >= window->periods)
+            {
+                sum -= active[i - window->periods];
+            }
+
+            if (i + 1 >= window->periods)
+            {
+                double err = fabs((double)sum / window->periods - target);
+
+                window->err_max = err > window->err_max ? err : window->err_max;
+            }
+        }
+    }
+}
+
+static double test_extra_bits(double err)
+{
+    /* 1/2^bits of count is fraction of compare value resolved by dithering */
+    if (err < 0.5 / (1 << TEST_DITHER_BITS))
+    {
+        return TEST_DITHER_BITS;
+    }
+
+    return log2(0.5 / err);
+}
+
+/* table compare value of fractional level */
+static double test_compare_get(const uint16_t *lut, double level)
+{
+    uint8_t whole = (uint8_t)level;
+
+    return lut[whole] + (lut[whole + 1] - lut[whole]) * (level - whole);
+}
+
+static void test_fade(LedChannel ch)
+{
+    const uint16_t *lut = led_channel_lut_get(ch);
+    uint8_t ep = ch + 1;
+
+    firmware_on_off(ep, ZCL_ON_COMMAND_ID);
+    led_ease_set(ep, LedEase_LINEAR);
+    firmware_move_to_level(ep, TEST_FADE_FROM, 0, false);
+    stack_run_ms(100);
+    wave_reset();
+
+    uint64_t start = model_time_get();
+    uint64_t duration = (uint64_t)TEST_FADE_TT * 100 * MODEL_COUNTS_PER_MS;
+
+    firmware_move_to_level(ep, TEST_FADE_TO, TEST_FADE_TT, false);
+    stack_run_ms(TEST_FADE_TT * 100 + 100);
+
+    const WavePeriod *periods;
+    size_t count = wave_periods_get(ch, &periods);
+    double err_max = 0;
+    double err_whole_max = 0;
+    uint32_t windows = 0;
+
+    for (size_t i = 0; i + TEST_FADE_WINDOW <= count; i += TEST_FADE_WINDOW)
+    {
+        const WavePeriod *first = &periods[i];
+        const WavePeriod *last = &periods[i + TEST_FADE_WINDOW - 1];
+
+        if (first->start < start || last->start + last->counts > start + duration)
+        {
+            continue;
+        }
+
+        uint64_t sum = 0;
+
+        for (size_t j = i; j < i + TEST_FADE_WINDOW; j++)
+        {
+            sum += periods[j].active;
+        }
+
+        /* level changes linearly, so mean of window is the level of its middle */
+        double middle = (first->start + last->start + last->counts) / 2.0 - start;
+        double level = TEST_FADE_FROM + (TEST_FADE_TO - TEST_FADE_FROM) * middle / duration;
+        double target = test_compare_get(lut, level);
+        double err = fabs((double)sum / TEST_FADE_WINDOW - target);
+        double err_whole = fabs(lut[(uint8_t)(level + 0.5)] - target);
+
+        err_max = err > err_max ? err : err_max;
+        err_whole_max = err_whole > err_whole_max ? err_whole : err_whole_max;
+        windows++;
+    }
+
+    WaveStats stats;
+
+    wave_stats_get(ch, &stats);
+    CHECK(stats.glitches == 0, "fade: %u glitches", stats.glitches);
+    CHECK(windows > 0, "fade: no window recorded");
+    CHECK(err_max < err_whole_max / 8, "fade: error max %.2f counts, %.2f with whole levels", err_max,
+          err_whole_max);
+    CHECK(firmware_current_level_get(ep) == TEST_FADE_TO, "fade: level %u at the end",
+          firmware_current_level_get(ep));
+
+    printf("fade %u -> %u in %u ms, mean of %u periods: error max %.2f counts, %.2f with whole levels\n",
+           TEST_FADE_FROM, TEST_FADE_TO, TEST_FADE_TT * 100, TEST_FADE_WINDOW, err_max, err_whole_max);
+}
+
+int main(void)
+{
+    LedChannel ch = LedChannel_CH1;
+
+    wave_init();
+    firmware_boot();
+    stack_run_ms(3000);
+
+    uint32_t period = TIMER_TopGet(led_channel_pwm_get(ch)->timer) + 1;
+    uint32_t run_ms = (uint32_t)((TEST_PERIODS + TEST_SETTLE_PERIODS + 1) * (uint64_t)period /
+                                 MODEL_COUNTS_PER_MS) + 1;
+    const uint16_t *lut = led_channel_lut_get(ch);
+
+    for (size_t i = 0; i < ARRAY_SIZE(test_levels); i++)
+    {
+        uint8_t level = test_levels[i];
+
+        for (uint32_t frac = 1; frac < 0x100; frac++)
+        {
+            double target = lut[level] + (double)(lut[level + 1] - lut[level]) * frac / 256.0;
+
+            led_channel_level_fine_stage(ch, (uint16_t)(level << 8 | frac));
+            led_channel_commit_flush();
+            wave_reset();
+            stack_run_ms(run_ms);
+            test_windows_check(ch, target);
+
+            WaveStats stats;
+
+            wave_stats_get(ch, &stats);
+            CHECK(stats.glitches == 0, "level %u.%u: %u glitches", level, frac, stats.glitches);
+        }
+    }
+
+    printf("PWM %u counts (%.1f bits), levels", period, log2(period));
+    for (size_t i = 0; i < ARRAY_SIZE(test_levels); i++)
+    {
+        printf(" %u", test_levels[i]);
+    }
+    printf(" with 255 fractions each\n");
+
+    for (size_t w = 0; w < ARRAY_SIZE(test_windows); w++)
+    {
+        const TestWindow *window = &test_windows[w];
+        double extra_bits = test_extra_bits(window->err_max);
+
+        printf("mean of %3u periods: error max %.4f counts, %.1f bits effective (+%.1f)\n", window->periods,
+               window->err_max, log2(period) + extra_bits, extra_bits);
+        CHECK(extra_bits >= window->extra_bits_min, "%u periods: %.1f extra bits, %.1f expected", window->periods,
+              extra_bits, window->extra_bits_min);
+    }
+
+    test_fade(ch);
+
+    return check_result("test_dither");
+}
@@ -0,0 +1,153 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Easing tables (ease_table.h, led_ease.c) against the analytic curves of
+ * ease_gen.py for every Q16 progress and value. Errors are bounded by the
+ * chord of a table segment of width h = 1/64: the value by max|f''| h^2 / 8,
+ * the slope by max|f''| h, both in Q16 plus rounding of table points. The
+ * inverse is checked to be exact inverse of led_ease_apply(). */
+
+#include "host/check.h"
+
+#include "led_ease.h"
+#include "ease_table.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define TEST_ONE            ((double)LED_EASE_ONE)
+#define TEST_H              (1.0 / (1 << EASE_TABLE_BITS))
+
+typedef struct
+{
+    const char  *name;
+    LedEase     ease;
+    double      (*f)(double p);
+    double      (*df)(double p);
+    double      d2f_max;            /* max |f''| */
+
+} TestCurve;
+
+static double test_quadratic(double p)
+{
+    return p < 0.5 ? 2.0 * p * p : 1.0 - 2.0 * (1.0 - p) * (1.0 - p);
+}
+
+static double test_quadratic_d(double p)
+{
+    return p < 0.5 ? 4.0 * p : 4.0 * (1.0 - p);
+}
+
+static double test_cubic(double p)
+{
+    return p < 0.5 ? 4.0 * p * p * p : 1.0 - 4.0 * pow(1.0 - p, 3);
+}
+
+static double test_cubic_d(double p)
+{
+    return p < 0.5 ? 12.0 * p * p : 12.0 * (1.0 - p) * (1.0 - p);
+}
+
+static double test_exponential(double p)
+{
+    if (p <= 0.0 || p >= 1.0)
+    {
+        return p <= 0.0 ? 0.0 : 1.0;
+    }
+
+    return p < 0.5 ? pow(2.0, 20.0 * p - 10.0) / 2.0 : 1.0 - pow(2.0, 10.0 - 20.0 * p) / 2.0;
+}
+
+static double test_exponential_d(double p)
+{
+    return 10.0 * M_LN2 * (p < 0.5 ? pow(2.0, 20.0 * p - 10.0) : pow(2.0, 10.0 - 20.0 * p));
+}
+
+static double test_quadratic_out(double p)
+{
+    return 1.0 - (1.0 - p) * (1.0 - p);
+}
+
+static double test_quadratic_out_d(double p)
+{
+    return 2.0 * (1.0 - p);
+}
+
+static const TestCurve curves[] =
+{
+    { "quadratic",      LedEase_QUADRATIC,      test_quadratic,     test_quadratic_d,     4.0                       },
+    { "cubic",          LedEase_CUBIC,          test_cubic,         test_cubic_d,         12.0                      },
+    /* (20 ln2)^2 / 2 at p = 0.5, ends are forced to 0 and 1 (2^-11 off) */
+    { "exponential",    LedEase_EXPONENTIAL,    test_exponential,   test_exponential_d,   200.0 * M_LN2 * M_LN2     },
+    { "quadratic-out",  LedEase_QUADRATIC_OUT,  test_quadratic_out, test_quadratic_out_d, 2.0                       },
+};
+
+static void test_curve(const TestCurve *c)
+{
+    /* table points are rounded to 1 count, slope is difference of two of them per segment */
+    double value_bound = c->d2f_max * TEST_H * TEST_H / 8.0 * TEST_ONE + 1.0;
+    double slope_bound = c->d2f_max * TEST_H * TEST_ONE + 2.0 / TEST_H;
+    double value_err = 0;
+    double slope_err = 0;
+
+    for (uint32_t progress = 0; progress <= LED_EASE_ONE; progress++)
+    {
+        double p = progress / TEST_ONE;
+        double value = led_ease_apply(c->ease, progress);
+        double slope = led_ease_slope_get(c->ease, progress);
+        double err = fabs(value - c->f(p) * TEST_ONE);
+
+        value_err = err > value_err ? err : value_err;
+        CHECK(err <= value_bound, "%s at %u: %.0f, %.1f expected", c->name, progress, value, c->f(p) * TEST_ONE);
+
+        err = fabs(slope - c->df(p) * TEST_ONE);
+        slope_err = err > slope_err ? err : slope_err;
+        CHECK(err <= slope_bound, "%s slope at %u: %.0f, %.1f expected", c->name, progress, slope,
+              c->df(p) * TEST_ONE);
+    }
+
+    /* the first progress reaching the value */
+    for (uint32_t value = 0; value <= LED_EASE_ONE; value++)
+    {
+        uint32_t progress = led_ease_progress_get(c->ease, value);
+
+        CHECK(progress <= LED_EASE_ONE && led_ease_apply(c->ease, progress) >= value &&
+              (progress == 0 || led_ease_apply(c->ease, progress - 1) < value),
+              "%s inverse of %u: %u", c->name, value, progress);
+    }
+
+    printf("%-13s value error max %6.1f (bound %6.1f), slope error max %8.1f (bound %8.1f) of %u\n", c->name,
+           value_err, value_bound, slope_err, slope_bound, (unsigned int)LED_EASE_ONE);
+}
+
+int main(void)
+{
+    for (uint32_t progress = 0; progress <= LED_EASE_ONE; progress++)
+    {
+        CHECK(led_ease_apply(LedEase_LINEAR, progress) == progress &&
+              led_ease_slope_get(LedEase_LINEAR, progress) == LED_EASE_ONE &&
+              led_ease_progress_get(LedEase_LINEAR, progress) == progress, "linear at %u", progress);
+    }
+
+    for (size_t i = 0; i < sizeof(curves) / sizeof(curves[0]); i++)
+    {
+        test_curve(&curves[i]);
+    }
+
+    return check_result("test_ease");
+}
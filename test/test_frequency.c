@@ -0,0 +1,156 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Manufacturer specific SET_FREQUENCY of Level Control cluster: the response
+ * carries the frequency set and counts in PWM period left at it, which have
+ * to match the TIMER. Channels sharing the TIMER follow, malformed and zero
+ * frequency are answered with default response. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/stack.h"
+
+#include "led_channel.h"
+#include "mfg_extension.h"
+
+#include <stdio.h>
+
+#define TEST_EP             2       /* CH2, TIMER shared with CH1 and CH3 */
+#define TEST_RESPONSE_SIZE  9       /* fc, mfg code, seq, cmd, frequency, resolution */
+
+static bool test_set_frequency(uint16_t frequency)
+{
+    const uint8_t payload[] = { (uint8_t)frequency, frequency >> 8 };
+    const uint8_t *frame;
+    LedChannel ch = TEST_EP - 1;
+    EmberAfStatus status;
+
+    stack_response_clear();
+    CHECK(firmware_mfg_cmd(TEST_EP, ZCL_LEVEL_CONTROL_CLUSTER_ID, MFG_LEVEL_SET_FREQUENCY_COMMAND_ID,
+                           payload, sizeof(payload)) == EMBER_ZCL_STATUS_SUCCESS,
+          "%u Hz: command not handled", frequency);
+    CHECK(stack_default_response_get(&status) == false, "%u Hz: default response sent", frequency);
+
+    size_t len = stack_response_get(&frame);
+
+    if (len != TEST_RESPONSE_SIZE)
+    {
+        CHECK(false, "%u Hz: response of %zu bytes", frequency, len);
+        return false;
+    }
+
+    uint16_t mfg_code = frame[1] | (frame[2] << 8);
+    uint16_t frequency_set = frame[5] | (frame[6] << 8);
+    uint16_t resolution = frame[7] | (frame[8] << 8);
+
+    /* new TOP is latched on the next overflow */
+    stack_run_ms(10);
+
+    uint32_t top = TIMER_TopGet(led_channel_pwm_get(ch)->timer);
+
+    CHECK(frame[0] == (ZCL_CLUSTER_SPECIFIC_COMMAND | ZCL_FRAME_CONTROL_SERVER_TO_CLIENT |
+                       ZCL_MANUFACTURER_SPECIFIC_MASK | ZCL_DISABLE_DEFAULT_RESPONSE_MASK),
+          "%u Hz: frame control %02x", frequency, frame[0]);
+    CHECK(mfg_code == EMBER_AF_MANUFACTURER_CODE, "%u Hz: manufacturer code %04x", frequency, mfg_code);
+    CHECK(frame[4] == MFG_LEVEL_FREQUENCY_RESPONSE_COMMAND_ID, "%u Hz: command %02x", frequency, frame[4]);
+    CHECK(frequency_set == led_channel_frequency_get(ch), "%u Hz: answered %u Hz, set %u Hz",
+          frequency, frequency_set, led_channel_frequency_get(ch));
+    CHECK(resolution == top + 1, "%u Hz: answered %u counts, TIMER has %u", frequency, resolution, top + 1);
+    CHECK(resolution == led_channel_resolution_get(LedChannel_CH1),
+          "%u Hz: CH1 sharing TIMER has %u counts", frequency, led_channel_resolution_get(LedChannel_CH1));
+
+    printf("%5u Hz -> %5u Hz, %5u counts\n", frequency, frequency_set, resolution);
+
+    return true;
+}
+
+static void test_frequencies(void)
+{
+    static const uint16_t frequencies[] = { 1000, 2000, 4000, 20000, 100, 65535 };
+    uint32_t min_freq, max_freq;
+    uint32_t resolution_prev = 0;
+
+    led_channel_frequency_range_get(TEST_EP - 1, &min_freq, &max_freq);
+
+    for (size_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++)
+    {
+        if (test_set_frequency(frequencies[i]) == false)
+        {
+            continue;
+        }
+
+        uint32_t frequency = led_channel_frequency_get(TEST_EP - 1);
+
+        CHECK(frequency >= min_freq && frequency <= max_freq, "%u Hz out of range %u..%u",
+              frequency, min_freq, max_freq);
+
+        /* 1000 -> 2000 -> 4000 -> 20000 Hz leaves less and less counts */
+        if (i > 0 && i < 4)
+        {
+            CHECK(led_channel_resolution_get(TEST_EP - 1) < resolution_prev,
+                  "%u Hz: resolution not lower than %u", frequencies[i], resolution_prev);
+        }
+        resolution_prev = led_channel_resolution_get(TEST_EP - 1);
+    }
+}
+
+static void test_invalid(void)
+{
+    static const struct
+    {
+        const char      *name;
+        uint8_t         payload[2];
+        uint8_t         len;
+        EmberAfStatus   status;
+
+    } cases[] =
+    {
+        { "short payload", { 0xE8 }, 1, EMBER_ZCL_STATUS_MALFORMED_COMMAND },
+        { "zero frequency", { 0, 0 }, 2, EMBER_ZCL_STATUS_INVALID_FIELD },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        uint32_t frequency = led_channel_frequency_get(TEST_EP - 1);
+        const uint8_t *frame;
+        EmberAfStatus status;
+
+        stack_response_clear();
+        firmware_mfg_cmd(TEST_EP, ZCL_LEVEL_CONTROL_CLUSTER_ID, MFG_LEVEL_SET_FREQUENCY_COMMAND_ID,
+                         cases[i].payload, cases[i].len);
+
+        CHECK(stack_response_get(&frame) == 0, "%s: frequency response sent", cases[i].name);
+        CHECK(stack_default_response_get(&status) && status == cases[i].status,
+              "%s: default response %02x, expected %02x", cases[i].name, status, cases[i].status);
+        CHECK(led_channel_frequency_get(TEST_EP - 1) == frequency, "%s: frequency changed", cases[i].name);
+    }
+}
+
+int main(void)
+{
+    firmware_boot();
+    stack_run_ms(3000);
+
+    firmware_move_to_level(TEST_EP, 100, 0, true);
+    stack_run_ms(200);
+
+    test_frequencies();
+    test_invalid();
+
+    return check_result("test_frequency");
+}
@@ -0,0 +1,151 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* PCA9685 backend behind the fake I2C of the register model: refresh of all
+ * 16 outputs is one auto-increment write of 65 bytes, updates staged while a
+ * transfer runs are merged into one following write, and the device
+ * registers end up with the latest value of every output. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/model.h"
+#include "host/stack.h"
+
+#include "led_channel.h"
+
+#define TEST_ADDRESS        APP_PCA9685_ADDRESS
+#define TEST_REG_MODE1      0x00
+#define TEST_REG_LED0_ON_L  0x06
+#define TEST_MODE1_AI       0x20
+#define TEST_OUTPUTS        16
+#define TEST_COUNTS         4096
+#define TEST_FULL           0x1000
+#define TEST_REFRESH_LEN    (1 + TEST_OUTPUTS * 4)
+
+#define TEST_EXT_MASK       (((1UL << TEST_OUTPUTS) - 1) << LedChannel_CH5)
+
+static uint16_t test_reg16_get(const uint8_t *regs, uint8_t reg)
+{
+    return regs[reg] | (uint16_t)regs[reg + 1] << 8;
+}
+
+/* LEDn_ON/OFF registers of the output follow table value of the level */
+static void test_output_check(const char *name, LedChannel ch, uint8_t level)
+{
+    const uint8_t *regs = model_i2c_regs_get();
+    unsigned int output = ch - LedChannel_CH5;
+    uint8_t reg = TEST_REG_LED0_ON_L + output * 4;
+    uint16_t on = test_reg16_get(regs, reg);
+    uint16_t off = test_reg16_get(regs, reg + 2);
+    uint32_t duty = led_channel_lut_get(ch)[level];
+
+    if (duty == 0)
+    {
+        CHECK((off & TEST_FULL) != 0, "%s: output %u on at level 0", name, output);
+    }
+    else if (duty >= TEST_COUNTS)
+    {
+        CHECK((on & TEST_FULL) != 0 && (off & TEST_FULL) == 0, "%s: output %u not full on", name, output);
+    }
+    else
+    {
+        CHECK(((off - on) & (TEST_COUNTS - 1)) == duty && (on & TEST_FULL) == 0 && (off & TEST_FULL) == 0,
+              "%s: output %u ON %u OFF %u, duty %u expected", name, output, on, off, duty);
+    }
+}
+
+static void test_refresh(void)
+{
+    uint8_t levels[LedChannel_MAX] = { 0 };
+    const ModelI2cTransfer *transfers;
+
+    for (size_t i = 0; i < TEST_OUTPUTS; i++)
+    {
+        levels[LedChannel_CH5 + i] = (uint8_t)(10 + i * 15);
+    }
+
+    model_i2c_transfers_clear();
+    led_channel_levels_set(TEST_EXT_MASK, levels);
+    stack_run_ms(10);
+
+    size_t count = model_i2c_transfers_get(&transfers);
+
+    CHECK(count == 1, "refresh: %zu transfers", count);
+    CHECK(count > 0 && transfers[0].addr == TEST_ADDRESS && transfers[0].reg == TEST_REG_LED0_ON_L &&
+          transfers[0].len == TEST_REFRESH_LEN, "refresh: 0x%02X reg 0x%02X len %u", transfers[0].addr,
+          transfers[0].reg, transfers[0].len);
+    CHECK((model_i2c_regs_get()[TEST_REG_MODE1] & TEST_MODE1_AI) != 0, "refresh: auto increment off");
+
+    for (size_t i = 0; i < TEST_OUTPUTS; i++)
+    {
+        test_output_check("refresh", LedChannel_CH5 + i, levels[LedChannel_CH5 + i]);
+    }
+
+    printf("refresh of %u outputs: %zu transfer of %u bytes, %lu us\n", TEST_OUTPUTS, count,
+           count > 0 ? transfers[0].len : 0,
+           count > 0 ? (unsigned long)((transfers[0].end - transfers[0].start) / (MODEL_HFCLK_HZ / 1000000)) : 0);
+}
+
+static void test_merge(void)
+{
+    const ModelI2cTransfer *transfers;
+    int32_t em1 = model_em1_requirements_get();
+
+    model_i2c_transfers_clear();
+
+    /* first update starts transfer, the others are staged while it runs */
+    led_channel_level_set(LedChannel_CH5, 40);
+    CHECK(model_i2c_busy(), "merge: transfer not started");
+
+    led_channel_level_set(LedChannel_CH7, 80);
+    led_channel_level_set(LedChannel_CH12, 120);
+    led_channel_level_set(LedChannel_CH5, 200);
+    led_channel_level_set(LedChannel_CH20, 254);
+    led_channel_level_set(LedChannel_CH12, 0);
+    CHECK(model_i2c_busy(), "merge: staged updates not overlapped with transfer");
+
+    stack_run_ms(10);
+
+    size_t count = model_i2c_transfers_get(&transfers);
+
+    CHECK(count == 2, "merge: %zu transfers, staged updates not merged", count);
+    CHECK(count > 0 && transfers[0].len == 5, "merge: first transfer of %u bytes", transfers[0].len);
+    CHECK(count > 1 && transfers[1].reg == TEST_REG_LED0_ON_L && transfers[1].len == TEST_REFRESH_LEN &&
+          transfers[1].start >= transfers[0].end, "merge: second transfer reg 0x%02X len %u",
+          transfers[1].reg, transfers[1].len);
+
+    test_output_check("merge", LedChannel_CH5, 200);
+    test_output_check("merge", LedChannel_CH7, 80);
+    test_output_check("merge", LedChannel_CH12, 0);
+    test_output_check("merge", LedChannel_CH20, 254);
+
+    CHECK(model_i2c_busy() == false, "merge: transfer running");
+    CHECK(model_em1_requirements_get() == em1, "merge: EM1 requirement %d, %d before", model_em1_requirements_get(),
+          em1);
+}
+
+int main(void)
+{
+    firmware_boot();
+    stack_run_ms(3000);
+
+    test_refresh();
+    test_merge();
+
+    return check_result("test_pca9685");
+}
@@ -0,0 +1,177 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Pixel strip encoder behind the USART/LDMA model: streamed bitstream is
+ * decoded back into the frame, and host throughput of the encoder and RAM
+ * per pixel are reported against the strip bit rate and a fully pre-encoded
+ * frame. Host numbers are no target cycle counts, target encode time is
+ * given by led_pixel_encode_cycles_get() in DEBUG builds. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/model.h"
+#include "host/stack.h"
+
+#include "app.h"
+#include "led_channel.h"
+
+#define TEST_PIXELS         APP_PIXEL_COUNT
+#define TEST_FRAME_BYTES    (APP_PIXEL_COUNT * APP_PIXEL_BYTES)
+#define TEST_RESET_BYTES    32
+#define TEST_CHUNK_BYTES    32
+#define TEST_CODE_BYTES     3
+#define TEST_BIT_RATE       2400000UL
+#define TEST_FRAMES         20000
+
+#define TEST_PIXEL_MASK     ((1UL << LedChannel_CH5) | (1UL << LedChannel_CH6) | (1UL << LedChannel_CH7))
+
+/* data bit is sent as 3 line bits, 100 - 0, 110 - 1 */
+static bool test_decode(const uint8_t *stream, size_t len, uint8_t *data, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t code = 0;
+        uint8_t value = 0;
+
+        if ((i + 1) * TEST_CODE_BYTES > len)
+        {
+            return false;
+        }
+
+        for (size_t b = 0; b < TEST_CODE_BYTES; b++)
+        {
+            code = code << 8 | stream[i * TEST_CODE_BYTES + b];
+        }
+
+        for (int bit = 7; bit >= 0; bit--)
+        {
+            uint32_t symbol = (code >> (bit * 3)) & 0x7;
+
+            if (symbol != 0x4 && symbol != 0x6)
+            {
+                return false;
+            }
+
+            value = value << 1 | (symbol == 0x6);
+        }
+
+        data[i] = value;
+    }
+
+    return true;
+}
+
+static void test_frame(void)
+{
+    uint8_t levels[LedChannel_MAX] = { 0 };
+    uint8_t data[TEST_FRAME_BYTES];
+    const uint8_t *stream;
+
+    levels[LedChannel_CH5] = 200;
+    levels[LedChannel_CH6] = 100;
+    levels[LedChannel_CH7] = 30;
+
+    model_usart_stream_clear();
+    led_channel_levels_set(TEST_PIXEL_MASK, levels);
+    stack_run_ms(10);
+
+    size_t len = model_usart_stream_get(&stream);
+    bool decoded = test_decode(stream, len, data, TEST_FRAME_BYTES);
+
+    CHECK(decoded, "frame: %zu bytes streamed, not a valid pixel bitstream", len);
+    CHECK(model_dma_busy() == false, "frame: transfer running");
+
+    /* reset time follows pixel data, line is low */
+    size_t reset = 0;
+
+    for (size_t i = TEST_FRAME_BYTES * TEST_CODE_BYTES; i < len && stream[i] == 0; i++)
+    {
+        reset++;
+    }
+
+    CHECK(reset >= TEST_RESET_BYTES * TEST_CODE_BYTES, "frame: line low for %zu bytes after frame", reset);
+
+    for (size_t p = 0; decoded && p < TEST_PIXELS; p++)
+    {
+        uint8_t g = data[p * APP_PIXEL_BYTES + 0];
+        uint8_t r = data[p * APP_PIXEL_BYTES + 1];
+        uint8_t b = data[p * APP_PIXEL_BYTES + 2];
+
+        CHECK(r == led_channel_lut_get(LedChannel_CH5)[levels[LedChannel_CH5]] &&
+              g == led_channel_lut_get(LedChannel_CH6)[levels[LedChannel_CH6]] &&
+              b == led_channel_lut_get(LedChannel_CH7)[levels[LedChannel_CH7]],
+              "frame: pixel %zu is %u/%u/%u (R/G/B)", p, r, g, b);
+    }
+}
+
+static void test_benchmark(void)
+{
+    uint8_t levels[LedChannel_MAX] = { 0 };
+    uint32_t callbacks_start;
+    uint32_t callbacks;
+    uint64_t ns_start;
+    uint64_t ns;
+
+    model_dma_stats_get(&callbacks_start, &ns_start);
+    model_usart_stream_clear();
+
+    for (unsigned int f = 0; f < TEST_FRAMES; f++)
+    {
+        levels[LedChannel_CH5] = (uint8_t)(f * 7);
+        levels[LedChannel_CH6] = (uint8_t)(f * 13);
+        levels[LedChannel_CH7] = (uint8_t)(f * 29);
+        led_channel_levels_set(TEST_PIXEL_MASK, levels);
+        stack_run_ms(3);
+        model_usart_stream_clear();
+    }
+
+    model_dma_stats_get(&callbacks, &ns);
+    callbacks -= callbacks_start;
+    ns -= ns_start;
+
+    /* last callback of every frame only stops the transfer */
+    uint32_t rendered = (callbacks - TEST_FRAMES) * TEST_CHUNK_BYTES;
+    double rate = ns > 0 ? rendered * 1000.0 / ns : 0;
+    double required = TEST_BIT_RATE / (8.0 * TEST_CODE_BYTES) / 1000000.0;
+    double chunk_us = ns / 1000.0 / (callbacks - TEST_FRAMES);
+
+    CHECK(callbacks > TEST_FRAMES, "benchmark: %u callbacks for %u frames", callbacks, TEST_FRAMES);
+    CHECK(rate > required, "benchmark: encoder %.2f bytes/us, strip takes %.2f bytes/us", rate, required);
+
+    /* frame and two LDMA buffers against frame encoded as a whole */
+    size_t ram = TEST_FRAME_BYTES + 2 * TEST_CHUNK_BYTES * TEST_CODE_BYTES;
+    size_t ram_encoded = (TEST_FRAME_BYTES + TEST_RESET_BYTES) * TEST_CODE_BYTES;
+
+    printf("encoder: %.1f data bytes/us on host (strip takes %.2f), %.2f us per %u byte chunk of %lu us budget\n",
+           rate, required, chunk_us, TEST_CHUNK_BYTES,
+           (unsigned long)(TEST_CHUNK_BYTES * TEST_CODE_BYTES * 8 * 1000000UL / TEST_BIT_RATE));
+    printf("RAM: %u bytes/pixel + %u bytes buffers (%zu for %u pixels), pre-encoded frame %u bytes/pixel (%zu)\n",
+           APP_PIXEL_BYTES, 2 * TEST_CHUNK_BYTES * TEST_CODE_BYTES, ram, TEST_PIXELS,
+           APP_PIXEL_BYTES * TEST_CODE_BYTES, ram_encoded);
+}
+
+int main(void)
+{
+    firmware_boot();
+    stack_run_ms(3000);
+
+    test_frame();
+    test_benchmark();
+
+    return check_result("test_pixel");
+}
@@ -0,0 +1,242 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Level updates never produce a partial PWM period: buffered CC updates of
+ * routed output, the first update of unrouted output on a running TIMER
+ * (CompareSet, CompareBufSet, route) and re-routing after TIMER was released
+ * by clock gating are issued at random counter positions, and every period
+ * is checked to be a whole pulse of one of its compare values. Dark outputs,
+ * right aligned ones included, have to release their TIMER. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/model.h"
+#include "host/stack.h"
+#include "host/waveform.h"
+
+#include "led_channel.h"
+#include "sl_pwm_led_ext.h"
+
+#include <stdlib.h>
+
+#define TEST_ITERATIONS     500
+#define TEST_GATE_WAIT_MS   300
+
+static uint32_t test_period_counts(LedChannel ch)
+{
+    return TIMER_TopGet(led_channel_pwm_get(ch)->timer) + 1;
+}
+
+/* random point within the next two PWM periods */
+static void test_advance_random(LedChannel ch)
+{
+    model_advance_to(model_time_get() + 1 + (uint64_t)rand() % (2 * test_period_counts(ch)));
+}
+
+static uint8_t test_level_random(void)
+{
+    return (uint8_t)(1 + rand() % 254);
+}
+
+/* periods cut by TIMER start or stop have to be dark */
+static void test_periods_check(const char *name, LedChannel ch)
+{
+    const WavePeriod *periods;
+    size_t count = wave_periods_get(ch, &periods);
+    WaveStats stats;
+
+    wave_stats_get(ch, &stats);
+    CHECK(stats.glitches == 0, "%s: %u of %u periods don't follow compare value", name, stats.glitches,
+          stats.periods);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK(periods[i].full || periods[i].active == 0, "%s: partial period %zu with %u/%u active", name, i,
+              periods[i].active, periods[i].counts);
+    }
+}
+
+static void test_buffered(void)
+{
+    LedChannel ch = LedChannel_CH1;
+
+    led_channel_level_set(ch, 100);
+    stack_run_ms(10);
+    wave_reset();
+
+    for (size_t i = 0; i < TEST_ITERATIONS; i++)
+    {
+        led_channel_level_set(ch, test_level_random());
+        test_advance_random(ch);
+    }
+
+    stack_run_ms(10);
+    test_periods_check("buffered", ch);
+
+    WaveStats stats;
+
+    wave_stats_get(ch, &stats);
+    CHECK(stats.partial == 0, "buffered: %u partial periods", stats.partial);
+
+    led_channel_level_set(ch, 0);
+    stack_run_ms(TEST_GATE_WAIT_MS);
+    wave_reset();
+}
+
+static void test_unrouted(void)
+{
+    /* CH1 keeps TIMER1 running, CH3 is routed by its first update */
+    for (size_t i = 0; i < TEST_ITERATIONS / 10; i++)
+    {
+        led_channel_level_set(LedChannel_CH1, 50);
+        stack_run_ms(5);
+        test_advance_random(LedChannel_CH3);
+        CHECK(sl_pwm_led_is_started(led_channel_pwm_get(LedChannel_CH3)) == false, "unrouted: CH3 routed");
+
+        led_channel_level_set(LedChannel_CH3, test_level_random());
+        test_advance_random(LedChannel_CH3);
+        stack_run_ms(5);
+        test_periods_check("unrouted", LedChannel_CH3);
+        wave_reset();
+
+        /* TIMER is released with both outputs unrouted */
+        led_channel_level_set(LedChannel_CH1, 0);
+        led_channel_level_set(LedChannel_CH3, 0);
+        stack_run_ms(TEST_GATE_WAIT_MS);
+        CHECK(model_clock_enabled(cmuClock_TIMER1) == false, "unrouted: TIMER1 not released");
+    }
+
+    wave_reset();
+}
+
+static void test_gated(void)
+{
+    LedChannel ch = LedChannel_CH4;
+
+    for (size_t i = 0; i < TEST_ITERATIONS / 10; i++)
+    {
+        uint8_t level = test_level_random();
+
+        CHECK(model_clock_enabled(cmuClock_TIMER2) == false, "gated: TIMER2 not released");
+
+        test_advance_random(ch);
+        wave_reset();
+
+        uint64_t start = model_time_get();
+
+        led_channel_level_set(ch, level);
+        stack_run_ms(5);
+        test_periods_check("gated", ch);
+
+        /* output is restored within one PWM period */
+        const WavePeriod *periods;
+        size_t count = wave_periods_get(ch, &periods);
+        uint32_t expected = led_channel_lut_get(ch)[level];
+        uint64_t restored = 0;
+
+        for (size_t j = 0; j < count; j++)
+        {
+            if (periods[j].full && periods[j].active == expected)
+            {
+                restored = periods[j].start;
+                break;
+            }
+        }
+
+        CHECK(restored != 0 && restored - start <= test_period_counts(ch),
+              "gated: level %u restored after %lu counts", level, (unsigned long)(restored - start));
+
+        led_channel_level_set(ch, 0);
+        stack_run_ms(TEST_GATE_WAIT_MS);
+    }
+
+    wave_reset();
+}
+
+/* right aligned output is dark with TOP + 1 compare value, which is 0xFFFF
+ * with the longest period, it has to release its TIMER as well */
+static void test_gated_right_aligned(void)
+{
+    LedChannel ch = LedChannel_CH2;
+
+    CHECK(model_clock_enabled(cmuClock_TIMER1) == false, "right aligned: TIMER1 not released before");
+
+    for (size_t i = 0; i < TEST_ITERATIONS / 10; i++)
+    {
+        led_channel_level_set(ch, test_level_random());
+        stack_run_ms(5);
+        CHECK(model_clock_enabled(cmuClock_TIMER1), "right aligned: TIMER1 not running");
+        test_periods_check("right aligned", ch);
+
+        led_channel_level_set(ch, 0);
+        stack_run_ms(TEST_GATE_WAIT_MS);
+        CHECK(model_clock_enabled(cmuClock_TIMER1) == false, "right aligned: TIMER1 not released, dark compare %u",
+              led_channel_lut_get(ch)[0]);
+    }
+
+    /* full scale compare is counted as lit */
+    led_channel_level_set(LedChannel_CH1, 254);
+    stack_run_ms(5);
+    CHECK(led_channel_peak_on_count_get() == 1, "right aligned: peak on-count %u with CH1 at full level",
+          led_channel_peak_on_count_get());
+
+    led_channel_level_set(LedChannel_CH1, 0);
+    stack_run_ms(TEST_GATE_WAIT_MS);
+    wave_reset();
+}
+
+/* model sanity: direct CC write of routed output is detected */
+static void test_direct_write_detected(void)
+{
+    LedChannel ch = LedChannel_CH1;
+    sl_led_pwm_t *pwm = led_channel_pwm_get(ch);
+
+    led_channel_level_set(ch, 200);
+    stack_run_ms(10);
+    wave_reset();
+
+    model_advance_to(model_time_get() + test_period_counts(ch) / 3);
+    TIMER_CompareSet(pwm->timer, pwm->channel, pwm->timer->CC[pwm->channel].OC / 4);
+    stack_run_ms(5);
+
+    WaveStats stats;
+
+    wave_stats_get(ch, &stats);
+    CHECK(stats.glitches > 0, "direct write: not detected");
+
+    led_channel_level_set(ch, 0);
+    stack_run_ms(TEST_GATE_WAIT_MS);
+    wave_reset();
+}
+
+int main(void)
+{
+    srand(1);
+    wave_init();
+    firmware_boot();
+    stack_run_ms(3000);
+    wave_reset();
+
+    test_buffered();
+    test_unrouted();
+    test_gated();
+    test_gated_right_aligned();
+    test_direct_write_detected();
+
+    return check_result("test_pwm_update");
+}
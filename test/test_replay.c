@@ -0,0 +1,211 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Replay of hold-to-dim command traces, as sent by remotes while a button
+ * is held: Step bursts, MoveToLevelWithOnOff bursts of a rotary/slider and
+ * Move/Stop. Commands arrive with radio jitter. While the button is held the
+ * level has to move in one direction without stalls (a transition
+ * restarted from zero velocity stalls for tens of ms), and CurrentLevel is
+ * written to NVM once, after the burst settles. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/stack.h"
+
+#include "app.h"
+#include "led_ease.h"
+
+#include <stdio.h>
+
+#define TEST_EP             1
+#define TEST_SAMPLE_MS      5
+/* the longest time without level change while held: ease-out tail of the
+ * first step plus radio jitter, transition restarted from zero velocity
+ * adds its ease-in to it */
+#define TEST_STALL_MS       80
+#define TEST_SAVE_MS        3500    /* level token is written after burst settles */
+#define TEST_SETTLE_MS      1000    /* retargeted transition goes on after the last command */
+#define TEST_STEPS_MAX      16
+
+typedef enum
+{
+    TestCmd_STEP,
+    TestCmd_MOVE_TO_LEVEL,
+    TestCmd_MOVE,
+    TestCmd_STOP,
+
+} TestCmd;
+
+typedef struct
+{
+    uint16_t    at_ms;              /* from the start of trace */
+    TestCmd     cmd;
+    uint8_t     up;
+    uint8_t     value;              /* step size, level or rate */
+    uint16_t    transition_time;    /* 1/10 s */
+
+} TestTraceCmd;
+
+typedef struct
+{
+    const char          *name;
+    uint8_t             start_level;
+    uint16_t            hold_ms;    /* level moves till then */
+    size_t              count;
+    TestTraceCmd        cmds[TEST_STEPS_MAX];
+
+} TestTrace;
+
+static const TestTrace traces[] =
+{
+    {
+        "step burst", 20, 2400, 7,
+        {
+            { 0,    TestCmd_STEP, 1, 32, 4 },
+            { 410,  TestCmd_STEP, 1, 32, 4 },
+            { 795,  TestCmd_STEP, 1, 32, 4 },
+            { 1210, TestCmd_STEP, 1, 32, 4 },
+            { 1600, TestCmd_STEP, 1, 32, 4 },
+            { 2005, TestCmd_STEP, 1, 32, 4 },
+            { 2390, TestCmd_STEP, 1, 32, 4 },
+        },
+    },
+    {
+        "step burst down", 240, 1800, 6,
+        {
+            { 0,    TestCmd_STEP, 0, 25, 3 },
+            { 290,  TestCmd_STEP, 0, 25, 3 },
+            { 610,  TestCmd_STEP, 0, 25, 3 },
+            { 905,  TestCmd_STEP, 0, 25, 3 },
+            { 1190, TestCmd_STEP, 0, 25, 3 },
+            { 1515, TestCmd_STEP, 0, 25, 3 },
+        },
+    },
+    {
+        "rotary move to level", 30, 1300, 8,
+        {
+            { 0,    TestCmd_MOVE_TO_LEVEL, 1, 50,  2 },
+            { 170,  TestCmd_MOVE_TO_LEVEL, 1, 70,  2 },
+            { 330,  TestCmd_MOVE_TO_LEVEL, 1, 90,  2 },
+            { 505,  TestCmd_MOVE_TO_LEVEL, 1, 110, 2 },
+            { 660,  TestCmd_MOVE_TO_LEVEL, 1, 130, 2 },
+            { 840,  TestCmd_MOVE_TO_LEVEL, 1, 150, 2 },
+            { 995,  TestCmd_MOVE_TO_LEVEL, 1, 170, 2 },
+            { 1160, TestCmd_MOVE_TO_LEVEL, 1, 190, 2 },
+        },
+    },
+    {
+        "move/stop", 40, 1500, 2,
+        {
+            { 0,    TestCmd_MOVE, 1, 83, 0 },
+            { 1500, TestCmd_STOP, 0, 0,  0 },
+        },
+    },
+};
+
+static void test_cmd(const TestTraceCmd *c)
+{
+    switch (c->cmd)
+    {
+        case TestCmd_STEP:
+            /* remotes dim down without OnOff, so the light isn't switched off at minimum */
+            firmware_step(TEST_EP, c->up ? EMBER_ZCL_STEP_MODE_UP : EMBER_ZCL_STEP_MODE_DOWN, c->value,
+                          c->transition_time, c->up);
+            break;
+
+        case TestCmd_MOVE_TO_LEVEL:
+            firmware_move_to_level(TEST_EP, c->value, c->transition_time, true);
+            break;
+
+        case TestCmd_MOVE:
+            firmware_move(TEST_EP, c->up ? EMBER_ZCL_MOVE_MODE_UP : EMBER_ZCL_MOVE_MODE_DOWN, c->value, c->up);
+            break;
+
+        case TestCmd_STOP:
+            firmware_stop(TEST_EP, true);
+            break;
+    }
+}
+
+static void test_trace(const TestTrace *t, LedEase ease)
+{
+    const char *ease_name = ease == LedEase_LINEAR ? "linear" : "cubic";
+    bool up = t->cmds[0].up;
+    uint8_t level = t->start_level;
+    uint32_t last_change = 0;
+    uint32_t stall_max = 0;
+    size_t next = 0;
+
+    led_ease_set(TEST_EP, ease);
+    firmware_move_to_level(TEST_EP, t->start_level, 0, false);
+    stack_run_ms(TEST_SAVE_MS);
+
+    uint32_t writes = stack_token_writes_get(TOKEN_CURRENT_LEVEL);
+
+    for (uint32_t ms = 0; ms <= t->hold_ms; ms += TEST_SAMPLE_MS)
+    {
+        while (next < t->count && t->cmds[next].at_ms <= ms)
+        {
+            test_cmd(&t->cmds[next++]);
+        }
+
+        stack_run_ms(TEST_SAMPLE_MS);
+
+        uint8_t now = firmware_current_level_get(TEST_EP);
+
+        CHECK(up ? now >= level : now <= level, "%s, %s at %u ms: level %u after %u", t->name, ease_name, ms,
+              now, level);
+
+        if (now != level)
+        {
+            level = now;
+            last_change = ms;
+        }
+
+        stall_max = ms - last_change > stall_max ? ms - last_change : stall_max;
+    }
+
+    CHECK(stall_max <= TEST_STALL_MS, "%s, %s: level stalled for %u ms while held", t->name, ease_name,
+          stall_max);
+    CHECK(stack_token_writes_get(TOKEN_CURRENT_LEVEL) == writes, "%s, %s: level token written while held",
+          t->name, ease_name);
+
+    stack_run_ms(TEST_SETTLE_MS + TEST_SAVE_MS);
+
+    uint32_t saves = stack_token_writes_get(TOKEN_CURRENT_LEVEL) - writes;
+
+    CHECK(saves == 1, "%s, %s: level token written %u times", t->name, ease_name, saves);
+
+    printf("%-20s %-6s: %3u -> %3u, stall max %2u ms, %u token write\n", t->name, ease_name, t->start_level,
+           firmware_current_level_get(TEST_EP), stall_max, saves);
+}
+
+int main(void)
+{
+    firmware_boot();
+    firmware_on_off(TEST_EP, ZCL_ON_COMMAND_ID);
+    stack_run_ms(3000);
+
+    for (size_t i = 0; i < ARRAY_SIZE(traces); i++)
+    {
+        test_trace(&traces[i], LedEase_LINEAR);
+        test_trace(&traces[i], LedEase_CUBIC);
+    }
+
+    return check_result("test_replay");
+}
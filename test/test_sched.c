@@ -0,0 +1,159 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Wakeups per second of a group fade of all 4 channels, from the same or
+ * different levels, the group command reaching endpoints at once or 1 ms
+ * apart. Built with LED_SCHED_MERGE_MS 0 as a baseline, where every endpoint
+ * keeps its own deadlines as with timer event per endpoint: it stores
+ * wakeups to TEST_BASELINE, the default build has to service the endpoints in
+ * fewer wakeups where their deadlines differ. Wakeups are CPU wakeups of the
+ * stubbed event API (model time advanced to the next event). */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/stack.h"
+
+#include "app.h"
+#include "led_sched.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* firmware default */
+#ifndef LED_SCHED_MERGE_MS
+#define LED_SCHED_MERGE_MS  2
+#endif
+
+#define TEST_SETTLE_MS      4000
+
+typedef struct
+{
+    uint8_t     start[4];           /* level of endpoints 1 - 4 */
+    uint8_t     target;
+    uint16_t    transition_time;    /* 1/10 s */
+    uint8_t     spread_ms;          /* command reaches endpoints this time apart */
+
+} TestCase;
+
+static const TestCase cases[] =
+{
+    { { 1,   1,   1,   1   }, 254, 20,  0 },
+    { { 1,   1,   1,   1   }, 254, 20,  1 },
+    { { 1,   40,  90,  160 }, 254, 20,  0 },
+    { { 1,   40,  90,  160 }, 254, 100, 0 },
+    { { 254, 200, 120, 60  }, 30,  50,  0 },
+};
+
+static double test_group_fade(const TestCase *c)
+{
+    uint32_t duration_ms = c->transition_time * 100UL;
+    uint32_t sched_start;
+    uint32_t sched;
+    uint32_t serviced_start;
+    uint32_t serviced;
+
+    for (uint8_t ep = 1; ep <= APP_EP_COUNT; ep++)
+    {
+        firmware_move_to_level(ep, c->start[ep - 1], 0, false);
+    }
+    stack_run_ms(TEST_SETTLE_MS);
+
+    uint32_t wakeups = stack_wakeups_get();
+
+    led_sched_stats_get(&sched_start, &serviced_start);
+
+    for (uint8_t ep = 1; ep <= APP_EP_COUNT; ep++)
+    {
+        firmware_move_to_level(ep, c->target, c->transition_time, false);
+        stack_run_ms(c->spread_ms);
+    }
+    stack_run_ms(duration_ms);
+
+    wakeups = stack_wakeups_get() - wakeups;
+    led_sched_stats_get(&sched, &serviced);
+    sched -= sched_start;
+    serviced -= serviced_start;
+
+    double rate = wakeups * 1000.0 / (duration_ms + APP_EP_COUNT * c->spread_ms);
+
+    printf("%3u/%3u/%3u/%3u -> %3u in %5u ms, %u ms apart: %4u wakeups (%5.1f/s), %4u slots in %4u passes\n",
+           c->start[0], c->start[1], c->start[2], c->start[3], c->target, duration_ms, c->spread_ms, wakeups,
+           rate, serviced, sched);
+
+    return rate;
+}
+
+int main(void)
+{
+    double rates[ARRAY_SIZE(cases)];
+
+    firmware_boot();
+    for (uint8_t ep = 1; ep <= APP_EP_COUNT; ep++)
+    {
+        firmware_on_off(ep, ZCL_ON_COMMAND_ID);
+    }
+    stack_run_ms(3000);
+
+    for (size_t i = 0; i < ARRAY_SIZE(cases); i++)
+    {
+        rates[i] = test_group_fade(&cases[i]);
+    }
+
+#if LED_SCHED_MERGE_MS
+    FILE *f = fopen(TEST_BASELINE, "r");
+
+    CHECK(f != NULL, "%s missing", TEST_BASELINE);
+    for (size_t i = 0; f != NULL && i < ARRAY_SIZE(cases); i++)
+    {
+        double baseline = 0;
+
+        CHECK(fscanf(f, "%lf", &baseline) == 1, "%s truncated", TEST_BASELINE);
+        /* equal deadlines are serviced in one pass without merging too */
+        if (memcmp(cases[i].start, cases[i].start + 1, 3) == 0 && cases[i].spread_ms == 0)
+        {
+            CHECK(rates[i] <= baseline, "case %zu: %.1f wakeups/s, %.1f without merging", i, rates[i],
+                  baseline);
+        }
+        else
+        {
+            CHECK(rates[i] < baseline, "case %zu: %.1f wakeups/s, %.1f without merging", i, rates[i], baseline);
+        }
+
+        printf("case %zu: %.1f wakeups/s, %.1f without merging (LED_SCHED_MERGE_MS 0)\n", i, rates[i],
+               baseline);
+    }
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+#else
+    FILE *f = fopen(TEST_BASELINE, "w");
+
+    CHECK(f != NULL, "%s can't be written", TEST_BASELINE);
+    for (size_t i = 0; f != NULL && i < ARRAY_SIZE(cases); i++)
+    {
+        fprintf(f, "%.3f\n", rates[i]);
+    }
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+#endif
+
+    return check_result(LED_SCHED_MERGE_MS ? "test_sched" : "test_sched (no merging)");
+}
@@ -0,0 +1,137 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Peak number of simultaneously active outputs of the default channel table
+ * with all channels at the same level. Built with and without
+ * LED_CHANNEL_PHASE_STAGGER: the unstaggered build stores its peaks to
+ * TEST_BASELINE, the staggered one has to lower them up to half duty (above
+ * it they may not be higher). Peaks are sampled from pin levels of the
+ * register model and compared with led_channel_peak_on_count_get(). */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/model.h"
+#include "host/stack.h"
+
+#include "led_channel.h"
+
+#include <stdio.h>
+
+/* firmware default */
+#ifndef LED_CHANNEL_PHASE_STAGGER
+#define LED_CHANNEL_PHASE_STAGGER   1
+#endif
+
+#define TEST_SAMPLE_COUNTS  16
+#define TEST_PERIODS        4
+
+static const uint8_t test_levels[] = { 32, 64, 128, 160, 200, 230 };
+
+static uint8_t test_peak_sample(void)
+{
+    uint32_t period = TIMER_TopGet(led_channel_pwm_get(LedChannel_CH1)->timer) + 1;
+    uint64_t end = model_time_get() + TEST_PERIODS * (uint64_t)period;
+    uint8_t peak = 0;
+
+    while (model_time_get() < end)
+    {
+        uint8_t count = 0;
+
+        for (size_t ch = 0; ch < APP_EP_COUNT; ch++)
+        {
+            sl_led_pwm_t *pwm = led_channel_pwm_get(ch);
+
+            count += model_pin_get(TIMER_NUM(pwm->timer), pwm->channel) != (pwm->polarity != 0);
+        }
+
+        peak = count > peak ? count : peak;
+        model_advance_to(model_time_get() + TEST_SAMPLE_COUNTS);
+    }
+
+    return peak;
+}
+
+int main(void)
+{
+    uint8_t peaks[ARRAY_SIZE(test_levels)];
+    uint32_t duties[ARRAY_SIZE(test_levels)];
+    uint32_t period;
+
+    firmware_boot();
+    stack_run_ms(3000);
+
+    for (size_t i = 0; i < ARRAY_SIZE(test_levels); i++)
+    {
+        for (uint8_t ep = 1; ep <= APP_EP_COUNT; ep++)
+        {
+            firmware_move_to_level(ep, test_levels[i], 0, true);
+        }
+        stack_run_ms(20);
+
+        peaks[i] = test_peak_sample();
+        duties[i] = led_channel_lut_get(LedChannel_CH1)[test_levels[i]];
+        period = TIMER_TopGet(led_channel_pwm_get(LedChannel_CH1)->timer) + 1;
+        printf("level %3u: duty %5u/%u, peak %u of %u outputs\n", test_levels[i], duties[i], period, peaks[i],
+               APP_EP_COUNT);
+
+        CHECK(peaks[i] == led_channel_peak_on_count_get(), "level %u: sampled peak %u, modeled %u",
+              test_levels[i], peaks[i], led_channel_peak_on_count_get());
+    }
+
+#if LED_CHANNEL_PHASE_STAGGER
+    FILE *f = fopen(TEST_BASELINE, "r");
+
+    CHECK(f != NULL, "%s missing", TEST_BASELINE);
+    for (size_t i = 0; f != NULL && i < ARRAY_SIZE(test_levels); i++)
+    {
+        unsigned int baseline = 0;
+
+        CHECK(fscanf(f, "%u", &baseline) == 1, "%s truncated", TEST_BASELINE);
+
+        /* above half duty the pulses of CH1 and CH3 (left aligned on the same
+         * TIMER) overlap with both CH2 and CH4 anyway */
+        if (duties[i] * 2 > period)
+        {
+            CHECK(peaks[i] <= baseline, "level %u: peak %u, %u without stagger", test_levels[i], peaks[i],
+                  baseline);
+            continue;
+        }
+
+        CHECK(peaks[i] < baseline, "level %u: peak %u, %u without stagger", test_levels[i],
+              peaks[i], baseline);
+    }
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+#else
+    FILE *f = fopen(TEST_BASELINE, "w");
+
+    CHECK(f != NULL, "%s can't be written", TEST_BASELINE);
+    for (size_t i = 0; f != NULL && i < ARRAY_SIZE(test_levels); i++)
+    {
+        fprintf(f, "%u\n", peaks[i]);
+    }
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+#endif
+
+    return check_result(LED_CHANNEL_PHASE_STAGGER ? "test_stagger" : "test_stagger (off)");
+}
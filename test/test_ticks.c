@@ -0,0 +1,134 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Wakeups of level transitions for (delta, duration, easing) cases, counted
+ * by the lighting scheduler while MoveToLevel runs through the firmware: they
+ * follow steps of the PWM output (levels mapped to the same compare value
+ * don't wake the CPU) and stay within APP_LEVEL_MAX_TICK_RATE. Built with
+ * the pixel strip of test_pixel for an 8-bit output. Fixed 20 Hz ticking is
+ * printed for comparison. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/stack.h"
+
+#include <stdio.h>
+
+#include "app.h"
+#include "led_channel.h"
+#include "led_ease.h"
+#include "led_sched.h"
+
+#define TEST_FIXED_RATE     20
+#define TEST_SETTLE_MS      4000    /* level token is saved meanwhile */
+
+typedef struct
+{
+    uint8_t     start;
+    uint8_t     target;
+    uint16_t    transition_time;    /* 1/10 s */
+
+} TestCase;
+
+static const TestCase cases[] =
+{
+    { 1,   11,  5   },
+    { 1,   11,  100 },
+    { 1,   61,  20  },
+    { 1,   61,  600 },
+    { 1,   254, 5   },
+    { 1,   254, 20  },
+    { 1,   254, 100 },
+    { 1,   254, 600 },
+    { 254, 194, 20  },
+    { 254, 194, 600 },
+    { 254, 1,   100 },
+};
+
+/* PWM output changes on the way from start to target level */
+static uint32_t test_output_steps(LedChannel ch, uint8_t start, uint8_t target)
+{
+    const uint16_t *lut = led_channel_lut_get(ch);
+    uint32_t steps = 0;
+
+    for (uint8_t l = start; l != target; )
+    {
+        uint8_t next = target > l ? l + 1 : l - 1;
+
+        steps += lut[next] != lut[l];
+        l = next;
+    }
+
+    return steps;
+}
+
+static void test_case(LedChannel ch, const TestCase *c, LedEase ease)
+{
+    uint8_t ep = ch + 1;
+    uint32_t duration_ms = c->transition_time * 100UL;
+
+    led_ease_set(ep, ease);
+    firmware_move_to_level(ep, c->start, 0, false);
+    stack_run_ms(TEST_SETTLE_MS);
+
+    uint32_t wakeups_start;
+    uint32_t wakeups;
+    uint32_t serviced;
+
+    /* other events (in ex. energy meter) aren't counted, only scheduler ones */
+    led_sched_stats_get(&wakeups_start, &serviced);
+    firmware_move_to_level(ep, c->target, c->transition_time, false);
+    stack_run_ms(duration_ms + 1);
+    led_sched_stats_get(&wakeups, &serviced);
+    wakeups -= wakeups_start;
+
+    uint32_t steps = test_output_steps(ch, c->start, c->target);
+    uint32_t rate_max = duration_ms * APP_LEVEL_MAX_TICK_RATE / 1000;
+
+    CHECK(firmware_current_level_get(ep) == c->target, "%u -> %u: level %u", c->start, c->target,
+          firmware_current_level_get(ep));
+    /* the first tick runs at once, the last one ends transition on time */
+    CHECK(wakeups <= steps + 2, "%u -> %u in %u ms, ease %d: %u wakeups for %u output steps", c->start,
+          c->target, duration_ms, ease, wakeups, steps);
+    CHECK(wakeups <= rate_max + 2, "%u -> %u in %u ms, ease %d: %u wakeups above %u Hz", c->start, c->target,
+          duration_ms, ease, wakeups, APP_LEVEL_MAX_TICK_RATE);
+
+    printf("%s %3u -> %3u %6u ms %-6s: %3u output steps, %3u wakeups (%5.1f/s), %4u at %u Hz\n",
+           ch == LedChannel_CH1 ? "PWM  " : "pixel", c->start, c->target, duration_ms, ease == LedEase_LINEAR ? "linear" : "cubic", steps, wakeups,
+           wakeups * 1000.0 / duration_ms, duration_ms * TEST_FIXED_RATE / 1000, TEST_FIXED_RATE);
+}
+
+int main(void)
+{
+    firmware_boot();
+    firmware_on_off(LedChannel_CH1 + 1, ZCL_ON_COMMAND_ID);
+    firmware_on_off(LedChannel_CH5 + 1, ZCL_ON_COMMAND_ID);
+    stack_run_ms(3000);
+
+    /* 16-bit TIMER PWM changes with every level, 8-bit pixel keeps the same
+     * value for many levels at the bottom of the CIE curve */
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        test_case(LedChannel_CH1, &cases[i], LedEase_LINEAR);
+        test_case(LedChannel_CH1, &cases[i], LedEase_CUBIC);
+        test_case(LedChannel_CH5, &cases[i], LedEase_LINEAR);
+        test_case(LedChannel_CH5, &cases[i], LedEase_CUBIC);
+    }
+
+    return check_result("test_ticks");
+}
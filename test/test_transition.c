@@ -0,0 +1,197 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Transition interpolator and tick scheduling (led_transition.c) for every
+ * level delta and ZCL transition time: ticks are replayed the way
+ * level_extension.c schedules them, the transition ends exactly at its
+ * duration and every level is shown less than one tick after the exact
+ * linear interpolation crosses it (one tick for a tie going down). Fine
+ * level of dithered output is rounded from it to 1/256 and rounds to the
+ * shown level.
+ * Transition times are exhaustive up to TEST_TIME_ALL (1 minute) and
+ * sampled above it. MOVE durations are checked for every distance and
+ * rate. */
+
+#include "host/check.h"
+
+#include "app.h"
+#include "led_transition.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define TEST_LEVEL_MIN      1
+#define TEST_LEVEL_MAX      254
+#define TEST_TIME_ALL       600
+#define TEST_TIME_STRIDE    127
+
+typedef struct
+{
+    uint32_t    transitions;
+    uint32_t    ticks;
+    uint32_t    duration_err_max;   /* ms */
+    double      lag_max;            /* ms */
+
+} TestStats;
+
+static void test_transition(uint8_t start, uint8_t target, uint16_t transition_time, LedEase ease,
+                            TestStats *stats)
+{
+    LedTransition tr = { start, target, ease, transition_time * 100UL };
+    int32_t delta = (int32_t)target - (int32_t)start;
+    int32_t dir = delta > 0 ? 1 : -1;
+    uint32_t distance = delta > 0 ? delta : -delta;
+    uint32_t elapsed_ms = 0;
+    uint8_t level = start;
+
+    stats->transitions++;
+
+    for (;;)
+    {
+        uint8_t next = led_transition_level_get(&tr, elapsed_ms);
+        bool done = elapsed_ms >= tr.duration_ms || start == target;
+
+        stats->ticks++;
+
+        CHECK((next - level) * dir >= 0 && (next - start) * dir <= (int32_t)distance,
+              "%u -> %u in %u: level %u after %u at %u ms", start, target, transition_time, next, level,
+              elapsed_ms);
+
+        /* levels shown by this tick, against time exact interpolation crosses them */
+        for (uint8_t l = level; ease == LedEase_LINEAR && l != next; )
+        {
+            l += dir;
+
+            double cross_ms = tr.duration_ms * ((double)(l - start) * dir - 0.5) / distance;
+            double lag = elapsed_ms - cross_ms;
+
+            /* level going down is shown only past the exact half, so tie is a tick late */
+            CHECK(lag >= 0 && lag <= LED_TRANSITION_TICK_MIN_MS,
+                  "%u -> %u in %u: level %u shown at %u ms, crossed at %.1f ms", start, target,
+                  transition_time, l, elapsed_ms, cross_ms);
+
+            if (lag > stats->lag_max)
+            {
+                stats->lag_max = lag;
+            }
+        }
+
+        uint16_t level_q8 = led_transition_level_q8_get(&tr, elapsed_ms);
+        double exact = elapsed_ms >= tr.duration_ms ? target : start + (double)delta * elapsed_ms / tr.duration_ms;
+
+        CHECK(level_q8 >= (next << 8) - 0x80 && level_q8 <= (next << 8) + 0x80 &&
+              (ease != LedEase_LINEAR || fabs(level_q8 - exact * 256) <= 0.5),
+              "%u -> %u in %u: fine level %.3f, level %u at %u ms", start, target, transition_time,
+              level_q8 / 256.0, next, elapsed_ms);
+
+        level = next;
+
+        if (done)
+        {
+            break;
+        }
+
+        elapsed_ms += led_transition_delay_get(&tr, NULL, level, elapsed_ms);
+    }
+
+    uint32_t err = elapsed_ms > tr.duration_ms ? elapsed_ms - tr.duration_ms : tr.duration_ms - elapsed_ms;
+
+    CHECK(level == target && err < LED_TRANSITION_TICK_MIN_MS,
+          "%u -> %u in %u: ended at level %u after %u ms", start, target, transition_time, level, elapsed_ms);
+
+    if (err > stats->duration_err_max)
+    {
+        stats->duration_err_max = err;
+    }
+}
+
+static void test_transitions(LedEase ease, uint32_t time_all, uint32_t stride)
+{
+    TestStats stats = { 0 };
+
+    for (int32_t delta = TEST_LEVEL_MIN - TEST_LEVEL_MAX; delta <= TEST_LEVEL_MAX - TEST_LEVEL_MIN; delta++)
+    {
+        uint8_t start = delta >= 0 ? TEST_LEVEL_MIN : TEST_LEVEL_MAX;
+        uint8_t target = (uint8_t)(start + delta);
+
+        if (delta == 0)
+        {
+            continue;
+        }
+
+        for (uint32_t time = 0; time < 0xFFFF; time += time < time_all ? 1 : stride)
+        {
+            test_transition(start, target, (uint16_t)time, ease, &stats);
+        }
+    }
+
+    printf("ease %d: %u transitions, %.1f ticks avg, duration error max %u ms, level lag max %.2f ms "
+           "(tick %u ms)\n", ease, stats.transitions, (double)stats.ticks / stats.transitions,
+           stats.duration_err_max, stats.lag_max, LED_TRANSITION_TICK_MIN_MS);
+}
+
+static void test_move(void)
+{
+    double err_max = 0;
+    double err_max_ds = 0;
+
+    for (uint32_t distance = 1; distance <= TEST_LEVEL_MAX - TEST_LEVEL_MIN; distance++)
+    {
+        for (uint32_t rate = 1; rate < 0xFF; rate++)
+        {
+            double exact_ms = distance * 1000.0 / rate;
+            double err = led_transition_move_duration_get((uint8_t)distance, (uint8_t)rate) - exact_ms;
+            /* ZCL transition time in 1/10 s, as used before */
+            uint32_t time_ds = (distance * 10 + rate / 2) / rate;
+            double err_ds = (time_ds == 0 ? 1 : time_ds) * 100.0 - exact_ms;
+
+            err = err < 0 ? -err : err;
+            err_ds = err_ds < 0 ? -err_ds : err_ds;
+
+            CHECK(err < LED_TRANSITION_TICK_MIN_MS, "move of %u levels at %u/s: error %.1f ms", distance, rate,
+                  err);
+
+            if (err > err_max)
+            {
+                err_max = err;
+            }
+
+            if (err_ds > err_max_ds)
+            {
+                err_max_ds = err_ds;
+            }
+        }
+    }
+
+    printf("move: duration error max %.2f ms (%.1f ms in 1/10 s)\n", err_max, err_max_ds);
+}
+
+int main(void)
+{
+    test_transitions(LedEase_LINEAR, TEST_TIME_ALL, TEST_TIME_STRIDE);
+
+    /* eased transitions for duration only, lag is compared with the curves by test_ease */
+    for (int ease = LedEase_LINEAR + 1; ease < LedEase_MAX; ease++)
+    {
+        test_transitions((LedEase)ease, TEST_TIME_ALL / 4, TEST_TIME_STRIDE * 4);
+    }
+
+    test_move();
+
+    return check_result("test_transition");
+}
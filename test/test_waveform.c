@@ -0,0 +1,121 @@
+/*
+ *  Zigbee 3.0 4-channel LED strip driver.
+ *  Copyright (C) 2022 Andrzej Gendek
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Golden waveforms of level transitions and effects. Every PWM period of
+ * channel outputs is recorded by the register model and compared with
+ * test/golden, so change of output timeline is visible in review. */
+
+#include "host/check.h"
+#include "host/firmware.h"
+#include "host/model.h"
+#include "host/stack.h"
+#include "host/waveform.h"
+
+#include "led_channel.h"
+#include "led_effect.h"
+
+#define TEST_CH_MASK(ch)    (1UL << (ch))
+#define TEST_CH_ALL         (TEST_CH_MASK(LedChannel_CH1) | TEST_CH_MASK(LedChannel_CH2) | \
+                             TEST_CH_MASK(LedChannel_CH3) | TEST_CH_MASK(LedChannel_CH4))
+
+static void test_golden(const char *name, uint32_t mask)
+{
+    CHECK(wave_golden_check(name, mask), "%s", name);
+
+    for (size_t ch = 0; ch < LedChannel_MAX; ch++)
+    {
+        WaveStats stats;
+
+        if ((mask & TEST_CH_MASK(ch)) == 0)
+        {
+            continue;
+        }
+
+        wave_stats_get(ch, &stats);
+        CHECK(stats.glitches == 0, "%s %s: %u glitches", name, wave_channel_name(ch), stats.glitches);
+        CHECK(stats.periods > 0, "%s %s: no periods", name, wave_channel_name(ch));
+    }
+
+    wave_reset();
+}
+
+static void test_move_to_level(void)
+{
+    firmware_move_to_level(1, 254, 10, true);
+    stack_run_ms(1500);
+    firmware_move_to_level(1, 1, 10, true);
+    stack_run_ms(1500);
+    firmware_move_to_level(1, 0, 5, true);
+    stack_run_ms(1000);
+
+    test_golden("move_to_level", TEST_CH_MASK(LedChannel_CH1));
+}
+
+static void test_group_fade(void)
+{
+    for (uint8_t ep = 1; ep <= 4; ep++)
+    {
+        firmware_move_to_level(ep, 200, 20, true);
+    }
+    stack_run_ms(2500);
+
+    for (uint8_t ep = 1; ep <= 4; ep++)
+    {
+        firmware_on_off(ep, ZCL_OFF_COMMAND_ID);
+    }
+    stack_run_ms(2000);
+
+    test_golden("group_fade", TEST_CH_ALL);
+}
+
+static void test_identify(void)
+{
+    led_effect_run(LedChannel_CH1, LedEffect_Identify, 2);
+    stack_run_ms(4000);
+
+    test_golden("identify", TEST_CH_MASK(LedChannel_CH1));
+}
+
+static void test_frequency(void)
+{
+    firmware_move_to_level(2, 100, 0, true);
+    stack_run_ms(200);
+    firmware_move_to_closest_frequency(2, 2000);
+    stack_run_ms(200);
+    firmware_move_to_closest_frequency(2, 4000);
+    stack_run_ms(200);
+    firmware_on_off(2, ZCL_OFF_COMMAND_ID);
+    stack_run_ms(500);
+
+    test_golden("frequency", TEST_CH_MASK(LedChannel_CH2));
+}
+
+int main(void)
+{
+    wave_init();
+    firmware_boot();
+    stack_run_ms(3000);
+    wave_reset();
+
+    test_move_to_level();
+    test_group_fade();
+    test_identify();
+    test_frequency();
+
+    return check_result("test_waveform");
+}
@@ -23,12 +23,19 @@
 #include "on_off_extension.h"
 #include "level_extension.h"
 #include "identify_extension.h"
+#include "mfg_extension.h"
+#include "color_extension.h"
+#include "led_channel.h"
 
 const sl_service_function_entry_t zcl_extension_items[] =
 {
     { SL_SERVICE_FUNCTION_TYPE_ZCL_COMMAND, ZCL_IDENTIFY_CLUSTER_ID, (NOT_MFG_SPECIFIC | (SL_CLUSTER_SERVICE_SIDE_SERVER << 16)), identify_extension_handle_cmd },
     { SL_SERVICE_FUNCTION_TYPE_ZCL_COMMAND, ZCL_ON_OFF_CLUSTER_ID, (NOT_MFG_SPECIFIC | (SL_CLUSTER_SERVICE_SIDE_SERVER << 16)), on_off_extension_handle_cmd },
     { SL_SERVICE_FUNCTION_TYPE_ZCL_COMMAND, ZCL_LEVEL_CONTROL_CLUSTER_ID, (NOT_MFG_SPECIFIC | (SL_CLUSTER_SERVICE_SIDE_SERVER << 16)), level_extension_handle_cmd },
+    { SL_SERVICE_FUNCTION_TYPE_ZCL_COMMAND, ZCL_LEVEL_CONTROL_CLUSTER_ID, (EMBER_AF_MANUFACTURER_CODE | (SL_CLUSTER_SERVICE_SIDE_SERVER << 16)), mfg_extension_level_handle_cmd },
+#if APP_LIGHT_MODE != APP_LIGHT_MODE_CHANNELS
+    { SL_SERVICE_FUNCTION_TYPE_ZCL_COMMAND, ZCL_COLOR_CONTROL_CLUSTER_ID, (NOT_MFG_SPECIFIC | (SL_CLUSTER_SERVICE_SIDE_SERVER << 16)), color_extension_handle_cmd },
+#endif
 };
 
 static sl_service_function_block_t zcl_extension_block[] =
@@ -44,4 +51,10 @@ void zcl_extension_init(void)
 
     level_extension_init();
     on_off_extension_init();
+#if APP_LIGHT_MODE != APP_LIGHT_MODE_CHANNELS
+    color_extension_init();
+#endif
+
+    /* light restored by extensions is on before the first pass of main loop */
+    led_channel_commit_flush();
 }